@@ -0,0 +1,126 @@
+/*
+
+Created
+  based on nano-ecc: https://github.com/iSECPartners/nano-ecc
+by
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Cortex-M cycle benchmark for the nano-ecc field and point routines. It is built twice by the
+Makefile next to this file (ECC_ASM=ecc_asm_none and ECC_ASM=ecc_asm_cortexm) and runs on the
+MPS2 boards of qemu-system-arm, with output through semihosting.
+
+QEMU does not model cycles. With -icount shift=0 every instruction takes 1 ns of virtual time,
+so the SysTick counter (driven by the 25 MHz board clock) measures instructions at a resolution
+of 40. On real hardware, build with BENCH_DWT=1 to read the DWT cycle counter instead.
+*/
+
+#include "nano-ecc.c"
+
+#ifndef BENCH_ROUNDS
+    #define BENCH_ROUNDS 100
+#endif
+#ifndef BENCH_CLOCK_HZ
+    #define BENCH_CLOCK_HZ 25000000UL
+#endif
+
+#define SYST_CSR   (*(volatile uint32_t *)0xE000E010)
+#define SYST_RVR   (*(volatile uint32_t *)0xE000E014)
+#define SYST_CVR   (*(volatile uint32_t *)0xE000E018)
+#define DEMCR      (*(volatile uint32_t *)0xE000EDFC)
+#define DWT_CTRL   (*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+
+static volatile uint32_t systick_wraps;
+
+void SysTick_Handler(void)
+{
+    ++systick_wraps;
+}
+
+static void bench_init(void)
+{
+#if BENCH_DWT
+    DEMCR |= (1UL << 24);  /* TRCENA */
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= 1;         /* CYCCNTENA */
+#else
+    SYST_RVR = 0x00FFFFFF;
+    SYST_CVR = 0;
+    SYST_CSR = 7;          /* processor clock, interrupt on wrap, enable */
+#endif
+}
+
+/* Returns the time since bench_init(): cycles with BENCH_DWT, SysTick ticks otherwise. */
+static uint64_t bench_now(void)
+{
+#if BENCH_DWT
+    return DWT_CYCCNT;
+#else
+    uint32_t l_wraps, l_count;
+    do
+    {
+        l_wraps = systick_wraps;
+        l_count = SYST_CVR;
+    } while(l_wraps != systick_wraps);
+    return ((uint64_t)l_wraps << 24) + (0x00FFFFFF - l_count);
+#endif
+}
+
+/* Prints the average per round; under QEMU -icount shift=0 that is instructions. */
+static void bench_report(const char *p_name, uint64_t p_elapsed, uint p_rounds)
+{
+#if BENCH_DWT
+    printf("%-20s %10lu cycles\n", p_name, (unsigned long)(p_elapsed / p_rounds));
+#else
+    printf("%-20s %10lu insns\n", p_name,
+           (unsigned long)(p_elapsed * (1000000000UL / BENCH_CLOCK_HZ) / p_rounds));
+#endif
+}
+
+#define BENCH(p_name, p_rounds, p_call) do { \
+    uint64_t l_start; \
+    uint i; \
+    l_start = bench_now(); \
+    for(i = 0; i < (p_rounds); ++i) \
+    { \
+        p_call; \
+    } \
+    bench_report(p_name, bench_now() - l_start, p_rounds); \
+} while(0)
+
+int main(void)
+{
+    uint8_t a[NUM_ECC_DIGITS], b[NUM_ECC_DIGITS], c[NUM_ECC_DIGITS];
+    uint8_t l_product[2 * NUM_ECC_DIGITS];
+    EccPoint l_point;
+
+    bench_init();
+    getRandomBytes(a, NUM_ECC_DIGITS);
+    getRandomBytes(b, NUM_ECC_DIGITS);
+    if(vli_cmp(a, curve_p) >= 0)
+    {
+        vli_sub(a, a, curve_p);
+    }
+    if(vli_cmp(b, curve_p) >= 0)
+    {
+        vli_sub(b, b, curve_p);
+    }
+
+    printf("curve %d, ECC_ASM %d, %d rounds\n", ECC_CURVE, ECC_ASM, BENCH_ROUNDS);
+    BENCH("vli_mult", BENCH_ROUNDS, vli_mult(l_product, a, b));
+#if (ECC_CURVE != sect163k1)
+    BENCH("vli_square", BENCH_ROUNDS, vli_square(l_product, a));
+#endif
+    BENCH("vli_mmod_fast", BENCH_ROUNDS, vli_mmod_fast(c, l_product));
+    BENCH("vli_modMult_fast", BENCH_ROUNDS, vli_modMult_fast(c, a, b));
+    BENCH("vli_modSquare_fast", BENCH_ROUNDS, vli_modSquare_fast(c, a));
+    BENCH("vli_modAdd", BENCH_ROUNDS, vli_modAdd(c, a, b, curve_p));
+    BENCH("vli_modInv", BENCH_ROUNDS, vli_modInv(c, a, curve_p));
+#if ECC_FERMAT_INV
+    BENCH("vli_modInv_fast", BENCH_ROUNDS, vli_modInv_fast(c, a));
+#endif
+    BENCH("EccPoint_mult", 1, EccPoint_mult(&l_point, &curve_G, a, NULL));
+
+    exit(0);
+}
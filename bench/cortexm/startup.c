@@ -0,0 +1,41 @@
+/*
+
+Created
+  based on nano-ecc: https://github.com/iSECPartners/nano-ecc
+by
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Minimal Cortex-M vector table for the benchmark. The reset vector goes straight to the newlib
+(rdimon) _start, which sets up the C runtime and semihosting.
+*/
+
+#include <stdint.h>
+
+extern uint32_t __stack_top;
+extern void _start(void);
+extern void SysTick_Handler(void);
+
+static void Fault_Handler(void)
+{
+    for(;;)
+    {
+    }
+}
+
+__attribute__((section(".vectors"), used))
+static const void *vectors[16] = {
+    &__stack_top,
+    _start,
+    Fault_Handler,   /* NMI */
+    Fault_Handler,   /* HardFault */
+    Fault_Handler,   /* MemManage */
+    Fault_Handler,   /* BusFault */
+    Fault_Handler,   /* UsageFault */
+    0, 0, 0, 0,
+    Fault_Handler,   /* SVCall */
+    Fault_Handler,   /* DebugMonitor */
+    0,
+    Fault_Handler,   /* PendSV */
+    SysTick_Handler
+};
@@ -0,0 +1,255 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Host benchmark of the nano-ecc primitives and the IBIHOP passes for one ECC_CURVE; the Makefile next to
+this file builds it for every curve. Each primitive runs BENCH_REPEAT batches and the fastest batch is
+reported, per call, in cycles (RDTSC on x86, CNTVCT on AArch64, 0 elsewhere) and in nanoseconds.
+
+The inputs come from rand() seeded with -s (default 1), so two builds see the same operands. Every line
+also carries a checksum of the results, which tells a speed change from a behaviour change when two runs
+are diffed. -j prints one JSON object per line instead of the table.
+
+    bench-secp192r1 [-j] [-s seed] [-n scale]
+*/
+
+#include "nano-ecc.c"
+#include "ibihop.c"
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifndef BENCH_REPEAT
+    #define BENCH_REPEAT 5
+#endif
+#ifndef BENCH_CURVE_NAME
+    #define BENCH_CURVE_NAME ""
+#endif
+#ifndef BENCH_BUILD
+    #define BENCH_BUILD ""
+#endif
+
+static int bench_json;
+static unsigned bench_scale = 1;
+static uint32_t bench_check;
+
+static uint64_t bench_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t l_count;
+    __asm__ volatile("isb; mrs %0, cntvct_el0" : "=r" (l_count));
+    return l_count;
+#else
+    return 0;
+#endif
+}
+
+static uint64_t bench_ns(void)
+{
+    struct timespec l_time;
+    clock_gettime(CLOCK_MONOTONIC, &l_time);
+    return (uint64_t)l_time.tv_sec * 1000000000UL + (uint64_t)l_time.tv_nsec;
+}
+
+/* FNV-1a over the results of a primitive. */
+static void bench_fold(const void *p_data, unsigned p_size)
+{
+    const uint8_t *l_data = p_data;
+    unsigned i;
+
+    for(i = 0; i < p_size; ++i)
+    {
+        bench_check = (bench_check ^ l_data[i]) * 16777619UL;
+    }
+}
+
+static void bench_report(const char *p_name, unsigned p_rounds, uint64_t p_cycles, uint64_t p_ns)
+{
+    if(bench_json)
+    {
+        printf("{\"curve\":\"%s\",\"ecc_curve\":%d,\"ecc_asm\":%d,\"build\":\"%s\",\"name\":\"%s\","
+               "\"rounds\":%u,\"cycles\":%llu,\"ns\":%llu,\"check\":\"%08lx\"}\n",
+               BENCH_CURVE_NAME, ECC_CURVE, ECC_ASM, BENCH_BUILD, p_name, p_rounds,
+               (unsigned long long)(p_cycles / p_rounds), (unsigned long long)(p_ns / p_rounds),
+               (unsigned long)bench_check);
+    }
+    else
+    {
+        printf("%-20s %12llu cycles %12llu ns  %08lx\n", p_name, (unsigned long long)(p_cycles / p_rounds),
+               (unsigned long long)(p_ns / p_rounds), (unsigned long)bench_check);
+    }
+}
+
+/* Runs p_call p_rounds times per batch and reports the fastest of BENCH_REPEAT batches. p_result is folded
+   into the checksum after the last batch. */
+#define BENCH(p_name, p_rounds, p_call, p_result) do { \
+    uint64_t l_cycles, l_ns, l_best_cycles = ~(uint64_t)0, l_best_ns = ~(uint64_t)0; \
+    unsigned l_rounds = (p_rounds) * bench_scale; \
+    unsigned i, j; \
+    for(j = 0; j < BENCH_REPEAT; ++j) \
+    { \
+        l_ns = bench_ns(); \
+        l_cycles = bench_cycles(); \
+        for(i = 0; i < l_rounds; ++i) \
+        { \
+            p_call; \
+        } \
+        l_cycles = bench_cycles() - l_cycles; \
+        l_ns = bench_ns() - l_ns; \
+        if(l_ns < l_best_ns) \
+        { \
+            l_best_ns = l_ns; \
+            l_best_cycles = l_cycles; \
+        } \
+    } \
+    bench_check = 2166136261UL; \
+    bench_fold((p_result), sizeof(*(p_result))); \
+    bench_report(p_name, l_rounds, l_best_cycles, l_best_ns); \
+} while(0)
+
+/* A field element below p (below 2^163 on sect163k1). */
+static void bench_element(uint8_t *p_dest)
+{
+    getRandomBytes(p_dest, NUM_ECC_DIGITS);
+#if (ECC_CURVE == sect163k1)
+    p_dest[NUM_ECC_DIGITS - 1] &= 0x07;
+#else
+    while(vli_cmp(p_dest, curve_p) >= 0)
+    {
+        vli_sub(p_dest, p_dest, curve_p);
+    }
+#endif
+}
+
+/* Pass4 overwrites E, and TagVerf s and e_inv, so each call gets a fresh copy of them. */
+static int bench_pass4(uint8_t *s, EccPoint *pk_r, EccPoint *E, uint8_t *f, uint8_t *r, uint8_t *sk_t)
+{
+    EccPoint l_E = *E;
+    return IBIHOP_Pass4(s, pk_r, &l_E, f, r, sk_t);
+}
+
+static int bench_tagverf(EccPoint R, uint8_t *e_inv, uint8_t *s, EccPoint pk_t)
+{
+    uint8_t l_e_inv[NUM_ECC_DIGITS], l_s[NUM_ECC_DIGITS];
+
+    vli_set(l_e_inv, e_inv);
+    vli_set(l_s, s);
+    return IBIHOP_TagVerf(R, l_e_inv, l_s, pk_t);
+}
+
+int main(int argc, char **argv)
+{
+    uint8_t a[NUM_ECC_DIGITS], b[NUM_ECC_DIGITS], c[NUM_ECC_DIGITS];
+    uint8_t sk_r[NUM_ECC_DIGITS], sk_t[NUM_ECC_DIGITS];
+    uint8_t e[NUM_ECC_DIGITS], e_inv[NUM_ECC_DIGITS], r[NUM_ECC_DIGITS], f[NUM_ECC_DIGITS], s[NUM_ECC_DIGITS];
+    EccPoint pk_r, pk_t, E, R, l_point;
+    EccPoint l_points[ECC_BATCH_MAX], l_batch[ECC_BATCH_MAX];
+    uint8_t l_scalars[ECC_BATCH_MAX][NUM_ECC_DIGITS];
+    unsigned k;
+    unsigned l_seed = 1;
+    int l_opt, l_status = 0;
+
+    while((l_opt = getopt(argc, argv, "js:n:")) != -1)
+    {
+        switch(l_opt)
+        {
+        case 'j':
+            bench_json = 1;
+            break;
+        case 's':
+            l_seed = (unsigned)strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            bench_scale = (unsigned)strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-j] [-s seed] [-n scale]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(bench_scale == 0)
+    {
+        bench_scale = 1;
+    }
+
+    srand(l_seed);
+    bench_element(a);
+    bench_element(b);
+    IBIHOP_KeyGen(&pk_r, sk_r);
+    IBIHOP_KeyGen(&pk_t, sk_t);
+
+    if(!bench_json)
+    {
+        printf("curve %s (%d), ECC_ASM %d, seed %u %s\n", BENCH_CURVE_NAME, ECC_CURVE, ECC_ASM, l_seed, BENCH_BUILD);
+#if ECC_SIMD
+        printf("ECC_SIMD lanes %d, ECC_BATCH_MAX %d\n", ecc_simd_lanes(), ECC_BATCH_MAX);
+#endif
+    }
+
+    /* field */
+    BENCH("vli_modMult_fast", 10000, vli_modMult_fast(c, a, b), &c);
+    BENCH("vli_modSquare_fast", 10000, vli_modSquare_fast(c, a), &c);
+#if (ECC_CURVE != sect163k1)
+    BENCH("vli_modInv", 100, vli_modInv(c, a, curve_p), &c);
+#endif
+    BENCH("vli_modInv_fast", 100, vli_modInv_fast(c, a), &c);
+
+    /* mod n */
+    BENCH("ModNAdd", 10000, ModNAdd(c, a, b), &c);
+    BENCH("ModNSub", 10000, ModNSub(c, a, b), &c);
+    BENCH("ModNMult", 1000, ModNMult(c, a, b), &c);
+    BENCH("ModNInv", 100, ModNInv(c, a), &c);
+
+    /* points */
+    BENCH("EccPoint_mult", 10, EccPoint_mult(&l_point, &pk_r, a, NULL), &l_point);
+    BENCH("EccPoint_mult_G", 10, EccPoint_mult(&l_point, NULL, a, NULL), &l_point);
+
+    /* one call for ECC_BATCH_MAX different points, as the reader's Pass3; checked against EccPoint_mult */
+    for(k = 0; k < ECC_BATCH_MAX; ++k)
+    {
+        l_points[k] = ((k & 1) ? pk_t : pk_r);
+        bench_element(l_scalars[k]);
+    }
+    BENCH("EccPoint_mult_batch", 10, EccPoint_mult_batch(l_batch, l_points, l_scalars, ECC_BATCH_MAX), &l_batch);
+    for(k = 0; k < ECC_BATCH_MAX; ++k)
+    {
+        EccPoint_mult(&l_point, &l_points[k], l_scalars[k], NULL);
+        if(memcmp(&l_point, &l_batch[k], sizeof(l_point)) != 0)
+        {
+            fprintf(stderr, "EccPoint_mult_batch differs from EccPoint_mult\n");
+            return 1;
+        }
+    }
+#if (ECC_CURVE == curve25519)
+    BENCH("EccPoint_isSum", 10, l_status = EccPoint_isSum(pk_r.x, pk_t.x, l_point.x), &l_status);
+#else
+    BENCH("FastCompute", 10, FastCompute(c, &pk_r, &pk_t, a, b), &c);
+#endif
+
+    /* passes, chained as in a handshake; the inputs of the later passes come from the first batch */
+    BENCH("IBIHOP_KeyGen", 10, IBIHOP_KeyGen(&l_point, c), &l_point);
+    BENCH("IBIHOP_Pass1", 10, IBIHOP_Pass1(&E, e, e_inv), &E);
+    BENCH("IBIHOP_Pass2", 10, IBIHOP_Pass2(&R, r), &R);
+    BENCH("IBIHOP_Pass3", 10, IBIHOP_Pass3(f, &R, e, sk_r), &f);
+    BENCH("IBIHOP_Pass4", 10, l_status = bench_pass4(s, &pk_r, &E, f, r, sk_t), &s);
+    if(l_status != 0)
+    {
+        fprintf(stderr, "IBIHOP_Pass4 rejected the reader\n");
+        return 1;
+    }
+    BENCH("IBIHOP_TagVerf", 10, l_status = bench_tagverf(R, e_inv, s, pk_t), &l_status);
+    if(l_status != 0)
+    {
+        fprintf(stderr, "IBIHOP_TagVerf rejected the tag\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,324 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+End-to-end IBIHOP handshakes between an in-memory reader and tag for one ECC_CURVE, without Contiki or a
+radio: Pass1 (reader) -> Pass2 (tag) -> Pass3 (reader) -> Pass4 (tag) -> TagVerf (reader), with every
+message copied as it would be on the air. Prints authentications per second and, per pass, the p50, p90,
+p99 and maximum latency, and with ECC_STATS=1 (as the Makefile builds it) the field and point operations
+of each pass. Any failed handshake makes the exit status 1, so `make handshake` fails with it and can
+be run as a regression check.
+
+Built with ECC_FIXED_TABLE=1, -t loads a table written by tools/gen-table; without it the ladder runs.
+
+    handshake-secp192r1 [-j] [-s seed] [-n handshakes] [-t table.bin]
+*/
+
+#include "nano-ecc.c"
+#include "ibihop.c"
+#include <time.h>
+#include <unistd.h>
+
+#define PASS_COUNT 5
+
+static const char * const pass_names[PASS_COUNT] = {"Pass1", "Pass2", "Pass3", "Pass4", "TagVerf"};
+
+#ifndef BENCH_CURVE_NAME
+    #define BENCH_CURVE_NAME ""
+#endif
+#ifndef BENCH_BUILD
+    #define BENCH_BUILD ""
+#endif
+
+/* What each side keeps between the passes. */
+typedef struct
+{
+    EccPoint pk;
+    uint8_t sk[NUM_ECC_DIGITS];
+    EccPoint pk_t;               /* the tag's public key, known to the reader */
+    uint8_t e[NUM_ECC_DIGITS];
+    uint8_t e_inv[NUM_ECC_DIGITS];
+    EccPoint R;
+} Reader;
+
+typedef struct
+{
+    EccPoint pk;
+    uint8_t sk[NUM_ECC_DIGITS];
+    EccPoint pk_r;               /* the reader's public key, known to the tag */
+    EccPoint E;
+    uint8_t r[NUM_ECC_DIGITS];
+} Tag;
+
+/* The messages on the air. */
+typedef struct
+{
+    EccPoint E;                  /* reader -> tag */
+    EccPoint R;                  /* tag -> reader */
+    uint8_t f[NUM_ECC_DIGITS];   /* reader -> tag */
+    uint8_t s[NUM_ECC_DIGITS];   /* tag -> reader */
+} Air;
+
+static uint64_t bench_ns(void)
+{
+    struct timespec l_time;
+    clock_gettime(CLOCK_MONOTONIC, &l_time);
+    return (uint64_t)l_time.tv_sec * 1000000000UL + (uint64_t)l_time.tv_nsec;
+}
+
+static int compare_u64(const void *p_left, const void *p_right)
+{
+    uint64_t l_left = *(const uint64_t *)p_left, l_right = *(const uint64_t *)p_right;
+    return (l_left > l_right) - (l_left < l_right);
+}
+
+/* p_sorted[p_count - 1] for p_percent = 100. */
+static uint64_t percentile(const uint64_t *p_sorted, unsigned p_count, unsigned p_percent)
+{
+    unsigned l_index = (unsigned)(((uint64_t)p_count * p_percent + 99) / 100);
+    return p_sorted[l_index ? l_index - 1 : 0];
+}
+
+#if ECC_FIXED_TABLE
+static uint8_t *table_image;
+static long table_size;
+
+static int table_read(uint32_t p_offset, uint8_t *p_dest, unsigned p_size)
+{
+    if((long)p_offset + (long)p_size > table_size)
+    {
+        return 0;
+    }
+    memcpy(p_dest, table_image + p_offset, p_size);
+    return 1;
+}
+
+static int table_load(const char *p_path)
+{
+    FILE *l_file = fopen(p_path, "rb");
+
+    if(l_file == NULL || fseek(l_file, 0, SEEK_END) != 0 || (table_size = ftell(l_file)) <= 0)
+    {
+        perror(p_path);
+        return 0;
+    }
+    table_image = malloc((size_t)table_size);
+    rewind(l_file);
+    if(table_image == NULL || fread(table_image, 1, (size_t)table_size, l_file) != (size_t)table_size)
+    {
+        perror(p_path);
+        return 0;
+    }
+    fclose(l_file);
+    return ecc_table_init(table_read);
+}
+#endif
+
+#if ECC_STATS
+static EccStats pass_ops[PASS_COUNT];   /* summed over the handshakes */
+
+static void ops_add(EccStats *p_sum)
+{
+    EccStats l_ops;
+
+    ecc_stats_get(&l_ops);
+    p_sum->modMult += l_ops.modMult;
+    p_sum->modSquare += l_ops.modSquare;
+    p_sum->modInv += l_ops.modInv;
+    p_sum->modNMult += l_ops.modNMult;
+    p_sum->modNInv += l_ops.modNInv;
+    p_sum->pointDouble += l_ops.pointDouble;
+    p_sum->pointAdd += l_ops.pointAdd;
+    p_sum->pointMult += l_ops.pointMult;
+}
+
+#define PASS_BEGIN(p_start) (ecc_stats_reset(), (p_start) = bench_ns())
+#define PASS_END(p_start, p_pass) (p_times[p_pass] = bench_ns() - (p_start), ops_add(&pass_ops[p_pass]))
+#else
+#define PASS_BEGIN(p_start) ((p_start) = bench_ns())
+#define PASS_END(p_start, p_pass) (p_times[p_pass] = bench_ns() - (p_start))
+#endif
+
+/* Runs one handshake and stores the time of each pass in p_times. Returns 0 if both sides accepted. */
+static int handshake(Reader *p_reader, Tag *p_tag, uint64_t *p_times)
+{
+    Air l_air;
+    uint8_t l_f[NUM_ECC_DIGITS];
+    uint8_t l_s[NUM_ECC_DIGITS];
+    uint64_t l_start;
+    int l_status;
+
+    PASS_BEGIN(l_start);
+    IBIHOP_Pass1(&l_air.E, p_reader->e, p_reader->e_inv);
+    PASS_END(l_start, 0);
+    p_tag->E = l_air.E;
+
+    PASS_BEGIN(l_start);
+    IBIHOP_Pass2(&l_air.R, p_tag->r);
+    PASS_END(l_start, 1);
+    p_reader->R = l_air.R;
+
+    PASS_BEGIN(l_start);
+    IBIHOP_Pass3(l_f, &p_reader->R, p_reader->e, p_reader->sk);
+    PASS_END(l_start, 2);
+    memcpy(l_air.f, l_f, NUM_ECC_DIGITS);
+
+    PASS_BEGIN(l_start);
+    l_status = IBIHOP_Pass4(l_s, &p_tag->pk_r, &p_tag->E, l_air.f, p_tag->r, p_tag->sk);
+    PASS_END(l_start, 3);
+    if(l_status != 0)
+    {
+        return -1;
+    }
+    memcpy(l_air.s, l_s, NUM_ECC_DIGITS);
+
+    PASS_BEGIN(l_start);
+    l_status = IBIHOP_TagVerf(p_reader->R, p_reader->e_inv, l_air.s, p_reader->pk_t);
+    PASS_END(l_start, 4);
+    return l_status;
+}
+
+int main(int argc, char **argv)
+{
+    Reader l_reader;
+    Tag l_tag;
+    uint64_t *l_times[PASS_COUNT];
+    uint64_t l_pass_times[PASS_COUNT];
+    uint64_t l_start, l_total;
+    unsigned l_count = 100, l_seed = 1, l_failures = 0;
+    const char *l_table = NULL;
+    int l_json = 0, l_opt;
+    unsigned i, j;
+
+    while((l_opt = getopt(argc, argv, "js:n:t:")) != -1)
+    {
+        switch(l_opt)
+        {
+        case 'j':
+            l_json = 1;
+            break;
+        case 's':
+            l_seed = (unsigned)strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            l_count = (unsigned)strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            l_table = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-j] [-s seed] [-n handshakes] [-t table.bin]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(l_count == 0)
+    {
+        l_count = 1;
+    }
+
+#if ECC_FIXED_TABLE
+    if(l_table != NULL && !table_load(l_table))
+    {
+        fprintf(stderr, "%s is not a table for this curve\n", l_table);
+        return 2;
+    }
+#else
+    if(l_table != NULL)
+    {
+        fprintf(stderr, "built without ECC_FIXED_TABLE, -t %s ignored\n", l_table);
+        l_table = NULL;
+    }
+#endif
+
+    for(i = 0; i < PASS_COUNT; ++i)
+    {
+        l_times[i] = malloc(l_count * sizeof(uint64_t));
+        if(l_times[i] == NULL)
+        {
+            perror("malloc");
+            return 2;
+        }
+    }
+
+    srand(l_seed);
+    IBIHOP_KeyGen(&l_reader.pk, l_reader.sk);
+    IBIHOP_KeyGen(&l_tag.pk, l_tag.sk);
+    l_reader.pk_t = l_tag.pk;
+    l_tag.pk_r = l_reader.pk;
+
+    l_start = bench_ns();
+    for(i = 0; i < l_count; ++i)
+    {
+        if(handshake(&l_reader, &l_tag, l_pass_times) != 0)
+        {
+            ++l_failures;
+        }
+        for(j = 0; j < PASS_COUNT; ++j)
+        {
+            l_times[j][i] = l_pass_times[j];
+        }
+    }
+    l_total = bench_ns() - l_start;
+
+    if(l_json)
+    {
+        printf("{\"curve\":\"%s\",\"ecc_curve\":%d,\"ecc_asm\":%d,\"build\":\"%s\",\"engine\":\"%s\","
+               "\"handshakes\":%u,\"failures\":%u,\"auth_per_s\":%.2f",
+               BENCH_CURVE_NAME, ECC_CURVE, ECC_ASM, BENCH_BUILD, l_table ? "table" : "ladder",
+               l_count, l_failures, l_count * 1e9 / l_total);
+    }
+    else
+    {
+        printf("curve %s (%d), ECC_ASM %d, %s %s\n", BENCH_CURVE_NAME, ECC_CURVE, ECC_ASM,
+               l_table ? "table" : "ladder", BENCH_BUILD);
+        printf("%u handshakes, %u failed, %.2f auth/s\n", l_count, l_failures, l_count * 1e9 / l_total);
+        printf("%-8s %12s %12s %12s %12s   (us)", "pass", "p50", "p90", "p99", "max");
+#if ECC_STATS
+        printf("   %8s %8s %4s %4s %4s %6s %6s   (per handshake)", "M", "S", "I", "Mn", "In", "dbl", "add");
+#endif
+        printf("\n");
+    }
+    for(j = 0; j < PASS_COUNT; ++j)
+    {
+        qsort(l_times[j], l_count, sizeof(uint64_t), compare_u64);
+        if(l_json)
+        {
+            printf(",\"%s\":{\"p50_us\":%.1f,\"p90_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f", pass_names[j],
+                   percentile(l_times[j], l_count, 50) / 1e3, percentile(l_times[j], l_count, 90) / 1e3,
+                   percentile(l_times[j], l_count, 99) / 1e3, l_times[j][l_count - 1] / 1e3);
+#if ECC_STATS
+            printf(",\"modMult\":%.1f,\"modSquare\":%.1f,\"modInv\":%.1f,\"modNMult\":%.1f,\"modNInv\":%.1f,"
+                   "\"pointDouble\":%.1f,\"pointAdd\":%.1f,\"pointMult\":%.1f",
+                   (double)pass_ops[j].modMult / l_count, (double)pass_ops[j].modSquare / l_count,
+                   (double)pass_ops[j].modInv / l_count, (double)pass_ops[j].modNMult / l_count,
+                   (double)pass_ops[j].modNInv / l_count, (double)pass_ops[j].pointDouble / l_count,
+                   (double)pass_ops[j].pointAdd / l_count, (double)pass_ops[j].pointMult / l_count);
+#endif
+            printf("}");
+        }
+        else
+        {
+            printf("%-8s %12.1f %12.1f %12.1f %12.1f", pass_names[j],
+                   percentile(l_times[j], l_count, 50) / 1e3, percentile(l_times[j], l_count, 90) / 1e3,
+                   percentile(l_times[j], l_count, 99) / 1e3, l_times[j][l_count - 1] / 1e3);
+#if ECC_STATS
+            printf("         %8.0f %8.0f %4.0f %4.0f %4.0f %6.0f %6.0f",
+                   (double)pass_ops[j].modMult / l_count, (double)pass_ops[j].modSquare / l_count,
+                   (double)pass_ops[j].modInv / l_count, (double)pass_ops[j].modNMult / l_count,
+                   (double)pass_ops[j].modNInv / l_count, (double)pass_ops[j].pointDouble / l_count,
+                   (double)pass_ops[j].pointAdd / l_count);
+#endif
+            printf("\n");
+        }
+        free(l_times[j]);
+    }
+    if(l_json)
+    {
+        printf("}\n");
+    }
+
+    return l_failures ? 1 : 0;
+}
@@ -41,6 +41,16 @@ It can intercat with a server and return the resutlt of IBIHOP authentication.
 #include "sys/ctimer.h"
 #include "ibihop.h"
 #include "nano-ecc.h"
+#include "ibihop-keys.h"
+#if ECC_FIXED_TABLE
+#include "ecc-table.h"
+#endif
+#include "ibihop-stats.h"
+#include "ibihop-trace.h"
+#if ECC_DRBG
+#include "ecc-drbg.h"
+#include "net/linkaddr.h"
+#endif
 //#include "ecdh.h"
 //#include "ecdsa.h"
 
@@ -68,26 +78,24 @@ It can intercat with a server and return the resutlt of IBIHOP authentication.
 #define SEND_TIME		(random_rand() % (SEND_INTERVAL))
 #define MAX_PAYLOAD_LEN		30
 
-#define PKS { \
-    {0x58, 0x5B, 0x01, 0xC2, 0x6B, 0xEA, 0xF3, 0xD1, 0x81, 0x09, 0xA9, 0x47, 0x54, 0xEC, 0x0B, 0x44, 0x18, 0x9C, 0xE2, 0xE1, 0xF4, 0x76, 0x2E, 0x90}, \
-    {0x0F, 0x34, 0x16, 0xE8, 0xB9, 0xC0, 0xE1, 0x9F, 0x11, 0x41, 0x97, 0x84, 0xAD, 0xFC, 0xE1, 0xB6, 0x42, 0x03, 0x62, 0x79, 0x37, 0x86, 0x22, 0x15}}
-
-#define SKC {0x3F, 0xFC, 0xED, 0xF0, 0xFC, 0x76, 0x8E, 0x06, 0x93, 0x15, 0x0B, 0x10, 0xF5, 0x8E, 0xFA, 0xCD, 0xF8, 0x62, 0xB8, 0x37, 0xDF, 0x77, 0x1D, 0x73}
+#define MSG_LEN (2 * NUM_ECC_DIGITS + 2)
 
 
 
 static EccPoint E;
 static EccPoint R;
-static EccPoint pk_s = PKS;	//Server's public keys.
+static EccPoint pk_s = IBIHOP_KEY(PKS, ECC_CURVE);	//Server's public keys.
 
 static uint8_t r[NUM_ECC_DIGITS];
 static uint8_t f[NUM_ECC_DIGITS];
 static uint8_t s[NUM_ECC_DIGITS];
-static uint8_t sk_c[NUM_ECC_DIGITS] = SKC; //Client's private keys
+static uint8_t sk_c[NUM_ECC_DIGITS] = IBIHOP_KEY(SKC, ECC_CURVE); //Client's private keys
 
 static struct uip_udp_conn *client_conn;
 static uip_ipaddr_t server_ipaddr;
-static clock_time_t start_time;
+#if IBIHOP_STATS
+static clock_time_t hello_time;	/* start of the current handshake, for the latency histogram */
+#endif
 
 /*---------------------------------------------------------------------------*/
 PROCESS(udp_client_process, "UDP client process");
@@ -97,7 +105,7 @@ static void
 tcpip_handler(void)
 {
     char *str = NULL;
-    char buf[50];
+    char buf[MSG_LEN];
     unsigned i;
     buf[0] = 0;
     if(uip_newdata()) {
@@ -110,11 +118,10 @@ tcpip_handler(void)
                 E.x[i] = (uint8_t)str[i+1];
 	        E.y[i] = (uint8_t)str[i+NUM_ECC_DIGITS+1];
     	    }
-	    start_time = clock_time();
-
 	    /*pass 2: tag responds reader's challenge*/
+	    ibihop_pass_begin(IBIHOP_PASS_OPS(ecc_stats_reset));
             IBIHOP_Pass2(&R, r);	
-	    printf("P2: Completion time %lu / %lu\n", (unsigned long)clock_time() - start_time, CLOCK_SECOND);	/* Print the time consumption (number of ticks) of IBIHOP_Pass2(). 1 clock second = 128 ticks */
+	    ibihop_pass_end(IBIHOP_TRACE_PASS2, 0, ECC_CURVE, IBIHOP_PASS_OPS(ecc_stats_get));	/* printed once this handler has returned */
             buf[0] = '2';
 
     	    for(i = 0; i < NUM_ECC_DIGITS; ++i)
@@ -132,17 +139,19 @@ tcpip_handler(void)
 	{
 	    f[i] = (uint8_t)str[i+1];
 	}
-	start_time = clock_time();
-
 	/* Run pass4 and check the validity of reader.*/
+	ibihop_pass_begin(IBIHOP_PASS_OPS(ecc_stats_reset));
 	if (IBIHOP_Pass4(s, &pk_s, &E, f, r, sk_c) != 0)	
 	{   /* Reader authentication failed. */
 	    buf[0] = '8';
 	    buf[1] = 0;
-	    PRINTF("Reader is invalid!\n");
+	    IBIHOP_TRACE_ERROR(IBIHOP_TRACE_READER_INVALID, 0, ECC_CURVE, 0);
+	    ibihop_stats_count(IBIHOP_STATS_READER_REJECTED);
+	    ibihop_stats_handshake(hello_time, 0);
 	}
 	else{/*Reader/server authentication succeed and send tag's response.*/
-	   printf("P4: Completion time %lu / %lu\n", (unsigned long)clock_time() - start_time, CLOCK_SECOND);
+	   ibihop_pass_end(IBIHOP_TRACE_PASS4, 0, ECC_CURVE, IBIHOP_PASS_OPS(ecc_stats_get));
+	   IBIHOP_TRACE_INFO(IBIHOP_TRACE_READER_OK, 0, ECC_CURVE, 0);
 	   buf[0] = '4';
            for(i = 0; i < NUM_ECC_DIGITS; ++i)
     	   {
@@ -151,16 +160,17 @@ tcpip_handler(void)
                buf[NUM_ECC_DIGITS+1] = 0;
 	}
 
-	PRINTF("Reader is authenticated!\n");
 	uip_udp_packet_sendto(client_conn, buf, sizeof(buf), &server_ipaddr, UIP_HTONS(UDP_SERVER_PORT));
     }
     else if(strncmp(uip_appdata,"5",1) == 0)	/*Reader confirmed tag is valid*/
     {
-	PRINTF("OK! Mutual authentication succeed!\n");	
+	IBIHOP_TRACE_INFO(IBIHOP_TRACE_DONE, 0, ECC_CURVE, 0);
+	ibihop_stats_handshake(hello_time, 1);
     }
     else
     {
-	PRINTF("Authentication failed.\n");
+	IBIHOP_TRACE_ERROR(IBIHOP_TRACE_UNEXPECTED, str[0], ECC_CURVE, 0);
+	ibihop_stats_count(IBIHOP_STATS_UNEXPECTED);
     }
   }
 }
@@ -168,10 +178,16 @@ tcpip_handler(void)
 static void
 send_packet(void *ptr)
 {
-    char buf[] = "hello";
+    /* "hello" and our ECC_CURVE (2 bytes, little-endian), for readers that serve several curves. */
+    char buf[] = {'h', 'e', 'l', 'l', 'o', ECC_CURVE & 0xFF, ECC_CURVE >> 8};
 
-    uip_udp_packet_sendto(client_conn, buf, strlen(buf),
+    IBIHOP_TRACE_INFO(IBIHOP_TRACE_HELLO, 0, ECC_CURVE, 0);	/* start of a handshake for sim/run.py */
+    uip_udp_packet_sendto(client_conn, buf, sizeof(buf),
                         &server_ipaddr, UIP_HTONS(UDP_SERVER_PORT));
+#if IBIHOP_STATS
+    hello_time = clock_time();
+#endif
+    ibihop_stats_count(IBIHOP_STATS_STARTED);
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -236,7 +252,6 @@ PROCESS_THREAD(udp_client_process, ev, data)
 #if WITH_COMPOWER
   static int print = 0;
 #endif
-char buf[] = "hello";
   PROCESS_BEGIN();
 
   PROCESS_PAUSE();
@@ -247,6 +262,22 @@ char buf[] = "hello";
 
   print_local_addresses();
   watchdog_stop();	/*avoid dead lock*/
+#if ECC_FIXED_TABLE
+  if(!ecc_table_open(ecc_table_init)) {
+    PRINTF("No generator table for this curve, using the ladder\n");
+  }
+#endif
+#if ECC_DRBG
+  /* Gather the seed now rather than in the first pass, with the node address mixed in so that Cooja
+     motes, whose simulated RSSI carries little noise, still draw different nonces. */
+  ecc_drbg_seed(linkaddr_node_addr.u8, sizeof(linkaddr_node_addr.u8));
+  {
+    uint8_t l_warmup;
+    ecc_drbg_generate(&l_warmup, 1);
+  }
+#endif
+  ibihop_stats_init(IBIHOP_STATS_TAG);
+  ibihop_trace_init();
   /* new connection with remote host */
   client_conn = udp_new(NULL, UIP_HTONS(UDP_SERVER_PORT), NULL); 
   if(client_conn == NULL) {
@@ -268,7 +299,7 @@ char buf[] = "hello";
 
   PROCESS_YIELD();
       
-  uip_udp_packet_sendto(client_conn, buf, strlen(buf), &server_ipaddr, UIP_HTONS(UDP_SERVER_PORT)); /*Send hello to reader*/
+  send_packet(NULL); /*Send hello to reader*/
 
   while(1) {
     PROCESS_YIELD();
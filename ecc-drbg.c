@@ -0,0 +1,207 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+*/
+#include "ecc-drbg.h"
+#include <string.h>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/random.h>
+#elif CONTIKI_TARGET_SKY || CONTIKI_TARGET_Z1
+#include "contiki.h"
+#include "dev/cc2420/cc2420.h"
+#else
+#error "ECC_DRBG: no entropy source for this platform, build with ECC_DRBG=0"
+#endif
+
+#define DRBG_KEY_BYTES 32
+#define DRBG_SEED_BYTES 32
+
+#define ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+#define QUARTERROUND(a, b, c, d) \
+    a += b; d ^= a; d = ROTL32(d, 16); \
+    c += d; b ^= c; b = ROTL32(b, 12); \
+    a += b; d ^= a; d = ROTL32(d, 8); \
+    c += d; b ^= c; b = ROTL32(b, 7)
+
+static uint8_t drbg_key[DRBG_KEY_BYTES];
+static uint8_t drbg_buffer[64 * ECC_DRBG_BLOCKS];
+static unsigned drbg_left;	/* unused bytes at the end of drbg_buffer */
+static uint8_t drbg_gathered;
+
+static uint32_t load32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void store32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/* One ChaCha20 block (RFC 8439) under drbg_key, with block counter p_counter and an all-zero nonce. */
+static void chacha20_block(uint8_t *p_out, uint32_t p_counter)
+{
+    uint32_t l_state[16];
+    uint32_t x[16];
+    unsigned i;
+
+    l_state[0] = 0x61707865;
+    l_state[1] = 0x3320646e;
+    l_state[2] = 0x79622d32;
+    l_state[3] = 0x6b206574;
+    for(i = 0; i < 8; ++i)
+    {
+        l_state[4 + i] = load32(drbg_key + 4 * i);
+    }
+    l_state[12] = p_counter;
+    l_state[13] = l_state[14] = l_state[15] = 0;
+
+    memcpy(x, l_state, sizeof(x));
+    for(i = 0; i < 10; ++i)
+    {
+        QUARTERROUND(x[0], x[4], x[8], x[12]);
+        QUARTERROUND(x[1], x[5], x[9], x[13]);
+        QUARTERROUND(x[2], x[6], x[10], x[14]);
+        QUARTERROUND(x[3], x[7], x[11], x[15]);
+        QUARTERROUND(x[0], x[5], x[10], x[15]);
+        QUARTERROUND(x[1], x[6], x[11], x[12]);
+        QUARTERROUND(x[2], x[7], x[8], x[13]);
+        QUARTERROUND(x[3], x[4], x[9], x[14]);
+    }
+    for(i = 0; i < 16; ++i)
+    {
+        store32(p_out + 4 * i, x[i] + l_state[i]);
+    }
+}
+
+/* Refill the buffer and take its first 32 bytes as the next key, so that bytes already handed out cannot be
+   recomputed from the state left in RAM. */
+static void drbg_refill(void)
+{
+    unsigned i;
+
+    for(i = 0; i < ECC_DRBG_BLOCKS; ++i)
+    {
+        chacha20_block(drbg_buffer + 64 * i, i);
+    }
+    memcpy(drbg_key, drbg_buffer, DRBG_KEY_BYTES);
+    memset(drbg_buffer, 0, DRBG_KEY_BYTES);
+    drbg_left = sizeof(drbg_buffer) - DRBG_KEY_BYTES;
+}
+
+#if defined(__linux__)
+
+static void drbg_entropy(uint8_t *p_dest, unsigned p_size)
+{
+    ssize_t l_read;
+
+    while(p_size)
+    {
+        l_read = getrandom(p_dest, p_size, 0);
+        if(l_read < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            /* No kernel entropy. Going on would leave the seed to ecc_drbg_seed() alone, or all zero, and
+               the nonces predictable: stop instead. */
+            perror("ecc_drbg: getrandom");
+            abort();
+        }
+        p_dest += l_read;
+        p_size -= (unsigned)l_read;
+    }
+}
+
+#else
+
+/* The low bits of the CC2420 RSSI register follow the receiver noise. Each seed byte folds
+   ECC_DRBG_RSSI_SAMPLES readings together with the rtimer, which also picks up the jitter of the
+   RSSI_VALID wait. Under Cooja the RSSI is simulated and carries little noise. */
+static void drbg_entropy(uint8_t *p_dest, unsigned p_size)
+{
+    unsigned i, j;
+    uint8_t l_acc;
+
+    for(i = 0; i < p_size; ++i)
+    {
+        l_acc = p_dest[i];
+        for(j = 0; j < ECC_DRBG_RSSI_SAMPLES; ++j)
+        {
+            l_acc = (uint8_t)((l_acc << 3) | (l_acc >> 5));
+            l_acc ^= (uint8_t)cc2420_rssi() ^ (uint8_t)RTIMER_NOW();
+        }
+        p_dest[i] = l_acc;
+    }
+}
+
+#endif
+
+void ecc_drbg_seed(const uint8_t *p_seed, unsigned p_size)
+{
+    unsigned i, l_size;
+
+    while(p_size)
+    {
+        l_size = (p_size < DRBG_KEY_BYTES ? p_size : DRBG_KEY_BYTES);
+        for(i = 0; i < l_size; ++i)
+        {
+            drbg_key[i] ^= p_seed[i];
+        }
+        drbg_refill();
+        p_seed += l_size;
+        p_size -= l_size;
+    }
+}
+
+void ecc_drbg_instantiate(const uint8_t *p_seed, unsigned p_size)
+{
+    memset(drbg_key, 0, sizeof(drbg_key));
+    memset(drbg_buffer, 0, sizeof(drbg_buffer));
+    drbg_left = 0;
+    drbg_gathered = 1;
+    ecc_drbg_seed(p_seed, p_size);
+}
+
+void ecc_drbg_generate(uint8_t *p_dest, unsigned p_size)
+{
+    uint8_t l_seed[DRBG_SEED_BYTES];
+    uint8_t *l_src;
+    unsigned l_size;
+
+    if(!drbg_gathered)
+    {
+        memset(l_seed, 0, sizeof(l_seed));
+        drbg_entropy(l_seed, sizeof(l_seed));
+        ecc_drbg_seed(l_seed, sizeof(l_seed));
+        memset(l_seed, 0, sizeof(l_seed));
+        drbg_gathered = 1;
+    }
+
+    while(p_size)
+    {
+        if(!drbg_left)
+        {
+            drbg_refill();
+        }
+        l_size = (p_size < drbg_left ? p_size : drbg_left);
+        l_src = drbg_buffer + sizeof(drbg_buffer) - drbg_left;
+        memcpy(p_dest, l_src, l_size);
+        memset(l_src, 0, l_size);
+        drbg_left -= l_size;
+        p_dest += l_size;
+        p_size -= l_size;
+    }
+}
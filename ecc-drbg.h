@@ -0,0 +1,60 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Random bytes for nano-ecc (ECC_DRBG=1): a ChaCha20 generator with fast key erasure, seeded on first use from
+getrandom() on Linux (native target, readers on a host) or from CC2420 RSSI noise on Tmote Sky and Z1. Output
+is handed out from a buffer of ECC_DRBG_BLOCKS keystream blocks, so a nonce costs a memcpy most of the time.
+There is a single generator for all the curves of an image; it is not for use from interrupts.
+*/
+#ifndef ECC_DRBG_H_
+#define ECC_DRBG_H_
+
+#include <stdint.h>
+
+/* ChaCha20 blocks (64 bytes each) computed per refill. The first 32 bytes become the next key, the rest is
+   output, so larger buffers spend less on rekeying at the cost of RAM. */
+#ifndef ECC_DRBG_BLOCKS
+#define ECC_DRBG_BLOCKS 2
+#endif
+
+/* RSSI samples folded into each seed byte on the CC2420. */
+#ifndef ECC_DRBG_RSSI_SAMPLES
+#define ECC_DRBG_RSSI_SAMPLES 16
+#endif
+
+/*
+ecc_drbg_generate:
+	Fill p_dest with random bytes. The first call gathers the platform entropy; on Linux it aborts the
+	program if getrandom() fails, rather than hand out bytes from a seed that can be guessed.
+Input:
+	p_size	- number of bytes.
+Output:
+	p_dest	- p_size random bytes.
+*/
+void ecc_drbg_generate(uint8_t *p_dest, unsigned p_size);
+
+/*
+ecc_drbg_seed:
+	Mix additional data (e.g. a device secret or a timestamp) into the generator. It adds to the platform
+	entropy and never replaces it.
+Input:
+	p_seed	- the data.
+	p_size	- its length in bytes.
+*/
+void ecc_drbg_seed(const uint8_t *p_seed, unsigned p_size);
+
+/*
+ecc_drbg_instantiate:
+	Restart the generator from p_seed alone, without platform entropy, so that its output depends on the
+	seed only. For trace replay and tests; never for keys or nonces that must stay secret.
+Input:
+	p_seed	- the seed.
+	p_size	- its length in bytes.
+*/
+void ecc_drbg_instantiate(const uint8_t *p_seed, unsigned p_size);
+
+#endif /* ECC_DRBG_H_ */
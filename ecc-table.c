@@ -0,0 +1,63 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+*/
+#include "contiki.h"
+#include "sys/rtimer.h"
+#include "ecc-table.h"
+#include <string.h>
+
+#ifdef ECC_TABLE_XMEM_OFFSET
+#include "dev/xmem.h"
+#else
+#include "cfs/cfs.h"
+#endif
+
+struct ecc_table_stats ecc_table_stats;
+
+#ifndef ECC_TABLE_XMEM_OFFSET
+static int table_fd = -1;
+#endif
+
+/* Reads one entry (or the header) of the table. The time spent, SPI transfer included, goes to ecc_table_stats. */
+static int ecc_table_read(uint32_t p_offset, uint8_t *p_dest, unsigned p_size)
+{
+    rtimer_clock_t l_start = RTIMER_NOW();
+    int l_ok;
+
+#ifdef ECC_TABLE_XMEM_OFFSET
+    l_ok = (xmem_pread(p_dest, p_size, ECC_TABLE_XMEM_OFFSET + p_offset) == (int)p_size);
+#else
+    l_ok = (cfs_seek(table_fd, p_offset, CFS_SEEK_SET) == (cfs_offset_t)p_offset
+            && cfs_read(table_fd, p_dest, p_size) == (int)p_size);
+#endif
+
+    ecc_table_stats.ticks += (rtimer_clock_t)(RTIMER_NOW() - l_start);
+    ecc_table_stats.reads++;
+    ecc_table_stats.bytes += p_size;
+    return l_ok;
+}
+
+int ecc_table_open(int (*p_init)(ecc_table_read_fn p_read))
+{
+#ifndef ECC_TABLE_XMEM_OFFSET
+    if(table_fd < 0)
+    {
+        table_fd = cfs_open(ECC_TABLE_FILE, CFS_READ);
+    }
+    if(table_fd < 0)
+    {
+        return 0;
+    }
+#endif
+    return p_init(ecc_table_read);
+}
+
+void ecc_table_stats_reset(void)
+{
+    memset(&ecc_table_stats, 0, sizeof(ecc_table_stats));
+}
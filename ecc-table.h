@@ -0,0 +1,52 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Contiki glue for the ECC_FIXED_TABLE generator table: reads it from the external flash, either
+raw through xmem or from a Coffee file, and keeps count of the flash traffic.
+*/
+#ifndef ECC_TABLE_H_
+#define ECC_TABLE_H_
+
+#include "nano-ecc.h"
+
+/* Name of the Coffee file holding the table. */
+#ifndef ECC_TABLE_FILE
+#define ECC_TABLE_FILE "ecc-table"
+#endif
+
+/* Define ECC_TABLE_XMEM_OFFSET to read the table raw from xmem at that offset instead of from ECC_TABLE_FILE.
+   The region must not overlap the Coffee file system. */
+
+/* Flash traffic of the table reads since the last ecc_table_stats_reset(). */
+struct ecc_table_stats {
+    unsigned long reads;
+    unsigned long bytes;
+    unsigned long ticks;	/* rtimer ticks spent in the reads */
+};
+
+extern struct ecc_table_stats ecc_table_stats;
+
+/*
+ecc_table_open:
+	Register the generator table with nano-ecc, from xmem at ECC_TABLE_XMEM_OFFSET if that is defined,
+	from the Coffee file ECC_TABLE_FILE otherwise.
+Input:
+	p_init	- ecc_table_init() of the curve the table is for; in a multi-curve image, the TableInit
+		  of its IBIHOP_Curve.
+Output:
+	1	- the table is used for the generator multiplications.
+	0	- the table is missing or does not match ECC_CURVE; the ladder is used.
+*/
+int ecc_table_open(int (*p_init)(ecc_table_read_fn p_read));
+
+/*
+ecc_table_stats_reset:
+	Clear ecc_table_stats.
+*/
+void ecc_table_stats_reset(void);
+
+#endif /* ECC_TABLE_H_ */
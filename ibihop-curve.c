@@ -0,0 +1,58 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+*/
+#include "nano-ecc.h"
+#include "ibihop-curve.h"
+#include <stddef.h>
+
+extern const IBIHOP_Curve secp128r1_ibihop_curve;
+extern const IBIHOP_Curve secp160r1_ibihop_curve;
+extern const IBIHOP_Curve secp192r1_ibihop_curve;
+extern const IBIHOP_Curve secp256r1_ibihop_curve;
+extern const IBIHOP_Curve secp384r1_ibihop_curve;
+extern const IBIHOP_Curve curve25519_ibihop_curve;
+extern const IBIHOP_Curve sect163k1_ibihop_curve;
+
+const IBIHOP_Curve *const IBIHOP_Curves[] = {
+#if IBIHOP_WITH_secp128r1
+    &secp128r1_ibihop_curve,
+#endif
+#if IBIHOP_WITH_secp160r1
+    &secp160r1_ibihop_curve,
+#endif
+#if IBIHOP_WITH_secp192r1
+    &secp192r1_ibihop_curve,
+#endif
+#if IBIHOP_WITH_secp256r1
+    &secp256r1_ibihop_curve,
+#endif
+#if IBIHOP_WITH_secp384r1
+    &secp384r1_ibihop_curve,
+#endif
+#if IBIHOP_WITH_curve25519
+    &curve25519_ibihop_curve,
+#endif
+#if IBIHOP_WITH_sect163k1
+    &sect163k1_ibihop_curve,
+#endif
+    NULL
+};
+
+const IBIHOP_Curve *IBIHOP_FindCurve(uint16_t p_id)
+{
+    unsigned i;
+
+    for(i = 0; IBIHOP_Curves[i] != NULL; ++i)
+    {
+        if(IBIHOP_Curves[i]->id == p_id)
+        {
+            return IBIHOP_Curves[i];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,93 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Curve descriptors: IBIHOP for several curves in one image, e.g. a reader serving both secp128r1 and
+secp256r1 tags. Each curve is a separate build of nano-ecc.c and ibihop.c (ibihop-<curve>.c, with
+ECC_NAMESPACE set to "<curve>_"), so every curve keeps its own specialized field kernels and
+reductions, all chosen at compile time. A descriptor binds the constants of one curve to the entry
+points of its build; the indirect call happens once per pass, never inside the field arithmetic.
+
+Points are passed as 2*digits bytes (x then y, the EccPoint layout) and scalars as digits bytes.
+The batch functions take count consecutive points/scalars.
+
+The curves in the image are chosen with IBIHOP_CURVES in the Makefile, which defines
+IBIHOP_WITH_<curve>=1 for each of them.
+*/
+
+#ifndef _IBIHOP_CURVE_H_
+#define _IBIHOP_CURVE_H_
+
+#include "nano-ecc.h"
+
+/* Largest NUM_ECC_DIGITS among the curves of the image: sizes buffers that must hold a value of any of them.
+   Without any IBIHOP_WITH_<curve>, that of the largest curve. */
+#ifndef IBIHOP_MAX_DIGITS
+#if IBIHOP_WITH_secp384r1
+#define IBIHOP_MAX_DIGITS 48
+#elif IBIHOP_WITH_secp256r1 || IBIHOP_WITH_curve25519
+#define IBIHOP_MAX_DIGITS 32
+#elif IBIHOP_WITH_secp192r1
+#define IBIHOP_MAX_DIGITS 24
+#elif IBIHOP_WITH_secp160r1 || IBIHOP_WITH_sect163k1
+#define IBIHOP_MAX_DIGITS 21
+#elif IBIHOP_WITH_secp128r1
+#define IBIHOP_MAX_DIGITS 16
+#else
+#define IBIHOP_MAX_DIGITS 48
+#endif
+#endif
+
+typedef struct IBIHOP_Curve
+{
+    const char *name;
+    uint16_t id;		/* ECC_CURVE value */
+    uint8_t digits;		/* NUM_ECC_DIGITS */
+    const uint8_t *p;
+    const uint8_t *n;
+    const uint8_t *G;
+
+    /* Field and point arithmetic mod p of this curve. */
+    void (*modMult)(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right);
+    void (*mult)(uint8_t *p_result, uint8_t *p_point, uint8_t *p_scalar);
+    /* 1 if p_point is a point of the curve with x != 0, as the R of message 2 must be; 0 otherwise. */
+    int (*ValidPublicKey)(uint8_t *p_point);
+
+    /* The IBIHOP functions of ibihop.h. */
+    void (*KeyGen)(uint8_t *pk, uint8_t *sk);
+    void (*Pass1)(uint8_t *E, uint8_t *e, uint8_t *e_inv);
+    void (*Pass1_batch)(uint8_t *E, uint8_t *e, uint8_t *e_inv, unsigned p_count);
+    void (*Pass2)(uint8_t *R, uint8_t *r);
+    void (*Pass3)(uint8_t *f, uint8_t *R, uint8_t *e, uint8_t *sk_r);
+    void (*Pass3_batch)(uint8_t *f, uint8_t *R, uint8_t *e, uint8_t *sk_r, unsigned p_count);
+    int (*Pass4)(uint8_t *s, uint8_t *pk_r, uint8_t *E, uint8_t *f, uint8_t *r, uint8_t *sk_t);
+    int (*TagVerf)(uint8_t *R, uint8_t *e_inv, uint8_t *s, uint8_t *pk_t);
+
+#if ECC_FIXED_TABLE
+    /* ecc_table_init() of this curve. */
+    int (*TableInit)(int (*p_read)(uint32_t p_offset, uint8_t *p_dest, unsigned p_size));
+#endif
+#if ECC_STATS
+    /* ecc_stats_get() and ecc_stats_reset() of this curve. */
+    void (*StatsGet)(EccStats *p_stats);
+    void (*StatsReset)(void);
+#endif
+} IBIHOP_Curve;
+
+/* Descriptors of the curves in the image, terminated by NULL. */
+extern const IBIHOP_Curve *const IBIHOP_Curves[];
+
+/*
+IBIHOP_FindCurve:
+	Look up a curve of the image.
+Input:
+	p_id	- ECC_CURVE value of the curve.
+Output:
+	the descriptor, or NULL if the curve is not in the image.
+*/
+const IBIHOP_Curve *IBIHOP_FindCurve(uint16_t p_id);
+
+#endif
@@ -0,0 +1,6 @@
+/* curve25519 build of nano-ecc and IBIHOP for multi-curve images (see ibihop-curve.h). */
+#undef ECC_CURVE
+#define ECC_CURVE curve25519
+#define ECC_NAMESPACE curve25519_
+#define IBIHOP_CURVE_NAME "curve25519"
+#include "ibihop-curve.inc"
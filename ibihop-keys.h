@@ -0,0 +1,89 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Demo key material of the tag (client) and the reader (server), one set per curve, named
+<key>_<ECC_CURVE>: PKC/SKC are the tag's public/private keys, PKS/SKS the reader's.
+IBIHOP_KEY(PKS, ECC_CURVE) picks the set of the curve being built.
+*/
+
+#ifndef _IBIHOP_KEYS_H_
+#define _IBIHOP_KEYS_H_
+
+#define IBIHOP_KEY1(key, curve) key##_##curve
+#define IBIHOP_KEY(key, curve) IBIHOP_KEY1(key, curve)
+
+/* secp128r1 */
+#define PKC_16 { \
+    {0x98, 0xA2, 0x89, 0x98, 0x66, 0x53, 0xF0, 0x0C, 0x41, 0x39, 0xD0, 0x40, 0x72, 0xEC, 0x53, 0xDB}, \
+    {0xBD, 0x0A, 0xA4, 0x5E, 0x6F, 0x11, 0x59, 0x0A, 0x9E, 0x76, 0x0D, 0xA6, 0x46, 0x80, 0xAF, 0x26}}
+#define SKC_16 {0x13, 0x3D, 0xBB, 0xA7, 0x33, 0xBE, 0xA2, 0xF6, 0x6E, 0x6B, 0xAE, 0xEF, 0x19, 0x79, 0x18, 0xB5}
+#define PKS_16 { \
+    {0x1A, 0x18, 0x27, 0xC8, 0x49, 0x63, 0xB2, 0x15, 0x57, 0x46, 0xAA, 0x5A, 0xD2, 0xE5, 0x83, 0x9B}, \
+    {0xD9, 0x57, 0xFB, 0x93, 0x4E, 0xCF, 0x92, 0xDA, 0x3D, 0x6F, 0xFC, 0x1B, 0x04, 0xE1, 0xEC, 0x75}}
+#define SKS_16 {0x37, 0x19, 0xCB, 0x94, 0x6F, 0x8C, 0xDA, 0xC0, 0xD3, 0x4E, 0x60, 0x5B, 0xD3, 0x12, 0x0C, 0xE6}
+
+/* secp160r1 */
+#define PKC_20 { \
+    {0x1F, 0x00, 0x74, 0x16, 0x7A, 0x59, 0xA9, 0xCC, 0xCB, 0x10, 0x5B, 0x8A, 0xF1, 0xFC, 0x96, 0xA1, 0x7C, 0x65, 0xC4, 0xA4, 0x00}, \
+    {0x8A, 0x55, 0xD8, 0xA5, 0xAF, 0xD7, 0x6E, 0x69, 0xB5, 0xB8, 0x10, 0x4E, 0x32, 0x45, 0x41, 0x80, 0x98, 0x3B, 0x5B, 0x9D, 0x00}}
+#define SKC_20 {0xA4, 0xC1, 0x14, 0x1C, 0x84, 0xB4, 0x7C, 0x68, 0xA5, 0xCF, 0x71, 0x4B, 0x87, 0xD7, 0xFF, 0xEB, 0xB9, 0x76, 0x9A, 0x71, 0x00}
+#define PKS_20 { \
+    {0x28, 0xA2, 0x1C, 0xD5, 0xE5, 0x32, 0x3A, 0x32, 0xC1, 0xF9, 0x27, 0x73, 0x56, 0x3C, 0x32, 0xC2, 0xD0, 0xFB, 0xC4, 0x7C, 0x00}, \
+    {0xE4, 0x10, 0x6D, 0xF4, 0xCE, 0x3D, 0xED, 0xEE, 0x56, 0x75, 0xA5, 0x10, 0x39, 0xF3, 0x09, 0x11, 0x91, 0x35, 0xF4, 0x05, 0x00}}
+#define SKS_20 {0xD4, 0xC2, 0xF4, 0xA0, 0x3B, 0xBB, 0x93, 0x26, 0x86, 0x30, 0xA7, 0x0C, 0x36, 0x00, 0xE1, 0xC4, 0x29, 0x3E, 0xE9, 0xFB, 0x00}
+
+/* secp192r1 */
+#define PKC_24 { \
+    {0xEE, 0xB9, 0x10, 0x51, 0x7B, 0xBD, 0xF3, 0x7A, 0x68, 0x48, 0x50, 0xF7, 0xD5, 0xAF, 0xD5, 0x4E, 0x6F, 0x9D, 0xA6, 0xFE, 0x83, 0x50, 0x6C, 0x73}, \
+    {0x4A, 0x91, 0xDD, 0x1F, 0x30, 0x05, 0x1D, 0x88, 0xB7, 0x76, 0x3D, 0xE1, 0x9F, 0x4E, 0x8A, 0x5F, 0xA9, 0xE4, 0x80, 0x12, 0xD5, 0x4D, 0x8B, 0xDD}}
+#define SKC_24 {0x3F, 0xFC, 0xED, 0xF0, 0xFC, 0x76, 0x8E, 0x06, 0x93, 0x15, 0x0B, 0x10, 0xF5, 0x8E, 0xFA, 0xCD, 0xF8, 0x62, 0xB8, 0x37, 0xDF, 0x77, 0x1D, 0x73}
+#define PKS_24 { \
+    {0x58, 0x5B, 0x01, 0xC2, 0x6B, 0xEA, 0xF3, 0xD1, 0x81, 0x09, 0xA9, 0x47, 0x54, 0xEC, 0x0B, 0x44, 0x18, 0x9C, 0xE2, 0xE1, 0xF4, 0x76, 0x2E, 0x90}, \
+    {0x0F, 0x34, 0x16, 0xE8, 0xB9, 0xC0, 0xE1, 0x9F, 0x11, 0x41, 0x97, 0x84, 0xAD, 0xFC, 0xE1, 0xB6, 0x42, 0x03, 0x62, 0x79, 0x37, 0x86, 0x22, 0x15}}
+#define SKS_24 {0x61, 0xAC, 0x91, 0xAE, 0xBC, 0xF3, 0x33, 0x86, 0x2C, 0xEF, 0xBB, 0x11, 0x01, 0x23, 0xD7, 0x1B, 0xB9, 0x4A, 0xBE, 0xAC, 0x9B, 0xF5, 0xBE, 0x46}
+
+/* secp256r1 */
+#define PKC_32 { \
+    {0x15, 0x42, 0x01, 0xFB, 0x94, 0xF1, 0x8F, 0xFF, 0x69, 0x7E, 0x2F, 0xBA, 0xA5, 0x89, 0x87, 0x27, 0xAA, 0x43, 0x44, 0xD9, 0x81, 0xBB, 0x4F, 0x3F, 0xD9, 0xF7, 0x46, 0xEE, 0x62, 0xB6, 0xF2, 0xA7}, \
+    {0xD5, 0x2C, 0xC8, 0xF4, 0xD7, 0xC0, 0xFF, 0x6B, 0x83, 0x95, 0xF2, 0x9F, 0xF7, 0x5D, 0x6C, 0x87, 0xE7, 0x59, 0xBF, 0x52, 0xF7, 0x49, 0x67, 0x7E, 0x91, 0x69, 0xF3, 0x66, 0x0C, 0xBF, 0xB8, 0x58}}
+#define SKC_32 {0x7E, 0x95, 0x0D, 0x3B, 0xDF, 0x2E, 0xB4, 0xB0, 0x02, 0x63, 0x98, 0x1A, 0xA1, 0x30, 0x03, 0xF6, 0x3A, 0x7F, 0xE3, 0xD2, 0x96, 0xEA, 0x95, 0xD5, 0x0F, 0x6E, 0xD6, 0x33, 0xC4, 0x6F, 0x34, 0x42}
+#define PKS_32 { \
+    {0x94, 0x4D, 0x3A, 0x71, 0x55, 0xBB, 0x9F, 0xAD, 0x41, 0xB0, 0xA1, 0x64, 0xE6, 0x97, 0xC9, 0x59, 0x4B, 0xD1, 0xEC, 0x4D, 0x31, 0x4C, 0x66, 0x44, 0x06, 0x81, 0xFE, 0xB6, 0x84, 0xDD, 0xD0, 0xF9}, \
+    {0x86, 0x62, 0x39, 0xDA, 0xD5, 0x98, 0x01, 0x6F, 0x1D, 0xAA, 0x3D, 0xC0, 0x8A, 0x8D, 0xB6, 0x9A, 0x71, 0x5F, 0x80, 0xA8, 0xA7, 0x75, 0x63, 0x1C, 0x1D, 0x13, 0xDD, 0x9D, 0x80, 0x3A, 0xF7, 0x56}}
+#define SKS_32 {0x05, 0x41, 0x7E, 0xE5, 0x70, 0x33, 0x95, 0x73, 0x96, 0x2D, 0x8D, 0x38, 0x5E, 0x90, 0x2E, 0x99, 0x10, 0x12, 0x6C, 0xA6, 0xFD, 0x01, 0x7B, 0x0C, 0x6F, 0x52, 0x40, 0x34, 0xC1, 0x74, 0x77, 0xC7}
+
+/* secp384r1 */
+#define PKC_48 { \
+    {0x83, 0xCD, 0xA5, 0xD9, 0xA3, 0x1B, 0x71, 0x16, 0x03, 0xD5, 0xA8, 0xC4, 0x76, 0xB9, 0x8D, 0xC3, 0xE1, 0xCD, 0xFE, 0xF2, 0xCD, 0x1F, 0x8F, 0x10, 0x61, 0x46, 0x93, 0x17, 0x9F, 0x1A, 0x22, 0xEC, 0xC4, 0xBF, 0x9F, 0x6F, 0xF6, 0x0A, 0x43, 0x1E, 0xD2, 0xAA, 0x6D, 0xAE, 0x52, 0x97, 0x11, 0x34}, \
+    {0x8D, 0xBC, 0x69, 0xA8, 0x83, 0xBC, 0xC5, 0x9C, 0x71, 0xFA, 0x1D, 0xE9, 0xC0, 0x94, 0x51, 0x7C, 0x29, 0x20, 0xA5, 0x29, 0xA6, 0x4E, 0xA2, 0x54, 0x06, 0x97, 0x87, 0x53, 0xB6, 0x61, 0x79, 0x82, 0x84, 0xAF, 0x16, 0x89, 0x10, 0x03, 0xF5, 0x0B, 0xA7, 0xC0, 0x3E, 0x1B, 0xBE, 0x42, 0xD9, 0x8D}}
+#define SKC_48 {0x24, 0xA6, 0x3B, 0x89, 0x6E, 0xE8, 0x34, 0x5E, 0xCB, 0x47, 0x0B, 0x38, 0x29, 0x56, 0x59, 0xD0, 0x98, 0xDC, 0xA7, 0xDB, 0x04, 0x5A, 0xF8, 0x20, 0xB2, 0x95, 0xD5, 0xED, 0x77, 0x7E, 0x7D, 0x9B, 0x24, 0xB9, 0x25, 0x92, 0xA1, 0x5A, 0xF0, 0x6C, 0xA2, 0xFC, 0xA5, 0xCB, 0x53, 0xFF, 0x9C, 0xEB}
+#define PKS_48 { \
+    {0xB9, 0x41, 0x2D, 0x3F, 0x69, 0x56, 0x2F, 0x14, 0x06, 0xFB, 0x20, 0x70, 0xB4, 0x15, 0x3C, 0x44, 0xC6, 0x09, 0x7A, 0x2A, 0x5B, 0xF9, 0xD4, 0xC4, 0x78, 0xD8, 0x59, 0xC7, 0x8F, 0xAC, 0x5A, 0xF2, 0x97, 0xC8, 0xA7, 0xEE, 0x4E, 0x70, 0x8A, 0xAB, 0x00, 0xD6, 0xC1, 0x19, 0x1F, 0xB8, 0xFE, 0x86}, \
+    {0xDA, 0xC5, 0xA1, 0x50, 0x79, 0x0D, 0xDB, 0x2F, 0x1A, 0x64, 0x52, 0xA2, 0x8C, 0x33, 0xBC, 0x3C, 0xE9, 0xE9, 0x7C, 0x2B, 0x41, 0x4C, 0x5C, 0xBA, 0x6F, 0x96, 0x70, 0xB7, 0xBF, 0xC8, 0x55, 0x0E, 0x69, 0x45, 0x8A, 0x7B, 0x25, 0x14, 0xA7, 0x60, 0x4A, 0x25, 0xD6, 0x67, 0xBF, 0x79, 0xB7, 0x6C}}
+#define SKS_48 {0xDC, 0x44, 0xC6, 0xE1, 0x9F, 0xBE, 0x01, 0x51, 0x54, 0xD7, 0x3F, 0xCB, 0x55, 0xBD, 0x67, 0x79, 0x76, 0x8D, 0x0B, 0x18, 0xE8, 0xFC, 0x85, 0x8A, 0xF8, 0x2A, 0x56, 0x4C, 0x2A, 0xF2, 0x37, 0x07, 0x37, 0xFE, 0xE8, 0xD6, 0xBD, 0xE9, 0x28, 0x12, 0xC0, 0x68, 0xDE, 0x16, 0x25, 0x46, 0x8F, 0x9C}
+
+/* curve25519 (x only, y is 0) */
+#define PKC_25519 { \
+    {0x4E, 0x29, 0xB4, 0x9F, 0xBB, 0xC4, 0x95, 0x11, 0xB8, 0xDA, 0x76, 0x22, 0x26, 0xF1, 0xA6, 0xAE, 0x49, 0x76, 0x5A, 0x96, 0x2E, 0x7D, 0xBC, 0x94, 0xDC, 0x78, 0x9D, 0x4F, 0x2A, 0xA4, 0xA1, 0x4A}, \
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}
+#define SKC_25519 {0x63, 0x91, 0xEE, 0x42, 0xE8, 0x83, 0xBD, 0x1E, 0x96, 0xD3, 0x14, 0x2B, 0x82, 0xA4, 0xF3, 0x91, 0x7D, 0x71, 0x29, 0x6E, 0x08, 0x38, 0xDD, 0x53, 0x09, 0x8C, 0x03, 0x9A, 0x91, 0x4B, 0xC7, 0x0A}
+#define PKS_25519 { \
+    {0xD9, 0x6B, 0x20, 0x7D, 0xB9, 0xFF, 0x1B, 0x97, 0xC5, 0x00, 0xE8, 0xFE, 0xD4, 0xE0, 0xDD, 0xE1, 0x12, 0x88, 0xCF, 0x8D, 0xF0, 0x9E, 0xD4, 0xBA, 0x6C, 0x33, 0xC5, 0x28, 0x60, 0xB6, 0xFA, 0x72}, \
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}
+#define SKS_25519 {0xAD, 0xAC, 0x61, 0xB6, 0xC9, 0xD8, 0x85, 0x5E, 0xE6, 0x86, 0x94, 0x2F, 0x0F, 0xB3, 0x32, 0xEB, 0x11, 0xF9, 0x98, 0x1B, 0x32, 0x76, 0x6E, 0x3B, 0x02, 0x72, 0xD5, 0x94, 0xBD, 0x9D, 0x7E, 0x01}
+
+/* sect163k1 */
+#define PKC_163 { \
+    {0x98, 0x6C, 0xF4, 0x22, 0xA5, 0x9D, 0x81, 0xC5, 0xFA, 0x2A, 0xB2, 0x96, 0xF6, 0x49, 0x95, 0x87, 0x79, 0x73, 0xDB, 0x33, 0x07}, \
+    {0xCE, 0x93, 0xD3, 0x91, 0xC5, 0x0E, 0x8F, 0x44, 0x02, 0x91, 0x45, 0xFF, 0xCA, 0x81, 0x49, 0xCC, 0x7A, 0x2A, 0xF8, 0xD6, 0x02}}
+#define SKC_163 {0xF2, 0x24, 0x64, 0x68, 0x19, 0x24, 0xEA, 0x88, 0x43, 0x25, 0x73, 0x95, 0x2E, 0x93, 0x27, 0xBA, 0xC2, 0xEF, 0x48, 0xE8, 0x00}
+#define PKS_163 { \
+    {0x4F, 0xB4, 0xAD, 0xCF, 0x60, 0x0F, 0x6B, 0xE7, 0xD6, 0x4F, 0x95, 0xD4, 0x41, 0x4E, 0x42, 0xED, 0x21, 0x4B, 0x92, 0x88, 0x04}, \
+    {0x45, 0x56, 0x88, 0xAB, 0xA8, 0x05, 0xDD, 0xBC, 0x0E, 0x55, 0xA0, 0x98, 0xF4, 0x7E, 0x9D, 0x88, 0xAB, 0x4C, 0xA3, 0xD4, 0x01}}
+#define SKS_163 {0x8B, 0x44, 0x2D, 0xC5, 0xDE, 0x48, 0xAB, 0x18, 0xCD, 0x0C, 0x22, 0xED, 0x22, 0x40, 0x78, 0xF1, 0x8E, 0x46, 0xC1, 0xE3, 0x01}
+
+#endif
@@ -0,0 +1,6 @@
+/* secp256r1 build of nano-ecc and IBIHOP for multi-curve images (see ibihop-curve.h). */
+#undef ECC_CURVE
+#define ECC_CURVE secp256r1
+#define ECC_NAMESPACE secp256r1_
+#define IBIHOP_CURVE_NAME "secp256r1"
+#include "ibihop-curve.inc"
@@ -0,0 +1,6 @@
+/* sect163k1 build of nano-ecc and IBIHOP for multi-curve images (see ibihop-curve.h). */
+#undef ECC_CURVE
+#define ECC_CURVE sect163k1
+#define ECC_NAMESPACE sect163k1_
+#define IBIHOP_CURVE_NAME "sect163k1"
+#include "ibihop-curve.inc"
@@ -0,0 +1,185 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+*/
+#include "ibihop-stats.h"
+#include "contiki-net.h"
+#include <string.h>
+
+#define UIP_UDP_BUF ((struct uip_udpip_hdr *)&uip_buf[UIP_LLH_LEN])
+
+#define STATS_HISTOGRAMS (IBIHOP_STATS_TAGVERF + 1)	/* latency, then passes 1 to 5 */
+#define STATS_REPLY_MAX 48
+
+typedef struct stats_histogram
+{
+    uint32_t sum_ms;
+    uint16_t count[IBIHOP_STATS_BUCKETS];	/* saturate at 0xFFFF */
+} stats_histogram;
+
+static uint32_t stats_counter[IBIHOP_STATS_COUNTERS];
+static stats_histogram stats_histogram_of[STATS_HISTOGRAMS];
+static uint8_t stats_queue_depth, stats_queue_max;
+static uint8_t stats_role;
+static clock_time_t stats_pass_start;
+
+static struct uip_udp_conn *stats_conn;
+static uint8_t stats_reply[STATS_REPLY_MAX];
+
+PROCESS(ibihop_stats_process, "IBIHOP stats");
+
+static void histogram_add(stats_histogram *p_histogram, clock_time_t p_ticks)
+{
+    uint32_t l_ms = (uint32_t)p_ticks * 1000 / CLOCK_SECOND;
+    uint32_t l_bound = IBIHOP_STATS_BUCKET0_MS;
+    unsigned b = 0;
+
+    while(b < IBIHOP_STATS_BUCKETS - 1 && l_ms >= l_bound)
+    {
+        l_bound <<= 1;
+        ++b;
+    }
+    if(p_histogram->count[b] != 0xFFFF)
+    {
+        ++p_histogram->count[b];
+    }
+    p_histogram->sum_ms += l_ms;
+}
+
+void ibihop_stats_init(uint8_t p_role)
+{
+    stats_role = p_role;
+    process_start(&ibihop_stats_process, NULL);
+}
+
+void ibihop_stats_count(uint8_t p_counter)
+{
+    ++stats_counter[p_counter];
+}
+
+void ibihop_stats_handshake(clock_time_t p_started, uint8_t p_ok)
+{
+    if(p_ok)
+    {
+        ++stats_counter[IBIHOP_STATS_COMPLETED];
+        histogram_add(&stats_histogram_of[0], clock_time() - p_started);
+    }
+    else
+    {
+        ++stats_counter[IBIHOP_STATS_FAILED];
+    }
+}
+
+void ibihop_stats_begin(void)
+{
+    stats_pass_start = clock_time();
+}
+
+void ibihop_stats_end(uint8_t p_pass)
+{
+    histogram_add(&stats_histogram_of[p_pass], clock_time() - stats_pass_start);
+}
+
+void ibihop_stats_queue(uint8_t p_depth)
+{
+    stats_queue_depth = p_depth;
+    if(p_depth > stats_queue_max)
+    {
+        stats_queue_max = p_depth;
+    }
+}
+
+static uint8_t *put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t *put32(uint8_t *p, uint32_t v)
+{
+    p = put16(p, (uint16_t)v);
+    return put16(p, (uint16_t)(v >> 16));
+}
+
+/* Builds the answer to the request in uip_appdata and returns its length, 0 to ignore the request. */
+static unsigned stats_answer(void)
+{
+    const uint8_t *l_request = (const uint8_t *)uip_appdata;
+    uint8_t *p = stats_reply;
+    stats_histogram *l_histogram;
+    unsigned i;
+
+    if(uip_datalen() < 1)
+    {
+        return 0;
+    }
+    switch(l_request[0])
+    {
+    case 'c':
+        *p++ = 'c';
+        *p++ = stats_role;
+        p = put32(p, (uint32_t)clock_seconds());
+        for(i = 0; i < IBIHOP_STATS_COUNTERS; ++i)
+        {
+            p = put32(p, stats_counter[i]);
+        }
+        *p++ = stats_queue_depth;
+        *p++ = stats_queue_max;
+        break;
+    case 'h':
+        if(uip_datalen() < 2 || l_request[1] >= STATS_HISTOGRAMS)
+        {
+            return 0;
+        }
+        l_histogram = &stats_histogram_of[l_request[1]];
+        *p++ = 'h';
+        *p++ = l_request[1];
+        *p++ = IBIHOP_STATS_BUCKETS;
+        p = put32(p, l_histogram->sum_ms);
+        for(i = 0; i < IBIHOP_STATS_BUCKETS; ++i)
+        {
+            p = put16(p, l_histogram->count[i]);
+        }
+        break;
+    case 'r':
+        memset(stats_counter, 0, sizeof(stats_counter));
+        memset(stats_histogram_of, 0, sizeof(stats_histogram_of));
+        stats_queue_max = stats_queue_depth;
+        *p++ = 'r';
+        break;
+    default:
+        return 0;
+    }
+    return p - stats_reply;
+}
+
+PROCESS_THREAD(ibihop_stats_process, ev, data)
+{
+    unsigned l_len;
+
+    PROCESS_BEGIN();
+
+    /* Created here, so that the tcpip events of the port come to this process and not to the handshake. */
+    stats_conn = udp_new(NULL, 0, NULL);
+    if(stats_conn == NULL)
+    {
+        PROCESS_EXIT();
+    }
+    udp_bind(stats_conn, UIP_HTONS(IBIHOP_STATS_PORT));
+
+    while(1)
+    {
+        PROCESS_WAIT_EVENT_UNTIL(ev == tcpip_event);
+        if(uip_newdata() && (l_len = stats_answer()) > 0)
+        {
+            uip_udp_packet_sendto(stats_conn, stats_reply, l_len, &UIP_UDP_BUF->srcipaddr, UIP_UDP_BUF->srcport);
+        }
+    }
+
+    PROCESS_END();
+}
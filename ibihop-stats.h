@@ -0,0 +1,124 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Handshake counters and latency histograms (IBIHOP_STATS=1), read remotely over UDP. The reader and the tag
+count the handshakes they start, complete and give up on, and put the duration of every handshake and of
+every pass into a histogram of IBIHOP_STATS_BUCKETS power-of-two buckets. Recording is a few increments into
+static storage; the replies are built by a separate process that owns the UDP port, so the handshake path
+does no printf and no allocation. Disabled, the calls below compile to nothing.
+
+Requests are datagrams to IBIHOP_STATS_PORT, answered to the sender's address and port. Multi-byte values
+are little-endian.
+	'c'	- counters: 'c', role ('r' reader, 't' tag), seconds since boot (4), the IBIHOP_STATS_COUNTERS
+		  counters (4 each, in the order of the enum below), queue depth (1), highest queue depth (1).
+	'h' n	- histogram n, 0 for the handshake latency and 1 to 4 or IBIHOP_STATS_TAGVERF for a pass:
+		  'h', n, IBIHOP_STATS_BUCKETS, sum of the durations in ms (4), then the count of each bucket (2).
+		  Bucket b holds durations below IBIHOP_STATS_BUCKET0_MS << b ms, the last one everything above.
+	'r'	- clear everything and answer 'r'.
+tools/ibihop-stats.py sends the requests and prints the answers.
+*/
+#ifndef IBIHOP_STATS_H_
+#define IBIHOP_STATS_H_
+
+#include <stdint.h>
+#include "contiki.h"
+
+#ifndef IBIHOP_STATS
+#define IBIHOP_STATS 0
+#endif
+
+/* UDP port the stats process listens on. */
+#ifndef IBIHOP_STATS_PORT
+#define IBIHOP_STATS_PORT 5688
+#endif
+
+/* Histogram buckets, and the upper bound of the first one. 12 buckets of 16 ms reach 16 s, about the
+   longest pass on Tmote Sky (secp384r1). */
+#ifndef IBIHOP_STATS_BUCKETS
+#define IBIHOP_STATS_BUCKETS 12
+#endif
+#ifndef IBIHOP_STATS_BUCKET0_MS
+#define IBIHOP_STATS_BUCKET0_MS 16
+#endif
+
+/* Pass number of the reader's verification of the tag, as IBIHOP_TRACE_TAGVERF in ibihop-trace.h. */
+#define IBIHOP_STATS_TAGVERF 5
+
+#define IBIHOP_STATS_READER 'r'
+#define IBIHOP_STATS_TAG 't'
+
+enum
+{
+    IBIHOP_STATS_STARTED,          /* reader: hellos accepted; tag: hellos sent */
+    IBIHOP_STATS_COMPLETED,        /* reader: tags verified; tag: '5' received */
+    IBIHOP_STATS_FAILED,           /* handshakes that ended without authentication, rejections included */
+    IBIHOP_STATS_READER_REJECTED,  /* '8' messages: the tag found the reader invalid */
+    IBIHOP_STATS_DROPPED,          /* reader: hellos refused for lack of a session or of the curve */
+    IBIHOP_STATS_UNEXPECTED,       /* messages that do not fit the state of their handshake */
+    IBIHOP_STATS_COUNTERS
+};
+
+#if IBIHOP_STATS
+
+/*
+ibihop_stats_init:
+	Start the process that answers the requests. Call it once from the application process.
+Input:
+	p_role	- IBIHOP_STATS_READER or IBIHOP_STATS_TAG.
+*/
+void ibihop_stats_init(uint8_t p_role);
+
+/*
+ibihop_stats_count:
+	Add one to a counter.
+Input:
+	p_counter	- one of the IBIHOP_STATS_ counters.
+*/
+void ibihop_stats_count(uint8_t p_counter);
+
+/*
+ibihop_stats_handshake:
+	Count a finished handshake as completed or failed, and put the latency of a completed one into
+	histogram 0.
+Input:
+	p_started	- clock_time() when the handshake started.
+	p_ok	- nonzero if both sides were authenticated.
+*/
+void ibihop_stats_handshake(clock_time_t p_started, uint8_t p_ok);
+
+/*
+ibihop_stats_begin:
+	Take the start time of a pass. Passes do not nest.
+*/
+void ibihop_stats_begin(void);
+
+/*
+ibihop_stats_end:
+	Put the duration of the pass started by ibihop_stats_begin() into its histogram.
+Input:
+	p_pass	- pass number, 1 to 4 or IBIHOP_STATS_TAGVERF.
+*/
+void ibihop_stats_end(uint8_t p_pass);
+
+/*
+ibihop_stats_queue:
+	Set the number of handshakes waiting for the CPU, and the highest number seen.
+*/
+void ibihop_stats_queue(uint8_t p_depth);
+
+#else
+
+#define ibihop_stats_init(p_role) ((void)0)
+#define ibihop_stats_count(p_counter) ((void)0)
+#define ibihop_stats_handshake(p_started, p_ok) ((void)0)
+#define ibihop_stats_begin() ((void)0)
+#define ibihop_stats_end(p_pass) ((void)0)
+#define ibihop_stats_queue(p_depth) ((void)0)
+
+#endif /* IBIHOP_STATS */
+
+#endif /* IBIHOP_STATS_H_ */
@@ -0,0 +1,299 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+*/
+#include "ibihop-trace.h"
+#include "contiki.h"
+#include "nano-ecc.h"
+#if PASS_TIMING
+#include "sys/energest.h"
+#endif
+#if ECC_FIXED_TABLE
+#include "ecc-table.h"
+#endif
+#if STACK_WATERMARK
+#include "stack-watermark.h"
+#endif
+#include <stdio.h>
+
+static ibihop_trace_record trace_ring[IBIHOP_TRACE_RECORDS];
+static uint8_t trace_head;       /* next record to print */
+static uint8_t trace_count;
+static unsigned long trace_dropped;
+
+#if IBIHOP_TRACE >= IBIHOP_TRACE_LEVEL_INFO
+static clock_time_t pass_start_clock;
+#if PASS_TIMING
+static rtimer_clock_t pass_start_rtimer;
+static unsigned long pass_start_cpu, pass_start_lpm, pass_start_transmit, pass_start_listen;
+#endif
+#endif
+
+/* Fixed lines of the events without a value, as the printf calls gave them. */
+static const char * const trace_text[] = {
+    [IBIHOP_TRACE_HELLO] = "Sending hello",
+    [IBIHOP_TRACE_NO_SESSION] = "SERVER: no free session, dropping hello",
+    [IBIHOP_TRACE_READER_OK] = "Reader is authenticated!",
+    [IBIHOP_TRACE_READER_INVALID] = "Reader is invalid!",
+    [IBIHOP_TRACE_TAG_INVALID] = "Tag is invalid!",
+    [IBIHOP_TRACE_DONE] = "OK! Mutual authentication succeed!",
+};
+
+PROCESS(ibihop_trace_process, "IBIHOP trace");
+
+/* Names of the passes in the printed lines, by event. */
+static const char * const pass_name[] = {
+    [IBIHOP_TRACE_PASS1] = "P1",
+    [IBIHOP_TRACE_PASS2] = "P2",
+    [IBIHOP_TRACE_PASS3] = "P3",
+    [IBIHOP_TRACE_PASS4] = "P4",
+    [IBIHOP_TRACE_TAGVERF] = "TagVerf",
+};
+
+#if !PASS_TIMING
+static const char *curve_name(uint16_t p_curve)
+{
+    switch(p_curve)
+    {
+    case secp128r1:
+        return "secp128r1";
+    case secp160r1:
+        return "secp160r1";
+    case secp192r1:
+        return "secp192r1";
+    case secp256r1:
+        return "secp256r1";
+    case secp384r1:
+        return "secp384r1";
+    case curve25519:
+        return "curve25519";
+    case sect163k1:
+        return "sect163k1";
+    default:
+        return "?";
+    }
+}
+#endif
+
+/* Lines of a pass record: its duration, then what the options measured, each under the name of the pass. */
+static void print_pass(const ibihop_trace_record *p_record)
+{
+    const char *l_name = pass_name[p_record->event];
+
+#if PASS_TIMING
+    printf("%s: Pass time %lu / %lu (curve %u", l_name, (unsigned long)p_record->value, (unsigned long)RTIMER_SECOND,
+           p_record->curve);
+    if(p_record->arg)
+    {
+        printf(", %u tags", p_record->arg);
+    }
+    printf(") cpu %lu lpm %lu tx %lu rx %lu\n", (unsigned long)p_record->pass.cpu, (unsigned long)p_record->pass.lpm,
+           (unsigned long)p_record->pass.transmit, (unsigned long)p_record->pass.listen);
+#else
+    printf("%s: Completion time %lu / %lu", l_name, (unsigned long)p_record->value, (unsigned long)CLOCK_SECOND);
+    if(p_record->arg)
+    {
+        printf(" (%u tags, %s)", p_record->arg, curve_name(p_record->curve));
+    }
+    printf("\n");
+#endif
+#if ECC_FIXED_TABLE
+    if(p_record->pass.table_reads)
+    {
+        printf("%s: Table reads %lu (%lu bytes) in %lu / %lu\n", l_name, (unsigned long)p_record->pass.table_reads,
+               (unsigned long)p_record->pass.table_bytes, (unsigned long)p_record->pass.table_ticks,
+               (unsigned long)RTIMER_SECOND);
+    }
+#endif
+#if STACK_WATERMARK
+    printf("%s: Stack high-water %u bytes\n", l_name, p_record->pass.stack);
+#endif
+#if ECC_STATS
+    printf("%s: Ops M %lu S %lu I %lu Mn %lu In %lu dbl %lu add %lu mul %lu\n", l_name,
+           (unsigned long)p_record->pass.ops.modMult, (unsigned long)p_record->pass.ops.modSquare,
+           (unsigned long)p_record->pass.ops.modInv, (unsigned long)p_record->pass.ops.modNMult,
+           (unsigned long)p_record->pass.ops.modNInv, (unsigned long)p_record->pass.ops.pointDouble,
+           (unsigned long)p_record->pass.ops.pointAdd, (unsigned long)p_record->pass.ops.pointMult);
+#endif
+}
+
+static void print_record(const ibihop_trace_record *p_record)
+{
+    switch(p_record->event)
+    {
+    case IBIHOP_TRACE_PASS1:
+    case IBIHOP_TRACE_PASS2:
+    case IBIHOP_TRACE_PASS3:
+    case IBIHOP_TRACE_PASS4:
+    case IBIHOP_TRACE_TAGVERF:
+        print_pass(p_record);
+        break;
+    case IBIHOP_TRACE_RECEIVED:
+        printf("SERVER: DATA recv '%c' from %lu\n", p_record->arg, (unsigned long)p_record->value);
+        break;
+    case IBIHOP_TRACE_SENT:
+        printf("SERVER: DATA sending '%c'\n", p_record->arg);
+        break;
+    case IBIHOP_TRACE_NO_CURVE:
+        printf("SERVER: curve %u not supported, dropping hello\n", p_record->curve);
+        break;
+    case IBIHOP_TRACE_UNEXPECTED:
+        printf("Unexpected message '%c'\n", p_record->arg);
+        break;
+    default:
+        if(p_record->event < sizeof(trace_text) / sizeof(trace_text[0]) && trace_text[p_record->event])
+        {
+            printf("%s\n", trace_text[p_record->event]);
+        }
+        break;
+    }
+}
+
+void ibihop_trace_init(void)
+{
+    process_start(&ibihop_trace_process, NULL);
+}
+
+/* Takes the next record of the ring, overwriting the oldest one if it is full. */
+static ibihop_trace_record *trace_store(uint8_t p_event, uint8_t p_arg, uint16_t p_curve, uint32_t p_value)
+{
+    ibihop_trace_record *l_record;
+
+    if(trace_count == IBIHOP_TRACE_RECORDS)
+    {
+        trace_head = (trace_head + 1) % IBIHOP_TRACE_RECORDS;
+        --trace_count;
+        ++trace_dropped;
+    }
+    l_record = &trace_ring[(trace_head + trace_count) % IBIHOP_TRACE_RECORDS];
+    ++trace_count;
+
+    l_record->time = clock_time();
+    l_record->value = p_value;
+    l_record->curve = p_curve;
+    l_record->event = p_event;
+    l_record->arg = p_arg;
+    return l_record;
+}
+
+void ibihop_trace_event(uint8_t p_event, uint8_t p_arg, uint16_t p_curve, uint32_t p_value)
+{
+    trace_store(p_event, p_arg, p_curve, p_value);
+    process_poll(&ibihop_trace_process);
+}
+
+#if IBIHOP_TRACE >= IBIHOP_TRACE_LEVEL_INFO
+
+#if PASS_TIMING
+/* rtimer ticks since the start of the pass. rtimer_clock_t is 16 bits on MSP430 and wraps every 2 s at
+   32768 Hz, so the number of wraps is taken from clock_time(), which is coarse but does not wrap. */
+static uint32_t pass_elapsed_ticks(void)
+{
+    uint32_t l_fine = (rtimer_clock_t)(RTIMER_NOW() - pass_start_rtimer);
+    uint32_t l_coarse = (uint32_t)(clock_time() - pass_start_clock) * RTIMER_SECOND / CLOCK_SECOND;
+    uint32_t l_wrap;
+
+    if(sizeof(rtimer_clock_t) < sizeof(uint32_t) && l_coarse > l_fine)
+    {
+        l_wrap = (uint32_t)1 << (8 * sizeof(rtimer_clock_t));
+        l_fine += (l_coarse - l_fine + l_wrap / 2) / l_wrap * l_wrap;
+    }
+    return l_fine;
+}
+#endif
+
+void ibihop_pass_begin(void (*p_ops_reset)(void))
+{
+#if ECC_FIXED_TABLE
+    ecc_table_stats_reset();
+#endif
+#if ECC_STATS
+    p_ops_reset();
+#else
+    (void)p_ops_reset;
+#endif
+#if STACK_WATERMARK
+    stack_watermark_paint();
+#endif
+#if PASS_TIMING
+    energest_flush();
+    pass_start_cpu = energest_type_time(ENERGEST_TYPE_CPU);
+    pass_start_lpm = energest_type_time(ENERGEST_TYPE_LPM);
+    pass_start_transmit = energest_type_time(ENERGEST_TYPE_TRANSMIT);
+    pass_start_listen = energest_type_time(ENERGEST_TYPE_LISTEN);
+    pass_start_rtimer = RTIMER_NOW();
+#endif
+    pass_start_clock = clock_time();
+    ibihop_stats_begin();
+}
+
+void ibihop_pass_end(uint8_t p_event, uint8_t p_tags, uint16_t p_curve, void (*p_ops_get)(struct EccStats *p_stats))
+{
+    ibihop_trace_record *l_record;
+#if PASS_TIMING
+    uint32_t l_ticks = pass_elapsed_ticks();
+#else
+    uint32_t l_ticks = clock_time() - pass_start_clock;
+#endif
+
+    ibihop_stats_end(p_event);
+    l_record = trace_store(p_event, p_tags, p_curve, l_ticks);
+#if PASS_TIMING
+    energest_flush();
+    l_record->pass.cpu = energest_type_time(ENERGEST_TYPE_CPU) - pass_start_cpu;
+    l_record->pass.lpm = energest_type_time(ENERGEST_TYPE_LPM) - pass_start_lpm;
+    l_record->pass.transmit = energest_type_time(ENERGEST_TYPE_TRANSMIT) - pass_start_transmit;
+    l_record->pass.listen = energest_type_time(ENERGEST_TYPE_LISTEN) - pass_start_listen;
+#endif
+#if ECC_FIXED_TABLE
+    l_record->pass.table_reads = ecc_table_stats.reads;
+    l_record->pass.table_bytes = ecc_table_stats.bytes;
+    l_record->pass.table_ticks = ecc_table_stats.ticks;
+#endif
+#if STACK_WATERMARK
+    l_record->pass.stack = stack_watermark_used();
+#endif
+#if ECC_STATS
+    p_ops_get(&l_record->pass.ops);
+#else
+    (void)p_ops_get;
+#endif
+#if !IBIHOP_TRACE_PASS_EXTRA
+    (void)l_record;
+#endif
+    process_poll(&ibihop_trace_process);
+}
+
+#endif /* IBIHOP_TRACE >= IBIHOP_TRACE_LEVEL_INFO */
+
+void ibihop_trace_flush(void)
+{
+    while(trace_count)
+    {
+        print_record(&trace_ring[trace_head]);
+        trace_head = (trace_head + 1) % IBIHOP_TRACE_RECORDS;
+        --trace_count;
+    }
+    if(trace_dropped)
+    {
+        printf("Trace: %lu records dropped\n", trace_dropped);
+        trace_dropped = 0;
+    }
+}
+
+PROCESS_THREAD(ibihop_trace_process, ev, data)
+{
+    PROCESS_BEGIN();
+
+    while(1)
+    {
+        PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+        ibihop_trace_flush();
+    }
+
+    PROCESS_END();
+}
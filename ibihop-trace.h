@@ -0,0 +1,195 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Handshake events of the reader and the tag, kept as fixed-size binary records in a RAM ring instead of being
+printed where they happen. A printf on Tmote Sky spends milliseconds on the UART while the reply and the next
+packet wait; recording an event is a copy of 12 bytes. A low-priority process prints the records once the
+handler has returned (ibihop_trace_flush() prints them at once), with the same lines the printf calls gave.
+When the ring is full the oldest record is overwritten and counted as dropped. Records are written from
+process context only, not from interrupts.
+
+Every pass runs between ibihop_pass_begin() and ibihop_pass_end(), which take its measurements and store them
+in the record of the pass: the duration, and with PASS_TIMING, STACK_WATERMARK, ECC_FIXED_TABLE and ECC_STATS
+the energest times, the stack high-water mark, the table reads and the field operations. Those options make
+every record of the ring larger, so lower IBIHOP_TRACE_RECORDS with them on a mote short of RAM.
+
+IBIHOP_TRACE is the level kept at compile time; the calls above it compile to nothing, arguments included.
+	0	- nothing (production builds: no ring, no process)
+	1	- errors: invalid tag or reader, unexpected messages
+	2	- and the pass times and handshake results (the default, as the printf calls before)
+	3	- and every message received and sent, and the hellos the reader drops
+*/
+#ifndef IBIHOP_TRACE_H_
+#define IBIHOP_TRACE_H_
+
+#include <stdint.h>
+#include "nano-ecc.h"
+#include "ibihop-stats.h"
+
+#ifndef IBIHOP_TRACE
+#define IBIHOP_TRACE 2
+#endif
+
+#define IBIHOP_TRACE_LEVEL_ERROR 1
+#define IBIHOP_TRACE_LEVEL_INFO 2
+#define IBIHOP_TRACE_LEVEL_DEBUG 3
+
+#if (PASS_TIMING || STACK_WATERMARK || ECC_STATS) && IBIHOP_TRACE < IBIHOP_TRACE_LEVEL_INFO
+#error "PASS_TIMING, STACK_WATERMARK and ECC_STATS are printed with the pass records: build with IBIHOP_TRACE=2 or more"
+#endif
+
+/* Records held until printed. */
+#ifndef IBIHOP_TRACE_RECORDS
+#define IBIHOP_TRACE_RECORDS 16
+#endif
+
+/* Events. 1 to 5 are the passes, numbered as in ibihop-stats.h. */
+enum {
+    IBIHOP_TRACE_PASS1 = 1,          /* value: duration, arg: sessions in the batch (0 on the tag) */
+    IBIHOP_TRACE_PASS2,
+    IBIHOP_TRACE_PASS3,
+    IBIHOP_TRACE_PASS4,
+    IBIHOP_TRACE_TAGVERF,
+    IBIHOP_TRACE_HELLO,              /* tag sent hello */
+    IBIHOP_TRACE_RECEIVED,           /* arg: message flag, value: last byte of the sender's address */
+    IBIHOP_TRACE_SENT,               /* arg: message flag */
+    IBIHOP_TRACE_NO_CURVE,           /* reader dropped a hello for a curve it does not serve */
+    IBIHOP_TRACE_NO_SESSION,         /* reader dropped a hello for lack of a session */
+    IBIHOP_TRACE_UNEXPECTED,         /* arg: message flag */
+    IBIHOP_TRACE_READER_OK,          /* the tag accepted the reader */
+    IBIHOP_TRACE_READER_INVALID,     /* the tag rejected the reader */
+    IBIHOP_TRACE_TAG_INVALID,        /* the reader rejected the tag */
+    IBIHOP_TRACE_DONE                /* the reader confirmed the tag: mutual authentication */
+};
+
+#define IBIHOP_TRACE_PASS_EXTRA (PASS_TIMING || STACK_WATERMARK || ECC_FIXED_TABLE || ECC_STATS)
+
+#if IBIHOP_TRACE_PASS_EXTRA
+/* Measurements of a pass beyond its duration, by the options that are on. */
+typedef struct ibihop_trace_pass
+{
+#if PASS_TIMING
+    uint32_t cpu;        /* energest times during the pass, in rtimer ticks */
+    uint32_t lpm;
+    uint32_t transmit;
+    uint32_t listen;
+#endif
+#if ECC_FIXED_TABLE
+    uint32_t table_reads;
+    uint32_t table_bytes;
+    uint32_t table_ticks; /* rtimer ticks spent in the reads, inside the duration */
+#endif
+#if ECC_STATS
+    EccStats ops;
+#endif
+#if STACK_WATERMARK
+    uint16_t stack;      /* peak stack below ibihop_pass_begin(), in bytes */
+#endif
+} ibihop_trace_pass;
+#endif
+
+typedef struct ibihop_trace_record
+{
+    uint32_t time;       /* clock_time() when recorded */
+    uint32_t value;      /* of a pass: clock ticks, or rtimer ticks with PASS_TIMING */
+    uint16_t curve;      /* ECC_CURVE value, 0 if none */
+    uint8_t event;
+    uint8_t arg;
+#if IBIHOP_TRACE_PASS_EXTRA
+    ibihop_trace_pass pass; /* of the pass events only */
+#endif
+} ibihop_trace_record;
+
+/* Operation counters of the curve of a pass, for ibihop_pass_begin() and ibihop_pass_end(): ecc_stats_reset
+   and ecc_stats_get on the tag, StatsReset and StatsGet of its descriptor on a multi-curve reader. */
+#if ECC_STATS
+#define IBIHOP_PASS_OPS(p_function) (p_function)
+#else
+#define IBIHOP_PASS_OPS(p_function) NULL
+#endif
+
+struct EccStats;
+
+#if IBIHOP_TRACE
+
+/*
+ibihop_trace_init:
+	Start the process that prints the records. Call it once from the application process.
+*/
+void ibihop_trace_init(void);
+
+/*
+ibihop_trace_event:
+	Store a record and schedule its printing. Use the level macros below rather than calling it directly.
+Input:
+	p_event	- one of the events above.
+	p_arg	- its small argument.
+	p_curve	- ECC_CURVE value, 0 if none.
+	p_value	- its value.
+*/
+void ibihop_trace_event(uint8_t p_event, uint8_t p_arg, uint16_t p_curve, uint32_t p_value);
+
+/*
+ibihop_trace_flush:
+	Print and remove the stored records now, e.g. before a measurement ends.
+*/
+void ibihop_trace_flush(void);
+
+#else
+
+#define ibihop_trace_init() ((void)0)
+#define ibihop_trace_flush() ((void)0)
+
+#endif /* IBIHOP_TRACE */
+
+#if IBIHOP_TRACE >= IBIHOP_TRACE_LEVEL_INFO
+
+/*
+ibihop_pass_begin:
+	Start the measurements of a pass: clear the operation and table counters, paint the stack and take the
+	start time, energest values and the IBIHOP_STATS start. Passes do not nest.
+Input:
+	p_ops_reset	- IBIHOP_PASS_OPS() of the reset of the operation counters of the curve.
+*/
+void ibihop_pass_begin(void (*p_ops_reset)(void));
+
+/*
+ibihop_pass_end:
+	Store the record of the pass started by ibihop_pass_begin(), with its IBIHOP_STATS histogram, and schedule
+	its printing, which comes once the handler has returned.
+Input:
+	p_event	- IBIHOP_TRACE_PASS1 to IBIHOP_TRACE_PASS4 or IBIHOP_TRACE_TAGVERF.
+	p_tags	- sessions in the batch, 0 on the tag.
+	p_curve	- ECC_CURVE value of the pass.
+	p_ops_get	- IBIHOP_PASS_OPS() of the snapshot of the operation counters of the curve.
+*/
+void ibihop_pass_end(uint8_t p_event, uint8_t p_tags, uint16_t p_curve, void (*p_ops_get)(struct EccStats *p_stats));
+
+#else
+
+#define ibihop_pass_begin(p_ops_reset) ibihop_stats_begin()
+#define ibihop_pass_end(p_event, p_tags, p_curve, p_ops_get) ibihop_stats_end(p_event)
+
+#endif
+
+#if IBIHOP_TRACE >= IBIHOP_TRACE_LEVEL_ERROR
+#define IBIHOP_TRACE_ERROR(event, arg, curve, value) ibihop_trace_event(event, arg, curve, value)
+#else
+#define IBIHOP_TRACE_ERROR(event, arg, curve, value) ((void)0)
+#endif
+#if IBIHOP_TRACE >= IBIHOP_TRACE_LEVEL_INFO
+#define IBIHOP_TRACE_INFO(event, arg, curve, value) ibihop_trace_event(event, arg, curve, value)
+#else
+#define IBIHOP_TRACE_INFO(event, arg, curve, value) ((void)0)
+#endif
+#if IBIHOP_TRACE >= IBIHOP_TRACE_LEVEL_DEBUG
+#define IBIHOP_TRACE_DEBUG(event, arg, curve, value) ibihop_trace_event(event, arg, curve, value)
+#else
+#define IBIHOP_TRACE_DEBUG(event, arg, curve, value) ((void)0)
+#endif
+
+#endif /* IBIHOP_TRACE_H_ */
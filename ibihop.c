@@ -7,6 +7,7 @@ Created by
 
 */
 #include "ibihop.h"
+#include <string.h>
 
 /* Generate a public/private key pair. */
 void IBIHOP_KeyGen(EccPoint* pk, uint8_t* sk)
@@ -19,14 +20,30 @@ void IBIHOP_KeyGen(EccPoint* pk, uint8_t* sk)
 void IBIHOP_Pass1(EccPoint* E, uint8_t* e, uint8_t* e_inv)
 {  
     getRandomBytes(e, NUM_ECC_DIGITS * sizeof(uint8_t));
+    ModNReduce(e);
     ModNInv(e_inv, e);	/* e_inv*e = 1 mod n */
     EccPoint_mult(E, NULL, e_inv, NULL);	/* Use the gnerator to compute point E */
 }
 
+/* Compute E_i = e_i^-1P for p_count sessions at once */
+void IBIHOP_Pass1_batch(EccPoint* E, uint8_t (*e)[NUM_ECC_DIGITS], uint8_t (*e_inv)[NUM_ECC_DIGITS], unsigned p_count)
+{
+    unsigned i;
+
+    for(i = 0; i < p_count; ++i)
+    {
+        getRandomBytes(e[i], NUM_ECC_DIGITS * sizeof(uint8_t));
+        ModNReduce(e[i]);
+    }
+    ModNInv_batch(e_inv, e, p_count);	/* e_inv[i]*e[i] = 1 mod n */
+    EccPoint_mult_batch(E, NULL, e_inv, p_count);
+}
+
 /* Compute R = rP */
 void IBIHOP_Pass2(EccPoint* R, uint8_t* r)
 {
     getRandomBytes(r, NUM_ECC_DIGITS * sizeof(uint8_t));
+    ModNReduce(r);
     EccPoint_mult(R, NULL, r, NULL);
 }
 
@@ -35,9 +52,37 @@ void IBIHOP_Pass3(uint8_t* f, EccPoint* R, uint8_t* e, uint8_t* sk_r)
 {
     EccPoint tmp;
     EccPoint_mult(&tmp, R, sk_r, NULL);
+    ModNReduce(tmp.x);
     ModNAdd(f, tmp.x, e);	/* f = tmp.x + e mod n */
 }
 
+/* Compute f_i = x[yR_i] + e_i for p_count sessions at once */
+void IBIHOP_Pass3_batch(uint8_t (*f)[NUM_ECC_DIGITS], EccPoint* R, uint8_t (*e)[NUM_ECC_DIGITS], uint8_t* sk_r, unsigned p_count)
+{
+    EccPoint tmp[ECC_BATCH_MAX];
+    uint8_t y[ECC_BATCH_MAX][NUM_ECC_DIGITS];
+    unsigned l_done, l_lanes, i;
+
+    for(l_done = 0; l_done < p_count; l_done += l_lanes)
+    {
+        l_lanes = p_count - l_done;
+        if(l_lanes > ECC_BATCH_MAX)
+        {
+            l_lanes = ECC_BATCH_MAX;
+        }
+        for(i = 0; i < l_lanes; ++i)
+        {
+            memcpy(y[i], sk_r, NUM_ECC_DIGITS);
+        }
+        EccPoint_mult_batch(tmp, R + l_done, y, l_lanes);
+        for(i = 0; i < l_lanes; ++i)
+        {
+            ModNReduce(tmp[i].x);
+            ModNAdd(f[l_done + i], tmp[i].x, e[l_done + i]);	/* f = tmp.x + e mod n */
+        }
+    }
+}
+
 /*
 Check the validity of message 3. 
 If valid: Compute the message (s = ex + r) of Pass 4 of IBIHOP protocol. 
@@ -45,27 +90,38 @@ else	: return -1.
 */
 int IBIHOP_Pass4(uint8_t *s, EccPoint *pk_r, EccPoint *E, uint8_t *f, uint8_t *r, uint8_t *sk_t)
 {
-    uint8_t* e = (uint8_t *)malloc(NUM_ECC_DIGITS);
+    uint8_t e[NUM_ECC_DIGITS];
     EccPoint tmp;
     EccPoint_mult(&tmp, pk_r, r, NULL);	
+    ModNReduce(tmp.x);
     ModNSub(e, f, tmp.x);	/* e = f - tmp.x */
     EccPoint_mult(E, E, e, NULL);
 
     if (IsGenerator(E) != 0)
     {
-      free(e);
       return -1;		/* Reader authentication failed. */
     }
     ModNMult(s, e, sk_t);	/* s = e * sk_t mod n */
     ModNAdd(s, r, s);		/* s = s + r mod n */
-   
-    free(e);
+
     return 0;
 }
 
 /* Check the validity of message 4 by computing e^-1(sP - R). */
 int IBIHOP_TagVerf(EccPoint R, uint8_t* e_inv, uint8_t* s, EccPoint pk_t)
 {
+#if (ECC_CURVE == curve25519)
+    /* x-only: e^-1(sP - R) = pk_t holds iff se^-1P = pk_t + e^-1R, which is checked on the x-coordinates. */
+    EccPoint S;
+    ModNMult(s, e_inv, s);	/* s = se^-1 */
+    EccPoint_mult(&S, NULL, s, NULL);
+    EccPoint_mult(&R, &R, e_inv, NULL);
+
+    if (!EccPoint_isSum(S.x, pk_t.x, R.x))
+    {
+        return -1;
+    }
+#else
     uint8_t x[NUM_ECC_DIGITS];
     ModNMult(s, e_inv, s);	/* s = se^-1 */
     NegtiveNX(e_inv);		/* e^-1 = -e^-1 */
@@ -75,6 +131,7 @@ int IBIHOP_TagVerf(EccPoint R, uint8_t* e_inv, uint8_t* s, EccPoint pk_t)
     {
         return -1;
     }
+#endif
 
     return 0;
 }
@@ -37,6 +37,20 @@ Output:
 */
 void IBIHOP_Pass1(EccPoint* E, uint8_t* e, uint8_t* e_inv);
 
+/*
+IBIHOP_Pass1_batch:
+	Same as IBIHOP_Pass1(), for p_count sessions at once. The final inversions of the point
+	multiplications are shared across the batch (see EccPoint_mult_batch()).
+Input:
+	E	- array of p_count variables for taking the messages.
+	e	- array of p_count variables for taking the intermediate values.
+    e_inv	- array of p_count variables for taking the intermediate values.
+    p_count	- number of sessions.
+Output:
+	E	- messages 1 which will be sent from reader to the tags.
+*/
+void IBIHOP_Pass1_batch(EccPoint* E, uint8_t (*e)[NUM_ECC_DIGITS], uint8_t (*e_inv)[NUM_ECC_DIGITS], unsigned p_count);
+
 /*
 IBIHOP_Pass2:
 	Compute the message (R = rP) of Pass 2 of IBIHOP protocol.
@@ -61,6 +75,20 @@ Output:
 */
 void IBIHOP_Pass3(uint8_t* f, EccPoint* R, uint8_t* e, uint8_t* sk_r);
 
+/*
+IBIHOP_Pass3_batch:
+	Same as IBIHOP_Pass3(), for p_count sessions at once.
+Input:
+	f	- array of p_count variables for taking the messages.
+	R	- array of p_count received R from messages 2.
+	e	- array of p_count stored values e from IBIHOP_Pass1_batch().
+     sk_r	- reader's private key.
+    p_count	- number of sessions.
+Output:
+	f	- messages 3 which will be sent from reader to the tags.
+*/
+void IBIHOP_Pass3_batch(uint8_t (*f)[NUM_ECC_DIGITS], EccPoint* R, uint8_t (*e)[NUM_ECC_DIGITS], uint8_t* sk_r, unsigned p_count);
+
 /*
 IBIHOP_Pass4:
 	Check the validity of message 3. 
@@ -82,6 +110,7 @@ int IBIHOP_Pass4(uint8_t* s, EccPoint* pk_r, EccPoint* E, uint8_t* f, uint8_t* r
 /*
 IBIHOP_TagVerf:
 	Check the validity of message 4 by computing e^-1(sP - R).
+	With curve25519 only x-coordinates are known, so it checks se^-1P = pk_t +/- e^-1R with EccPoint_isSum().
 Input:
 	f	- variable for taking the message.
 	R	- received value R from message 2.
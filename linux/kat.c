@@ -0,0 +1,82 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Known answers of the curve of libibihop-<ECC_CURVE>.a (kat-<curve>), run by make check before the
+handshakes: the demo keys of ibihop-keys.h must be on the curve with pk = sk*G, for the tag and for the
+reader, and the group order must give n*G = O (all zero, as EccPoint_mult returns the point at infinity)
+and (n+1)*G = G. The second is there because the ladder of the prime curves also returns O for (n-1)*G,
+where its last step meets the point at infinity. A wrong curve constant or key shows here instead of as a
+failed handshake.
+
+usage: kat-<curve>
+The exit status is 1 if any answer differs.
+*/
+#include "ibihop.h"
+#include "ibihop-keys.h"
+#include <stdio.h>
+#include <string.h>
+
+static EccPoint pk_c = IBIHOP_KEY(PKC, ECC_CURVE);	/* Tag's public key. */
+static EccPoint pk_s = IBIHOP_KEY(PKS, ECC_CURVE);	/* Reader's public key. */
+static uint8_t sk_c[NUM_ECC_DIGITS] = IBIHOP_KEY(SKC, ECC_CURVE);	/* Tag's private key. */
+static uint8_t sk_s[NUM_ECC_DIGITS] = IBIHOP_KEY(SKS, ECC_CURVE);	/* Reader's private key. */
+
+static const EccPoint infinity;
+static int failed;
+
+static void
+check_key(const char *name, EccPoint *pk, uint8_t *sk)
+{
+  EccPoint result;
+
+  if(!ecc_valid_public_key(pk)) {
+    printf("%s public key is not on the curve\n", name);
+    failed = 1;
+  }
+  EccPoint_mult(&result, NULL, sk, NULL);
+  if(memcmp(&result, pk, sizeof(result)) != 0) {
+    printf("%s public key is not sk*G\n", name);
+    failed = 1;
+  }
+}
+
+int
+main(void)
+{
+  EccPoint G, result;
+  uint8_t n[NUM_ECC_DIGITS];
+  unsigned i;
+
+  GetG(&G);
+  GetN(n);
+  if(!ecc_valid_public_key(&G)) {
+    printf("G is not on the curve\n");
+    failed = 1;
+  }
+  EccPoint_mult(&result, &G, n, NULL);
+  if(memcmp(&result, &infinity, sizeof(result)) != 0) {
+    printf("n*G is not the point at infinity\n");
+    failed = 1;
+  }
+  for(i = 0; i < NUM_ECC_DIGITS && ++n[i] == 0; i++) {
+  }
+  EccPoint_mult(&result, &G, n, NULL);
+#if (ECC_CURVE == curve25519)
+  if(memcmp(result.x, G.x, sizeof(result.x)) != 0) {	/* x only */
+#else
+  if(memcmp(&result, &G, sizeof(result)) != 0) {
+#endif
+    printf("(n+1)*G is not G\n");
+    failed = 1;
+  }
+  check_key("tag", &pk_c, sk_c);
+  check_key("reader", &pk_s, sk_s);
+  if(!failed) {
+    printf("known answers OK: pk = sk*G for the tag and the reader, n*G = O, (n+1)*G = G\n");
+  }
+  return failed;
+}
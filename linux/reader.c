@@ -0,0 +1,542 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+The reader of server.c as a Linux program: the same messages over a UDP socket, the same session table
+and batched Pass1/Pass3, for every curve of libibihop-curves.a. Tags are told apart by address and port,
+so many of them can run on one host.
+
+usage: reader [-p port] [-n handshakes] [-S seed] [-w trace] [-q]
+       reader -R trace [-q]
+	-p	port to listen on (default 5678)
+	-n	exit after this many verified or failed tags, with status 1 if any failed
+	-S	draw the random bytes from this seed instead of the platform entropy
+	-w	record the handshakes to a trace (see trace.h), under the -S seed or a new one
+	-R	replay a trace instead of listening, and stop where the messages sent differ from it
+	-q	do not print the time of every pass
+On exit, or on SIGINT/SIGTERM, it prints the tags verified and failed, the hellos it dropped for lack
+of a session or of the curve, the sessions a hello took over from a tag that stopped answering, and the
+messages that did not fit the state of their handshake. A replay also prints the time spent in every
+pass, to compare builds on the same handshakes.
+*/
+#define _POSIX_C_SOURCE 200809L
+#include "udp.h"
+#include "trace.h"
+#include "ibihop-curve.h"
+#include "ibihop-keys.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef IBIHOP_MAX_SESSIONS
+#define IBIHOP_MAX_SESSIONS 64	/* Number of tags that can be in a handshake at the same time. */
+#endif
+#ifndef IBIHOP_SESSION_TIMEOUT_MSGS
+#define IBIHOP_SESSION_TIMEOUT_MSGS (4 * IBIHOP_MAX_SESSIONS)	/* A session silent for this many messages is reclaimed. */
+#endif
+
+#define MSG_LEN IBIHOP_MSG_LEN(IBIHOP_MAX_DIGITS)
+
+/* Per-tag handshake state, as in server.c. */
+enum {
+  SESSION_FREE,
+  SESSION_PASS1_PENDING,	/* "hello" received, challenge E not computed yet */
+  SESSION_WAIT_R,		/* E sent, waiting for message 2 */
+  SESSION_PASS3_PENDING,	/* R received, f not computed yet */
+  SESSION_WAIT_S		/* f sent, waiting for message 4 */
+};
+
+struct curve_keys {
+  uint16_t curve;
+  uint8_t *sk_s;
+  uint8_t *pk_c;
+};
+
+#define CURVE_KEYS(id, digits) \
+  static uint8_t sk_s_##id[digits] = SKS_##id; \
+  static uint8_t pk_c_##id[2][digits] = PKC_##id;
+#if IBIHOP_WITH_secp128r1
+CURVE_KEYS(16, 16)
+#endif
+#if IBIHOP_WITH_secp160r1
+CURVE_KEYS(20, 21)
+#endif
+#if IBIHOP_WITH_secp192r1
+CURVE_KEYS(24, 24)
+#endif
+#if IBIHOP_WITH_secp256r1
+CURVE_KEYS(32, 32)
+#endif
+#if IBIHOP_WITH_secp384r1
+CURVE_KEYS(48, 48)
+#endif
+#if IBIHOP_WITH_curve25519
+CURVE_KEYS(25519, 32)
+#endif
+#if IBIHOP_WITH_sect163k1
+CURVE_KEYS(163, 21)
+#endif
+
+static const struct curve_keys curve_keys[] = {
+#if IBIHOP_WITH_secp128r1
+  { 16, sk_s_16, pk_c_16[0] },
+#endif
+#if IBIHOP_WITH_secp160r1
+  { 20, sk_s_20, pk_c_20[0] },
+#endif
+#if IBIHOP_WITH_secp192r1
+  { 24, sk_s_24, pk_c_24[0] },
+#endif
+#if IBIHOP_WITH_secp256r1
+  { 32, sk_s_32, pk_c_32[0] },
+#endif
+#if IBIHOP_WITH_secp384r1
+  { 48, sk_s_48, pk_c_48[0] },
+#endif
+#if IBIHOP_WITH_curve25519
+  { 25519, sk_s_25519, pk_c_25519[0] },
+#endif
+#if IBIHOP_WITH_sect163k1
+  { 163, sk_s_163, pk_c_163[0] },
+#endif
+};
+
+struct session {
+  struct sockaddr_storage addr;
+  socklen_t addr_len;
+  uint8_t state;
+  const IBIHOP_Curve *curve;
+  const struct curve_keys *keys;
+  uint8_t R[2 * IBIHOP_MAX_DIGITS];
+  uint8_t e[IBIHOP_MAX_DIGITS], e_inv[IBIHOP_MAX_DIGITS];
+  unsigned long touched;	/* messages handled when the handshake last moved */
+};
+
+static struct session sessions[IBIHOP_MAX_SESSIONS];
+static int sock;
+static int quiet;
+static unsigned long verified, failed, dropped, unexpected, evicted;
+static unsigned long messages;	/* datagrams handled: the session clock, the same in a replay */
+static volatile sig_atomic_t stop;
+
+/* Replay (-R): the messages the reader sends are checked against the trace instead of sent. */
+static int replaying, diverged;
+static unsigned long replayed;
+
+enum { PASS_P1, PASS_P3, PASS_TAGVERF };
+
+static struct {
+  const char *name;
+  unsigned long runs, tags;
+  uint64_t us;
+} pass_times[] = { { "P1" }, { "P3" }, { "TagVerf" } };
+
+static void
+pass_done(int pass, uint64_t start, int tags)
+{
+  pass_times[pass].runs++;
+  pass_times[pass].tags += tags;
+  pass_times[pass].us += udp_now_us() - start;
+}
+
+static const struct curve_keys *
+keys_find(uint16_t curve)
+{
+  unsigned i;
+  for(i = 0; i < sizeof(curve_keys) / sizeof(curve_keys[0]); i++) {
+    if(curve_keys[i].curve == curve) {
+      return &curve_keys[i];
+    }
+  }
+  return NULL;
+}
+
+static struct session *
+session_find(const struct sockaddr_storage *addr, socklen_t len)
+{
+  int i;
+  for(i = 0; i < IBIHOP_MAX_SESSIONS; i++) {
+    if(sessions[i].state != SESSION_FREE && sessions[i].addr_len == len && memcmp(&sessions[i].addr, addr, len) == 0) {
+      return &sessions[i];
+    }
+  }
+  return NULL;
+}
+
+static struct session *
+session_new(const struct sockaddr_storage *addr, socklen_t len)
+{
+  int i;
+  unsigned long age, oldest;
+  struct session *session = session_find(addr, len);
+
+  if(session != NULL) {
+    return session;		/* The tag restarted its handshake. */
+  }
+  for(i = 0; i < IBIHOP_MAX_SESSIONS; i++) {
+    if(sessions[i].state == SESSION_FREE) {
+      session = &sessions[i];
+      break;
+    }
+  }
+  if(session == NULL) {
+    /* Table full: take over the session that has waited longest for its tag, once past the timeout, so that
+       tags which went away (or hellos never meant to be answered) cannot hold the table for good, and a
+       stream of hellos cannot push out handshakes in progress. As in server.c, but the age is counted in
+       messages, which keeps a replay on the same sessions. */
+    oldest = IBIHOP_SESSION_TIMEOUT_MSGS;
+    for(i = 0; i < IBIHOP_MAX_SESSIONS; i++) {
+      age = messages - sessions[i].touched;
+      if((sessions[i].state == SESSION_WAIT_R || sessions[i].state == SESSION_WAIT_S) && age >= oldest) {
+        session = &sessions[i];
+        oldest = age;
+      }
+    }
+    if(session == NULL) {
+      return NULL;
+    }
+    evicted++;
+  }
+  memcpy(&session->addr, addr, len);
+  session->addr_len = len;
+  return session;
+}
+
+/* The next record of a replayed trace must be the message the reader sends now. */
+static void
+replay_check(const struct session *session, const char *buf, unsigned len)
+{
+  struct trace_record rec;
+
+  if(diverged) {
+    return;
+  }
+  if(trace_next(&rec) != 1 || rec.type != TRACE_OUT || rec.addr_len != session->addr_len
+     || memcmp(rec.addr, &session->addr, rec.addr_len) != 0 || rec.len != len || memcmp(rec.msg, buf, len) != 0) {
+    printf("Replay: message '%c' differs from the trace after %lu records\n", buf[0], replayed);
+    diverged = 1;
+    return;
+  }
+  replayed++;
+}
+
+static void
+send_reply(struct session *session, char *buf)
+{
+  unsigned len = IBIHOP_MSG_LEN(session->curve->digits);
+
+  if(replaying) {
+    replay_check(session, buf, len);
+    return;
+  }
+  trace_record(TRACE_OUT, &session->addr, session->addr_len, buf, len);
+  sendto(sock, buf, len, 0, (struct sockaddr *)&session->addr, session->addr_len);
+}
+
+/* Collects up to ECC_BATCH_MAX sessions in the given state, all on the curve of the first one found. */
+static int
+pending_collect(uint8_t state, struct session **batch)
+{
+  int i, n = 0;
+  for(i = 0; i < IBIHOP_MAX_SESSIONS && n < ECC_BATCH_MAX; i++) {
+    if(sessions[i].state == state && (n == 0 || sessions[i].curve == batch[0]->curve)) {
+      batch[n++] = &sessions[i];
+    }
+  }
+  return n;
+}
+
+/* Runs the queued Pass1 and Pass3 computations in batches, once every datagram waiting has been read. */
+static void
+process_pending(void)
+{
+  struct session *batch[ECC_BATCH_MAX];
+  const IBIHOP_Curve *curve;
+  uint8_t points[ECC_BATCH_MAX * 2 * IBIHOP_MAX_DIGITS];
+  uint8_t e[ECC_BATCH_MAX * IBIHOP_MAX_DIGITS], e_inv[ECC_BATCH_MAX * IBIHOP_MAX_DIGITS];
+  uint8_t f[ECC_BATCH_MAX * IBIHOP_MAX_DIGITS];
+  char buf[MSG_LEN];
+  uint64_t start;
+  int i, n;
+  unsigned N;
+
+  while((n = pending_collect(SESSION_PASS1_PENDING, batch)) > 0) {
+    curve = batch[0]->curve;
+    N = curve->digits;
+    start = udp_now_us();
+    curve->Pass1_batch(points, e, e_inv, n);
+    pass_done(PASS_P1, start, n);
+    if(!quiet) {
+      printf("P1: Completion time %lu us (%d tags, %s)\n", (unsigned long)(udp_now_us() - start), n, curve->name);
+    }
+    for(i = 0; i < n; i++) {
+      memcpy(batch[i]->e, &e[i * N], N);
+      memcpy(batch[i]->e_inv, &e_inv[i * N], N);
+      batch[i]->state = SESSION_WAIT_R;
+      batch[i]->touched = messages;
+      memset(buf, 0, sizeof(buf));
+      buf[0] = '1';
+      memcpy(buf + 1, &points[i * 2 * N], 2 * N);
+      send_reply(batch[i], buf);
+    }
+  }
+
+  while((n = pending_collect(SESSION_PASS3_PENDING, batch)) > 0) {
+    curve = batch[0]->curve;
+    N = curve->digits;
+    for(i = 0; i < n; i++) {
+      memcpy(&points[i * 2 * N], batch[i]->R, 2 * N);
+      memcpy(&e[i * N], batch[i]->e, N);
+    }
+    start = udp_now_us();
+    curve->Pass3_batch(f, points, e, batch[0]->keys->sk_s, n);
+    pass_done(PASS_P3, start, n);
+    if(!quiet) {
+      printf("P3: Completion time %lu us (%d tags, %s)\n", (unsigned long)(udp_now_us() - start), n, curve->name);
+    }
+    for(i = 0; i < n; i++) {
+      batch[i]->state = SESSION_WAIT_S;
+      batch[i]->touched = messages;
+      memset(buf, 0, sizeof(buf));
+      buf[0] = '3';
+      memcpy(buf + 1, &f[i * N], N);
+      send_reply(batch[i], buf);
+    }
+  }
+}
+
+static void
+handle_message(const uint8_t *msg, size_t len, const struct sockaddr_storage *addr, socklen_t addr_len)
+{
+  char buf[MSG_LEN];
+  uint8_t s[IBIHOP_MAX_DIGITS];
+  struct session *session;
+  const IBIHOP_Curve *curve;
+  const struct curve_keys *keys;
+  uint16_t id;
+  uint64_t start;
+  unsigned N;
+  int result;
+
+  messages++;
+  if(len >= 5 && memcmp(msg, "hello", 5) == 0) {
+    id = ECC_CURVE;		/* A bare "hello" is for the default curve; "hello" + 2 bytes (LE) names one. */
+    if(len >= 7) {
+      id = msg[5] | ((uint16_t)msg[6] << 8);
+    }
+    curve = IBIHOP_FindCurve(id);
+    keys = keys_find(id);
+    if(curve == NULL || keys == NULL || (session = session_new(addr, addr_len)) == NULL) {
+      dropped++;
+      return;
+    }
+    session->curve = curve;
+    session->keys = keys;
+    session->state = SESSION_PASS1_PENDING;
+    session->touched = messages;
+  } else if(len >= 1 && msg[0] == '2') {
+    session = session_find(addr, addr_len);
+    if(session == NULL || session->state != SESSION_WAIT_R || len < 2u * session->curve->digits + 1) {
+      unexpected++;
+      return;
+    }
+    memcpy(session->R, msg + 1, 2 * session->curve->digits);
+    if(!session->curve->ValidPublicKey(session->R)) {	/* Off the curve or outside the subgroup: see server.c. */
+      unexpected++;
+      return;
+    }
+    session->state = SESSION_PASS3_PENDING;
+    session->touched = messages;
+  } else if(len >= 1 && msg[0] == '4') {
+    session = session_find(addr, addr_len);
+    if(session == NULL || session->state != SESSION_WAIT_S || len < session->curve->digits + 1u) {
+      unexpected++;
+      return;
+    }
+    N = session->curve->digits;
+    memcpy(s, msg + 1, N);
+    start = udp_now_us();
+    result = session->curve->TagVerf(session->R, session->e_inv, s, session->keys->pk_c);
+    pass_done(PASS_TAGVERF, start, 1);
+    if(result != 0) {
+      printf("Tag is invalid!\n");
+      failed++;
+    } else {
+      if(!quiet) {
+        printf("TagVerf: Completion time %lu us (%s)\n", (unsigned long)(udp_now_us() - start), session->curve->name);
+      }
+      memset(buf, 0, sizeof(buf));
+      buf[0] = '5';
+      send_reply(session, buf);
+      verified++;
+    }
+    session->state = SESSION_FREE;
+  } else if(len >= 1 && msg[0] == '8') {
+    session = session_find(addr, addr_len);
+    if(session != NULL) {
+      session->state = SESSION_FREE;
+      failed++;
+    } else {
+      unexpected++;
+    }
+  } else {
+    unexpected++;
+  }
+}
+
+/* Feeds the messages of a trace to the reader as if they came from the socket, with the batches run where
+   they were run when it was recorded. */
+static int
+replay(const char *path)
+{
+  struct trace_header header;
+  struct trace_record rec;
+  struct sockaddr_storage addr;
+  uint32_t span = 0;
+  int result, i;
+
+  if(trace_open(path, &header) != 0) {
+    return 2;
+  }
+  if(header.role != 'r') {
+    fprintf(stderr, "%s: not a trace of the reader\n", path);
+    trace_close();
+    return 2;
+  }
+  replaying = 1;
+  trace_seed(header.seed);
+  while(!diverged && (result = trace_next(&rec)) == 1) {
+    replayed++;
+    span = rec.time_us;
+    if(rec.type == TRACE_IN) {
+      memset(&addr, 0, sizeof(addr));
+      memcpy(&addr, rec.addr, rec.addr_len);
+      handle_message(rec.msg, rec.len, &addr, rec.addr_len);
+    } else if(rec.type == TRACE_RUN) {
+      process_pending();
+    } else {
+      printf("Replay: the trace has message '%c' that the reader did not send, after %lu records\n",
+             rec.len ? rec.msg[0] : '?', replayed - 1);
+      diverged = 1;
+    }
+  }
+  trace_close();
+  printf("%lu records replayed (%lu ms recorded), seed %llu\n", replayed, (unsigned long)(span / 1000),
+         (unsigned long long)header.seed);
+  for(i = 0; i < (int)(sizeof(pass_times) / sizeof(pass_times[0])); i++) {
+    printf("%s: %lu runs, %lu tags, %lu us\n", pass_times[i].name, pass_times[i].runs, pass_times[i].tags,
+           (unsigned long)pass_times[i].us);
+  }
+  printf("%lu tags verified, %lu failed, %lu hellos dropped, %lu sessions taken over, %lu unexpected messages\n",
+         verified, failed, dropped, evicted, unexpected);
+  return result < 0 || diverged;
+}
+
+static void
+on_signal(int sig)
+{
+  (void)sig;
+  stop = 1;
+}
+
+int
+main(int argc, char **argv)
+{
+  const char *port = IBIHOP_READER_PORT, *record = NULL, *play = NULL;
+  unsigned long handshakes = 0;
+  uint64_t seed = 0;
+  int seeded = 0;
+  uint8_t msg[MSG_LEN + 1];
+  struct sockaddr_storage addr;
+  socklen_t addr_len;
+  struct pollfd pfd;
+  struct sigaction sa;
+  ssize_t len;
+  int opt;
+
+  while((opt = getopt(argc, argv, "p:n:S:w:R:q")) != -1) {
+    switch(opt) {
+    case 'p':
+      port = optarg;
+      break;
+    case 'n':
+      handshakes = strtoul(optarg, NULL, 0);
+      break;
+    case 'S':
+      seed = strtoull(optarg, NULL, 0);
+      seeded = 1;
+      break;
+    case 'w':
+      record = optarg;
+      break;
+    case 'R':
+      play = optarg;
+      break;
+    case 'q':
+      quiet = 1;
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-p port] [-n handshakes] [-S seed] [-w trace] [-q]\n"
+              "       %s -R trace [-q]\n", argv[0], argv[0]);
+      return 2;
+    }
+  }
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  if(play != NULL) {
+    return replay(play);
+  }
+  if(record != NULL && !seeded) {
+    seed = trace_new_seed();
+    seeded = 1;
+  }
+  if(seeded) {
+    trace_seed(seed);
+  }
+  if(record != NULL && trace_create(record, 'r', 0, seed) != 0) {
+    return 2;
+  }
+
+  sock = udp_open(AF_INET6, port);
+  if(sock < 0) {
+    return 2;
+  }
+  pfd.fd = sock;
+  pfd.events = POLLIN;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = on_signal;
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  while(!stop && (handshakes == 0 || verified + failed < handshakes)) {
+    if(poll(&pfd, 1, -1) < 0) {
+      if(errno == EINTR) {
+        continue;
+      }
+      perror("poll");
+      return 2;
+    }
+    for(;;) {
+      addr_len = sizeof(addr);
+      len = recvfrom(sock, msg, sizeof(msg), MSG_DONTWAIT, (struct sockaddr *)&addr, &addr_len);
+      if(len < 0) {
+        break;
+      }
+      trace_record(TRACE_IN, &addr, addr_len, msg, (unsigned)len);
+      handle_message(msg, (size_t)len, &addr, addr_len);
+    }
+    trace_record(TRACE_RUN, NULL, 0, NULL, 0);
+    process_pending();
+  }
+  trace_close();
+  printf("%lu tags verified, %lu failed, %lu hellos dropped, %lu sessions taken over, %lu unexpected messages\n",
+         verified, failed, dropped, evicted, unexpected);
+  return failed != 0;
+}
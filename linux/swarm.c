@@ -0,0 +1,699 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Load generator: many tags of one curve (swarm-<curve>) against a reader, to find how many
+authentications per second the reader sustains and where it breaks. Every handshake is a tag of its
+own, on a fresh UDP socket, computing Pass2 and Pass4 with ibihop.c as tag.c does. Handshakes arrive as a
+Poisson process, or back to back with -a 0, up to -C at a time. The network is emulated at the tag
+side: messages are lost or held back (and so overtaken) at random, in both directions. Junk datagrams
+that fit no handshake come from separate sockets, or from a tag that answers E with a zero or off-curve
+R. Abandoned handshakes send a hello and nothing else, which holds a reader session until the reader
+takes it over for a new hello once the table is full.
+
+The reader tells tags apart by address and port, so this is for linux/reader (or a reader behind NAT
+rules); a mote reader keys its sessions by address and answers to port 8765 only.
+
+usage: swarm-<curve> [-c reader] [-p port] [-n handshakes] [-a rate/s] [-C concurrency] [-l loss]
+                     [-o reorder] [-d delay ms] [-j junk/s] [-A abandoned/s] [-t timeout ms] [-r retries]
+                     [-s seed] [-P processes] [-J]
+	-n	handshakes to offer (default 1000)
+	-a	arrival rate per second (default 0: start a handshake as soon as one ends)
+	-C	handshakes at the same time (default 64); an arrival beyond it is skipped
+	-l	probability that a message is lost, each way (default 0)
+	-o	probability that a message from a tag is held back, up to -d ms (default 0, 50 ms)
+	-j, -A	junk datagrams and abandoned hellos per second (default 0)
+	-t, -r	time to wait for the next message, and hellos before a handshake is given up (2000 ms, 3)
+	-P	processes, each with its share of -n, -a, -j and -A, for readers faster than one core of tags
+	-J	print one JSON object instead of the summary
+The unanswered hellos include those lost on purpose (-l); the reader prints its own count of drops.
+*/
+#define _POSIX_C_SOURCE 200809L
+#include "udp.h"
+#include "ibihop.h"
+#include "ibihop-keys.h"
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define MSG_LEN IBIHOP_MSG_LEN(NUM_ECC_DIGITS)
+#define JUNK_SOCKETS 8
+#define EVENTS 64
+
+enum {
+  TAG_FREE,
+  TAG_WAIT_E,		/* hello sent, waiting for message 1 */
+  TAG_WAIT_F,		/* R sent, waiting for message 3 */
+  TAG_WAIT_OK		/* s sent, waiting for message 5 */
+};
+
+struct tag {
+  int fd;
+  uint8_t state;
+  uint8_t hellos;
+  uint8_t junk;		/* answers message 1 with a malformed R and leaves */
+  uint64_t start, deadline;
+  EccPoint E, R;
+  uint8_t r[NUM_ECC_DIGITS], f[NUM_ECC_DIGITS], s[NUM_ECC_DIGITS];
+};
+
+/* A message held back for reordering. */
+struct delayed {
+  uint64_t due;
+  int fd;
+  uint16_t len;
+  uint8_t buf[MSG_LEN];
+};
+
+/* Counters of one process; the parent adds up those of its children. */
+struct results {
+  unsigned long offered, skipped, completed, failed, timeout_hello, timeout_mid;
+  unsigned long hellos, answered, junk, abandoned, lost_out, lost_in, reordered, unexpected;
+  uint64_t elapsed_us;
+  unsigned long latencies;	/* latency values (us, uint32_t) that follow on the pipe */
+};
+
+static EccPoint pk_s = IBIHOP_KEY(PKS, ECC_CURVE);	/* Reader's public key. */
+static uint8_t sk_c[NUM_ECC_DIGITS] = IBIHOP_KEY(SKC, ECC_CURVE);	/* Tag's private key. */
+
+static struct sockaddr_storage reader;
+static socklen_t reader_len;
+static unsigned long handshakes = 1000;
+static double rate, loss, reorder, junk_rate, abandon_rate;
+static unsigned concurrency = 64, reorder_ms = 50, timeout_ms = 2000, retries = 3;
+
+static struct tag *tags;
+static unsigned *free_tags, nfree;
+static struct delayed *delayed;
+static unsigned ndelayed;
+static int junk_fd[JUNK_SOCKETS];
+static uint32_t *latency;
+static struct results res;
+static int epfd;
+static uint64_t rng_state;
+
+/* xorshift64*, apart from the rand() that nano-ecc may use. */
+static uint64_t
+rng(void)
+{
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+static double
+uniform(void)
+{
+  return ((rng() >> 11) + 0.5) / 9007199254740992.0;
+}
+
+/* Time to the next event of a Poisson process, in us. */
+static uint64_t
+exponential_us(double per_second)
+{
+  return (uint64_t)(-log(uniform()) / per_second * 1e6);
+}
+
+static int
+open_socket(uint32_t p_id)
+{
+  struct epoll_event ev;
+  int fd = socket(reader.ss_family, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+
+  if(fd < 0) {
+    return -1;
+  }
+  if(connect(fd, (struct sockaddr *)&reader, reader_len) != 0) {
+    close(fd);
+    return -1;
+  }
+  ev.events = EPOLLIN;
+  ev.data.u32 = p_id;
+  epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+  return fd;
+}
+
+/* Sends through the emulated network: lost, held back or sent now. */
+static void
+send_msg(int fd, const void *buf, size_t len)
+{
+  struct delayed *d;
+
+  if(uniform() < loss) {
+    res.lost_out++;
+    return;
+  }
+  if(uniform() < reorder && ndelayed < concurrency * 4) {
+    d = &delayed[ndelayed++];
+    d->due = udp_now_us() + (uint64_t)(uniform() * reorder_ms * 1000);
+    d->fd = fd;
+    d->len = (uint16_t)len;
+    memcpy(d->buf, buf, len);
+    res.reordered++;
+    return;
+  }
+  send(fd, buf, len, 0);
+}
+
+static void
+send_hello(struct tag *t)
+{
+  char buf[] = {'h', 'e', 'l', 'l', 'o', ECC_CURVE & 0xFF, ECC_CURVE >> 8};
+
+  t->hellos++;
+  res.hellos++;
+  t->deadline = udp_now_us() + timeout_ms * 1000ULL;
+  send_msg(t->fd, buf, sizeof(buf));
+}
+
+/* Starts a tag in a free slot; returns NULL if there is none. */
+static struct tag *
+tag_open(uint8_t p_junk)
+{
+  struct tag *t;
+  unsigned i;
+
+  if(nfree == 0) {
+    return NULL;
+  }
+  i = free_tags[--nfree];
+  t = &tags[i];
+  t->fd = open_socket(i);
+  if(t->fd < 0) {
+    free_tags[nfree++] = i;
+    return NULL;
+  }
+  t->state = TAG_WAIT_E;
+  t->hellos = 0;
+  t->junk = p_junk;
+  t->start = udp_now_us();
+  send_hello(t);
+  return t;
+}
+
+static void
+tag_start(void)
+{
+  res.offered++;
+  if(tag_open(0) == NULL) {
+    res.skipped++;
+  }
+}
+
+static void
+tag_end(struct tag *t)
+{
+  unsigned i;
+
+  /* Messages of this tag still held back go nowhere once the socket is closed. */
+  for(i = 0; i < ndelayed; ) {
+    if(delayed[i].fd == t->fd) {
+      delayed[i] = delayed[--ndelayed];
+    } else {
+      i++;
+    }
+  }
+  close(t->fd);
+  t->state = TAG_FREE;
+  free_tags[nfree++] = (unsigned)(t - tags);
+}
+
+static void
+tag_message(struct tag *t, const uint8_t *msg, size_t len)
+{
+  uint8_t buf[MSG_LEN];
+  unsigned i;
+
+  if(uniform() < loss) {
+    res.lost_in++;
+    return;
+  }
+  memset(buf, 0, sizeof(buf));
+  if(t->state == TAG_WAIT_E && msg[0] == '1' && len >= 2 * NUM_ECC_DIGITS + 1) {
+    res.answered++;
+    if(t->junk) {
+      /* R at infinity (all zero) or a point off the curve: the reader has to drop it, not compute with it. */
+      buf[0] = '2';
+      if(rng() & 1) {
+        for(i = 1; i < sizeof(buf); i++) {
+          buf[i] = (uint8_t)rng();
+        }
+      }
+      send(t->fd, buf, sizeof(buf), 0);	/* not held back: tag_end() would drop it */
+      tag_end(t);
+      return;
+    }
+    memcpy(t->E.x, msg + 1, NUM_ECC_DIGITS);
+    memcpy(t->E.y, msg + 1 + NUM_ECC_DIGITS, NUM_ECC_DIGITS);
+    IBIHOP_Pass2(&t->R, t->r);
+    buf[0] = '2';
+    memcpy(buf + 1, t->R.x, NUM_ECC_DIGITS);
+    memcpy(buf + 1 + NUM_ECC_DIGITS, t->R.y, NUM_ECC_DIGITS);
+    t->state = TAG_WAIT_F;
+  } else if(t->state == TAG_WAIT_F && msg[0] == '3' && len >= NUM_ECC_DIGITS + 1) {
+    memcpy(t->f, msg + 1, NUM_ECC_DIGITS);
+    if(IBIHOP_Pass4(t->s, &pk_s, &t->E, t->f, t->r, sk_c) != 0) {
+      buf[0] = '8';
+      send_msg(t->fd, buf, sizeof(buf));
+      res.failed++;
+      tag_end(t);
+      return;
+    }
+    buf[0] = '4';
+    memcpy(buf + 1, t->s, NUM_ECC_DIGITS);
+    t->state = TAG_WAIT_OK;
+  } else if(t->state == TAG_WAIT_OK && msg[0] == '5') {
+    latency[res.completed++] = (uint32_t)(udp_now_us() - t->start);
+    tag_end(t);
+    return;
+  } else {
+    res.unexpected++;
+    return;
+  }
+  t->deadline = udp_now_us() + timeout_ms * 1000ULL;
+  send_msg(t->fd, buf, sizeof(buf));
+}
+
+static void
+tag_timeout(struct tag *t)
+{
+  if(t->state == TAG_WAIT_E && t->hellos < retries) {
+    send_hello(t);
+    return;
+  }
+  if(t->junk) {
+    /* Not a handshake: its time-outs count for nothing. */
+  } else if(t->state == TAG_WAIT_E) {
+    res.timeout_hello++;
+  } else {
+    res.timeout_mid++;
+  }
+  tag_end(t);
+}
+
+/* A datagram that fits no handshake: random bytes, messages 2 and 4 from an address without a session,
+   a hello for a curve nobody serves, or a hello whose session then gets a zero or off-curve R. The last
+   needs a free tag slot and falls back to random bytes without one. */
+static void
+send_junk(void)
+{
+  uint8_t buf[MSG_LEN];
+  unsigned i, len = MSG_LEN;
+  uint16_t id;
+
+  for(i = 0; i < sizeof(buf); i++) {
+    buf[i] = (uint8_t)rng();
+  }
+  switch(rng() % 5) {
+  case 4:
+    if(tag_open(1) != NULL) {
+      res.junk++;
+      return;
+    }
+    /* fall through */
+  case 0:
+    len = 1 + (unsigned)(rng() % MSG_LEN);
+    break;
+  case 1:
+    buf[0] = '2';
+    break;
+  case 2:
+    buf[0] = '4';
+    break;
+  default:
+    id = 0xFF00 | (uint16_t)(rng() & 0xFF);
+    memcpy(buf, "hello", 5);
+    buf[5] = id & 0xFF;
+    buf[6] = id >> 8;
+    len = 7;
+    break;
+  }
+  res.junk++;
+  send(junk_fd[rng() % JUNK_SOCKETS], buf, len, 0);
+}
+
+static void
+send_abandoned(void)
+{
+  char buf[] = {'h', 'e', 'l', 'l', 'o', ECC_CURVE & 0xFF, ECC_CURVE >> 8};
+  int fd = socket(reader.ss_family, SOCK_DGRAM, 0);
+
+  if(fd >= 0) {
+    sendto(fd, buf, sizeof(buf), 0, (struct sockaddr *)&reader, reader_len);
+    close(fd);
+    res.abandoned++;
+  }
+}
+
+static void
+run(void)
+{
+  struct epoll_event events[EVENTS];
+  uint8_t msg[MSG_LEN + 1];
+  uint64_t now, start, next, next_arrival, next_junk, next_abandon;
+  unsigned i;
+  ssize_t len;
+  int n, k, wait_ms;
+
+  tags = calloc(concurrency, sizeof(*tags));
+  free_tags = malloc(concurrency * sizeof(*free_tags));
+  delayed = malloc(concurrency * 4 * sizeof(*delayed));
+  latency = malloc((handshakes + 1) * sizeof(*latency));
+  epfd = epoll_create1(0);
+  if(tags == NULL || free_tags == NULL || delayed == NULL || latency == NULL || epfd < 0) {
+    perror("swarm");
+    exit(2);
+  }
+  for(i = 0; i < concurrency; i++) {
+    free_tags[nfree++] = concurrency - 1 - i;
+  }
+  for(i = 0; i < JUNK_SOCKETS; i++) {
+    junk_fd[i] = open_socket(concurrency + i);
+  }
+
+  start = now = udp_now_us();
+  next_arrival = now;
+  next_junk = junk_rate > 0 ? now + exponential_us(junk_rate) : UINT64_MAX;
+  next_abandon = abandon_rate > 0 ? now + exponential_us(abandon_rate) : UINT64_MAX;
+
+  while(res.offered < handshakes || nfree < concurrency) {
+    now = udp_now_us();
+    if(rate > 0) {
+      while(res.offered < handshakes && now >= next_arrival) {
+        tag_start();
+        next_arrival += exponential_us(rate);
+      }
+    } else {
+      while(res.offered < handshakes && nfree > 0) {
+        tag_start();
+      }
+    }
+    if(res.offered >= handshakes) {
+      next_arrival = next_junk = next_abandon = UINT64_MAX;
+    }
+    while(now >= next_junk) {
+      send_junk();
+      next_junk += exponential_us(junk_rate);
+    }
+    while(now >= next_abandon) {
+      send_abandoned();
+      next_abandon += exponential_us(abandon_rate);
+    }
+    for(i = 0; i < ndelayed; ) {
+      if(now >= delayed[i].due) {
+        send(delayed[i].fd, delayed[i].buf, delayed[i].len, 0);
+        delayed[i] = delayed[--ndelayed];
+      } else {
+        i++;
+      }
+    }
+    for(i = 0; i < concurrency; i++) {
+      if(tags[i].state != TAG_FREE && now >= tags[i].deadline) {
+        tag_timeout(&tags[i]);
+      }
+    }
+
+    next = rate > 0 ? next_arrival : UINT64_MAX;
+    next = next_junk < next ? next_junk : next;
+    next = next_abandon < next ? next_abandon : next;
+    for(i = 0; i < ndelayed; i++) {
+      next = delayed[i].due < next ? delayed[i].due : next;
+    }
+    for(i = 0; i < concurrency; i++) {
+      if(tags[i].state != TAG_FREE && tags[i].deadline < next) {
+        next = tags[i].deadline;
+      }
+    }
+    now = udp_now_us();
+    wait_ms = next == UINT64_MAX ? 1000 : next <= now ? 0 : (int)((next - now + 999) / 1000);
+
+    n = epoll_wait(epfd, events, EVENTS, wait_ms);
+    for(k = 0; k < n; k++) {
+      i = events[k].data.u32;
+      if(i >= concurrency) {
+        while(recv(junk_fd[i - concurrency], msg, sizeof(msg), 0) > 0) {
+        }
+        continue;
+      }
+      while(tags[i].state != TAG_FREE && (len = recv(tags[i].fd, msg, sizeof(msg), 0)) > 0) {
+        tag_message(&tags[i], msg, (size_t)len);
+      }
+    }
+  }
+  res.elapsed_us = udp_now_us() - start;
+  res.latencies = res.completed;
+}
+
+static int
+compare_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+static double
+percentile_ms(double p)
+{
+  if(res.latencies == 0) {
+    return 0;
+  }
+  return latency[(unsigned long)(p * (res.latencies - 1) + 0.5)] / 1000.0;
+}
+
+static void
+report(int json)
+{
+  double secs = res.elapsed_us / 1e6;
+
+  qsort(latency, res.latencies, sizeof(*latency), compare_u32);
+  if(json) {
+    printf("{\"curve\":%u,\"offered\":%lu,\"skipped\":%lu,\"completed\":%lu,\"failed\":%lu,"
+           "\"timeout_hello\":%lu,\"timeout_mid\":%lu,\"completion_rate\":%.4f,\"auth_per_s\":%.2f,"
+           "\"elapsed_s\":%.3f,\"p50_ms\":%.3f,\"p90_ms\":%.3f,\"p99_ms\":%.3f,\"max_ms\":%.3f,"
+           "\"hellos\":%lu,\"unanswered_hellos\":%lu,\"junk\":%lu,\"abandoned\":%lu,\"lost_out\":%lu,"
+           "\"lost_in\":%lu,\"reordered\":%lu,\"unexpected\":%lu}\n",
+           (unsigned)ECC_CURVE, res.offered, res.skipped, res.completed, res.failed, res.timeout_hello,
+           res.timeout_mid, res.offered ? (double)res.completed / res.offered : 0, res.completed / secs, secs,
+           percentile_ms(0.5), percentile_ms(0.9), percentile_ms(0.99), percentile_ms(1), res.hellos,
+           res.hellos - res.answered, res.junk, res.abandoned, res.lost_out, res.lost_in, res.reordered,
+           res.unexpected);
+    return;
+  }
+  printf("%lu handshakes offered (%lu skipped), %lu completed, %lu failed, %lu timed out (%lu before E)\n",
+         res.offered, res.skipped, res.completed, res.failed, res.timeout_hello + res.timeout_mid, res.timeout_hello);
+  printf("completion %.1f%%, %.1f auth/s over %.2f s\n",
+         res.offered ? 100.0 * res.completed / res.offered : 0, res.completed / secs, secs);
+  printf("latency ms: p50 %.2f p90 %.2f p99 %.2f max %.2f\n",
+         percentile_ms(0.5), percentile_ms(0.9), percentile_ms(0.99), percentile_ms(1));
+  printf("hellos %lu (%lu unanswered), lost %lu out %lu in, %lu reordered, %lu junk, %lu abandoned, "
+         "%lu unexpected\n", res.hellos, res.hellos - res.answered, res.lost_out, res.lost_in, res.reordered,
+         res.junk, res.abandoned, res.unexpected);
+}
+
+static int
+write_all(int fd, const void *buf, size_t len)
+{
+  const char *p = buf;
+  ssize_t n;
+
+  while(len > 0) {
+    n = write(fd, p, len);
+    if(n <= 0) {
+      return -1;
+    }
+    p += n;
+    len -= (size_t)n;
+  }
+  return 0;
+}
+
+static int
+read_all(int fd, void *buf, size_t len)
+{
+  char *p = buf;
+  ssize_t n;
+
+  while(len > 0) {
+    n = read(fd, p, len);
+    if(n <= 0) {
+      return -1;
+    }
+    p += n;
+    len -= (size_t)n;
+  }
+  return 0;
+}
+
+static void
+add_results(const struct results *part)
+{
+  res.offered += part->offered;
+  res.skipped += part->skipped;
+  res.completed += part->completed;
+  res.failed += part->failed;
+  res.timeout_hello += part->timeout_hello;
+  res.timeout_mid += part->timeout_mid;
+  res.hellos += part->hellos;
+  res.answered += part->answered;
+  res.junk += part->junk;
+  res.abandoned += part->abandoned;
+  res.lost_out += part->lost_out;
+  res.lost_in += part->lost_in;
+  res.reordered += part->reordered;
+  res.unexpected += part->unexpected;
+  res.latencies += part->latencies;
+  if(part->elapsed_us > res.elapsed_us) {
+    res.elapsed_us = part->elapsed_us;
+  }
+}
+
+/* Forks the processes, each with its share of the load, and adds up their results; or runs the load
+   here for a single process. */
+static int
+run_processes(unsigned procs, uint64_t seed)
+{
+  unsigned long total = handshakes;
+  struct results part;
+  uint32_t *all;
+  int fds[2], pipes[64];
+  unsigned p;
+  int status, failed = 0;
+
+  if(procs == 1) {
+    rng_state = seed | 1;
+    run();
+    return 0;
+  }
+  rate /= procs;
+  junk_rate /= procs;
+  abandon_rate /= procs;
+  for(p = 0; p < procs; p++) {
+    if(pipe(fds) != 0) {
+      perror("pipe");
+      return 2;
+    }
+    switch(fork()) {
+    case -1:
+      perror("fork");
+      return 2;
+    case 0:
+      close(fds[0]);
+      handshakes = total / procs + (p < total % procs);
+      rng_state = (seed + p * 0x9E3779B97F4A7C15ULL) | 1;
+      run();
+      if(write_all(fds[1], &res, sizeof(res)) != 0 ||
+         write_all(fds[1], latency, res.latencies * sizeof(*latency)) != 0) {
+        _exit(2);
+      }
+      _exit(0);
+    default:
+      close(fds[1]);
+      pipes[p] = fds[0];
+    }
+  }
+
+  all = malloc((total + 1) * sizeof(*all));
+  if(all == NULL) {
+    perror("swarm");
+    return 2;
+  }
+  memset(&res, 0, sizeof(res));
+  for(p = 0; p < procs; p++) {
+    if(read_all(pipes[p], &part, sizeof(part)) != 0 ||
+       read_all(pipes[p], all + res.latencies, part.latencies * sizeof(*all)) != 0) {
+      failed = 1;
+    } else {
+      add_results(&part);
+    }
+    close(pipes[p]);
+  }
+  for(p = 0; p < procs; p++) {
+    if(wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      failed = 1;
+    }
+  }
+  latency = all;
+  return failed ? 2 : 0;
+}
+
+int
+main(int argc, char **argv)
+{
+  const char *host = "::1", *port = IBIHOP_READER_PORT;
+  uint64_t seed = 1;
+  unsigned procs = 1;
+  int opt, json = 0;
+
+  while((opt = getopt(argc, argv, "c:p:n:a:C:l:o:d:j:A:t:r:s:P:J")) != -1) {
+    switch(opt) {
+    case 'c':
+      host = optarg;
+      break;
+    case 'p':
+      port = optarg;
+      break;
+    case 'n':
+      handshakes = strtoul(optarg, NULL, 0);
+      break;
+    case 'a':
+      rate = atof(optarg);
+      break;
+    case 'C':
+      concurrency = (unsigned)strtoul(optarg, NULL, 0);
+      break;
+    case 'l':
+      loss = atof(optarg);
+      break;
+    case 'o':
+      reorder = atof(optarg);
+      break;
+    case 'd':
+      reorder_ms = (unsigned)strtoul(optarg, NULL, 0);
+      break;
+    case 'j':
+      junk_rate = atof(optarg);
+      break;
+    case 'A':
+      abandon_rate = atof(optarg);
+      break;
+    case 't':
+      timeout_ms = (unsigned)strtoul(optarg, NULL, 0);
+      break;
+    case 'r':
+      retries = (unsigned)strtoul(optarg, NULL, 0);
+      break;
+    case 's':
+      seed = strtoull(optarg, NULL, 0);
+      break;
+    case 'P':
+      procs = (unsigned)strtoul(optarg, NULL, 0);
+      break;
+    case 'J':
+      json = 1;
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-c reader] [-p port] [-n handshakes] [-a rate/s] [-C concurrency] [-l loss] "
+              "[-o reorder] [-d delay ms] [-j junk/s] [-A abandoned/s] [-t timeout ms] [-r retries] [-s seed] "
+              "[-P processes] [-J]\n", argv[0]);
+      return 2;
+    }
+  }
+  if(concurrency == 0 || procs == 0 || procs > 64 || udp_resolve(host, port, &reader, &reader_len) != 0) {
+    return 2;
+  }
+  setvbuf(stdout, NULL, _IOLBF, 0);
+  if(run_processes(procs, seed) != 0) {
+    return 2;
+  }
+  report(json);
+  return 0;
+}
@@ -0,0 +1,297 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+The tag of client.c as a Linux program, for the curve of libibihop-<ECC_CURVE>.a: it sends "hello"
+with its curve, answers message 1 with Pass2 and message 3 with Pass4, and counts a handshake as done
+when the reader sends '5'. Handshakes run one after the other.
+
+usage: tag-<curve> [-c reader] [-p port] [-l local port] [-n handshakes] [-t timeout ms] [-r retries]
+                  [-S seed] [-w trace] [-q]
+       tag-<curve> -R trace [-q]
+	-c	reader address (default ::1)
+	-p	reader port (default 5678)
+	-l	local port (default 8765, which the mote reader answers to; 0 for any)
+	-n	handshakes to run (default 1)
+	-t	time to wait for the next message before sending hello again (default 2000 ms)
+	-r	hellos to send before a handshake counts as failed (default 5)
+	-S	draw the random bytes from this seed instead of the platform entropy
+	-w	record the handshakes to a trace (see trace.h), under the -S seed or a new one
+	-R	replay a trace instead of talking to a reader, and stop where the messages sent differ from it
+	-q	do not print the time of every pass
+The exit status is 1 if any handshake failed, or if a replay differs from its trace.
+*/
+#define _POSIX_C_SOURCE 200809L
+#include "udp.h"
+#include "trace.h"
+#include "ibihop.h"
+#include "ibihop-keys.h"
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MSG_LEN IBIHOP_MSG_LEN(NUM_ECC_DIGITS)
+
+static EccPoint E;
+static EccPoint R;
+static EccPoint pk_s = IBIHOP_KEY(PKS, ECC_CURVE);	/* Reader's public key. */
+
+static uint8_t r[NUM_ECC_DIGITS];
+static uint8_t f[NUM_ECC_DIGITS];
+static uint8_t s[NUM_ECC_DIGITS];
+static uint8_t sk_c[NUM_ECC_DIGITS] = IBIHOP_KEY(SKC, ECC_CURVE);	/* Tag's private key. */
+
+static int sock;
+static struct sockaddr_storage reader;
+static socklen_t reader_len;
+static int quiet;
+
+/* Replay (-R): the messages the tag sends are checked against the trace instead of sent. */
+static int replaying, diverged;
+static unsigned long replayed;
+static unsigned long p2_runs, p4_runs;
+static uint64_t p2_us, p4_us;
+
+/* The next record of a replayed trace must be the message the tag sends now. */
+static void
+replay_check(const char *buf, unsigned len)
+{
+  struct trace_record rec;
+
+  if(diverged) {
+    return;
+  }
+  if(trace_next(&rec) != 1 || rec.type != TRACE_OUT || rec.len != len || memcmp(rec.msg, buf, len) != 0) {
+    printf("Replay: message '%c' differs from the trace after %lu records\n", buf[0], replayed);
+    diverged = 1;
+    return;
+  }
+  replayed++;
+}
+
+static void
+send_message(const char *buf, unsigned len)
+{
+  if(replaying) {
+    replay_check(buf, len);
+    return;
+  }
+  trace_record(TRACE_OUT, NULL, 0, buf, len);
+  sendto(sock, buf, len, 0, (struct sockaddr *)&reader, reader_len);
+}
+
+static void
+send_hello(void)
+{
+  /* "hello" and our ECC_CURVE (2 bytes, little-endian), for readers that serve several curves. */
+  char buf[] = {'h', 'e', 'l', 'l', 'o', ECC_CURVE & 0xFF, ECC_CURVE >> 8};
+
+  send_message(buf, sizeof(buf));
+}
+
+/* Answers one message of the reader. Returns 1 once the reader confirmed the tag, -1 if the handshake
+   failed and 0 while it goes on. */
+static int
+handle_message(const uint8_t *msg, size_t len)
+{
+  char buf[MSG_LEN];
+  uint64_t start;
+  int result;
+
+  memset(buf, 0, sizeof(buf));
+  if(len >= 2 * NUM_ECC_DIGITS + 1 && msg[0] == '1') {
+    memcpy(E.x, msg + 1, NUM_ECC_DIGITS);
+    memcpy(E.y, msg + 1 + NUM_ECC_DIGITS, NUM_ECC_DIGITS);
+    start = udp_now_us();
+    IBIHOP_Pass2(&R, r);
+    p2_runs++;
+    p2_us += udp_now_us() - start;
+    if(!quiet) {
+      printf("P2: Completion time %lu us\n", (unsigned long)(udp_now_us() - start));
+    }
+    buf[0] = '2';
+    memcpy(buf + 1, R.x, NUM_ECC_DIGITS);
+    memcpy(buf + 1 + NUM_ECC_DIGITS, R.y, NUM_ECC_DIGITS);
+  } else if(len >= NUM_ECC_DIGITS + 1 && msg[0] == '3') {
+    memcpy(f, msg + 1, NUM_ECC_DIGITS);
+    start = udp_now_us();
+    result = IBIHOP_Pass4(s, &pk_s, &E, f, r, sk_c);
+    p4_runs++;
+    p4_us += udp_now_us() - start;
+    if(result != 0) {
+      printf("Reader is invalid!\n");
+      buf[0] = '8';
+      send_message(buf, sizeof(buf));
+      return -1;
+    }
+    if(!quiet) {
+      printf("P4: Completion time %lu us\n", (unsigned long)(udp_now_us() - start));
+    }
+    buf[0] = '4';
+    memcpy(buf + 1, s, NUM_ECC_DIGITS);
+  } else if(len >= 1 && msg[0] == '5') {
+    return 1;
+  } else {
+    return 0;
+  }
+  send_message(buf, sizeof(buf));
+  return 0;
+}
+
+/* Feeds the messages of a trace to the tag as if they came from the reader. The hellos it sent are left
+   out, as they depend on timeouts only. */
+static int
+replay(const char *path)
+{
+  struct trace_header header;
+  struct trace_record rec;
+  unsigned long done = 0, failed = 0;
+  uint32_t span = 0;
+  int result;
+
+  if(trace_open(path, &header) != 0) {
+    return 2;
+  }
+  if(header.role != 't' || header.curve != ECC_CURVE) {
+    fprintf(stderr, "%s: not a trace of this tag (role %c, curve %u)\n", path, header.role, header.curve);
+    trace_close();
+    return 2;
+  }
+  replaying = 1;
+  trace_seed(header.seed);
+  while(!diverged && (result = trace_next(&rec)) == 1) {
+    replayed++;
+    span = rec.time_us;
+    if(rec.type == TRACE_IN) {
+      switch(handle_message(rec.msg, rec.len)) {
+      case 1:
+        done++;
+        break;
+      case -1:
+        failed++;
+        break;
+      }
+    } else if(rec.type != TRACE_OUT || rec.len < 5 || memcmp(rec.msg, "hello", 5) != 0) {
+      printf("Replay: the trace has message '%c' that the tag did not send, after %lu records\n",
+             rec.len ? rec.msg[0] : '?', replayed - 1);
+      diverged = 1;
+    }
+  }
+  trace_close();
+  printf("%lu records replayed (%lu ms recorded), seed %llu\n", replayed, (unsigned long)(span / 1000),
+         (unsigned long long)header.seed);
+  printf("P2: %lu runs, %lu us\n", p2_runs, (unsigned long)p2_us);
+  printf("P4: %lu runs, %lu us\n", p4_runs, (unsigned long)p4_us);
+  printf("%lu handshakes, %lu failed\n", done + failed, failed);
+  return result < 0 || diverged;
+}
+
+int
+main(int argc, char **argv)
+{
+  const char *host = "::1", *port = IBIHOP_READER_PORT, *local = IBIHOP_TAG_PORT, *record = NULL, *play = NULL;
+  unsigned long handshakes = 1, done = 0, failed = 0, k;
+  int timeout = 2000, retries = 5, sent, result, opt;
+  uint8_t msg[MSG_LEN + 1];
+  struct pollfd pfd;
+  uint64_t start, total = 0, seed = 0;
+  int seeded = 0;
+  ssize_t len;
+
+  while((opt = getopt(argc, argv, "c:p:l:n:t:r:S:w:R:q")) != -1) {
+    switch(opt) {
+    case 'c':
+      host = optarg;
+      break;
+    case 'p':
+      port = optarg;
+      break;
+    case 'l':
+      local = optarg;
+      break;
+    case 'n':
+      handshakes = strtoul(optarg, NULL, 0);
+      break;
+    case 't':
+      timeout = atoi(optarg);
+      break;
+    case 'r':
+      retries = atoi(optarg);
+      break;
+    case 'S':
+      seed = strtoull(optarg, NULL, 0);
+      seeded = 1;
+      break;
+    case 'w':
+      record = optarg;
+      break;
+    case 'R':
+      play = optarg;
+      break;
+    case 'q':
+      quiet = 1;
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-c reader] [-p port] [-l local port] [-n handshakes] [-t timeout ms] "
+              "[-r retries] [-S seed] [-w trace] [-q]\n       %s -R trace [-q]\n", argv[0], argv[0]);
+      return 2;
+    }
+  }
+  setvbuf(stdout, NULL, _IOLBF, 0);
+
+  if(play != NULL) {
+    return replay(play);
+  }
+  if(record != NULL && !seeded) {
+    seed = trace_new_seed();
+    seeded = 1;
+  }
+  if(seeded) {
+    trace_seed(seed);
+  }
+
+  if(udp_resolve(host, port, &reader, &reader_len) != 0 || (sock = udp_open(reader.ss_family, local)) < 0) {
+    return 2;
+  }
+  if(record != NULL && trace_create(record, 't', ECC_CURVE, seed) != 0) {
+    return 2;
+  }
+  pfd.fd = sock;
+  pfd.events = POLLIN;
+
+  for(k = 0; k < handshakes; k++) {
+    start = udp_now_us();
+    result = 0;
+    for(sent = 0; result == 0 && sent < retries; sent++) {
+      send_hello();
+      while(result == 0 && poll(&pfd, 1, timeout) > 0) {
+        len = recv(sock, msg, sizeof(msg), 0);
+        if(len > 0) {
+          trace_record(TRACE_IN, NULL, 0, msg, (unsigned)len);
+          result = handle_message(msg, (size_t)len);
+        }
+      }
+    }
+    if(result == 1) {
+      done++;
+      total += udp_now_us() - start;
+      if(!quiet) {
+        printf("Handshake %lu: %lu us\n", k + 1, (unsigned long)(udp_now_us() - start));
+      }
+    } else {
+      failed++;
+      if(result == 0) {
+        printf("Handshake %lu: no answer after %d hellos\n", k + 1, retries);
+      }
+    }
+  }
+  trace_close();
+  printf("%lu handshakes, %lu failed, mean %lu us\n", done + failed, failed,
+         (unsigned long)(done ? total / done : 0));
+  return failed != 0;
+}
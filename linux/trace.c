@@ -0,0 +1,192 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+*/
+#define _POSIX_C_SOURCE 200809L
+#include "trace.h"
+#include "udp.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+
+#ifndef ECC_DRBG
+#define ECC_DRBG 0	/* as in nano-ecc.h */
+#endif
+#if ECC_DRBG
+#include "ecc-drbg.h"
+#endif
+
+#define TRACE_HEADER_BYTES 16
+#define TRACE_RECORD_BYTES 8
+
+static FILE *trace_file;
+static uint64_t trace_start;
+
+static void store16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void store32(uint8_t *p, uint32_t v)
+{
+    store16(p, (uint16_t)v);
+    store16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t load16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t load32(const uint8_t *p)
+{
+    return load16(p) | ((uint32_t)load16(p + 2) << 16);
+}
+
+int trace_create(const char *p_path, uint8_t p_role, uint16_t p_curve, uint64_t p_seed)
+{
+    uint8_t l_header[TRACE_HEADER_BYTES];
+
+    trace_file = fopen(p_path, "wb");
+    if(!trace_file)
+    {
+        perror(p_path);
+        return -1;
+    }
+    memcpy(l_header, "IBHT", 4);
+    l_header[4] = TRACE_VERSION;
+    l_header[5] = p_role;
+    store16(l_header + 6, p_curve);
+    store32(l_header + 8, (uint32_t)p_seed);
+    store32(l_header + 12, (uint32_t)(p_seed >> 32));
+    fwrite(l_header, 1, sizeof(l_header), trace_file);
+    trace_start = udp_now_us();
+    return 0;
+}
+
+void trace_record(uint8_t p_type, const void *p_addr, unsigned p_addr_len, const void *p_msg, unsigned p_len)
+{
+    uint8_t l_record[TRACE_RECORD_BYTES];
+
+    if(!trace_file)
+    {
+        return;
+    }
+    store32(l_record, (uint32_t)(udp_now_us() - trace_start));
+    l_record[4] = p_type;
+    l_record[5] = (uint8_t)p_addr_len;
+    store16(l_record + 6, (uint16_t)p_len);
+    fwrite(l_record, 1, sizeof(l_record), trace_file);
+    if(p_addr_len)
+    {
+        fwrite(p_addr, 1, p_addr_len, trace_file);
+    }
+    if(p_len)
+    {
+        fwrite(p_msg, 1, p_len, trace_file);
+    }
+}
+
+int trace_open(const char *p_path, struct trace_header *p_header)
+{
+    uint8_t l_header[TRACE_HEADER_BYTES];
+
+    trace_file = fopen(p_path, "rb");
+    if(!trace_file)
+    {
+        perror(p_path);
+        return -1;
+    }
+    if(fread(l_header, 1, sizeof(l_header), trace_file) != sizeof(l_header) || memcmp(l_header, "IBHT", 4) != 0
+       || l_header[4] != TRACE_VERSION)
+    {
+        fprintf(stderr, "%s: not an IBIHOP trace of version %d\n", p_path, TRACE_VERSION);
+        trace_close();
+        return -1;
+    }
+    p_header->role = l_header[5];
+    p_header->curve = load16(l_header + 6);
+    p_header->seed = load32(l_header + 8) | ((uint64_t)load32(l_header + 12) << 32);
+    return 0;
+}
+
+int trace_next(struct trace_record *p_record)
+{
+    uint8_t l_record[TRACE_RECORD_BYTES];
+    size_t l_read;
+
+    l_read = fread(l_record, 1, sizeof(l_record), trace_file);
+    if(l_read == 0 && feof(trace_file))
+    {
+        return 0;
+    }
+    if(l_read != sizeof(l_record))
+    {
+        fprintf(stderr, "trace: truncated record\n");
+        return -1;
+    }
+    p_record->time_us = load32(l_record);
+    p_record->type = l_record[4];
+    p_record->addr_len = l_record[5];
+    p_record->len = load16(l_record + 6);
+    if(p_record->addr_len > TRACE_ADDR_MAX || p_record->len > TRACE_MSG_MAX
+       || fread(p_record->addr, 1, p_record->addr_len, trace_file) != p_record->addr_len
+       || fread(p_record->msg, 1, p_record->len, trace_file) != p_record->len)
+    {
+        fprintf(stderr, "trace: corrupt record\n");
+        return -1;
+    }
+    return 1;
+}
+
+void trace_close(void)
+{
+    if(trace_file)
+    {
+        fclose(trace_file);
+        trace_file = NULL;
+    }
+}
+
+void trace_seed(uint64_t p_seed)
+{
+#if ECC_DRBG
+    uint8_t l_seed[8];
+
+    store32(l_seed, (uint32_t)p_seed);
+    store32(l_seed + 4, (uint32_t)(p_seed >> 32));
+    ecc_drbg_instantiate(l_seed, sizeof(l_seed));
+#else
+    srand((unsigned)(p_seed ^ (p_seed >> 32)));
+#endif
+}
+
+uint64_t trace_new_seed(void)
+{
+    uint8_t l_seed[8];
+    unsigned l_have = 0;
+    ssize_t l_read;
+
+    while(l_have < sizeof(l_seed))
+    {
+        l_read = getrandom(l_seed + l_have, sizeof(l_seed) - l_have, 0);
+        if(l_read < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            perror("getrandom");
+            exit(2);	/* a guessable seed would give away the nonces, and with them the keys */
+        }
+        l_have += (unsigned)l_read;
+    }
+    return load32(l_seed) | ((uint64_t)load32(l_seed + 4) << 32);
+}
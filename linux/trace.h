@@ -0,0 +1,120 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Handshake traces of the Linux reader and tag (-w to record, -R to replay). A trace holds every IBIHOP
+message a program received and sent, in order, with its time and peer, and the seed its random bytes
+were drawn from. Replaying feeds the received messages to the same code under the same seed, so the
+nonces, and with them every message sent, come out the same, and checks them against the trace. Two
+builds of the ECC code can so be timed on exactly the same handshakes.
+
+A trace is key material. Its seed regenerates every nonce of the run, and with the tag's r the messages
+of a handshake give its key: sk_t = (s - r) / e. Record only with the demo keys of ibihop-keys.h or keys
+that are thrown away afterwards, and keep the files private.
+
+File layout, little-endian:
+	header	"IBHT", version (1 byte), role ('r' reader, 't' tag, 1 byte), curve (2 bytes, ECC_CURVE of
+		the tag, 0 for the reader), seed (8 bytes)
+	record	time since the header in us (4 bytes), type (1 byte), peer address length (1 byte), message
+		length (2 bytes), the peer address (a struct sockaddr as received, none on the tag), the message
+*/
+#ifndef IBIHOP_TRACE_H_
+#define IBIHOP_TRACE_H_
+
+#include <stdint.h>
+
+#define TRACE_VERSION 1
+
+/* Record types. */
+#define TRACE_IN 'i'	/* a message received */
+#define TRACE_OUT 'o'	/* a message sent */
+#define TRACE_RUN 'p'	/* the reader ran its pending Pass1 and Pass3 batches */
+
+#define TRACE_ADDR_MAX 28	/* struct sockaddr_in6 */
+#define TRACE_MSG_MAX 128
+
+struct trace_header {
+  uint8_t role;
+  uint16_t curve;
+  uint64_t seed;
+};
+
+struct trace_record {
+  uint32_t time_us;
+  uint8_t type;
+  uint8_t addr_len;
+  uint16_t len;
+  uint8_t addr[TRACE_ADDR_MAX];
+  uint8_t msg[TRACE_MSG_MAX];
+};
+
+/*
+trace_create:
+	Start recording to a new file.
+Input:
+	p_path	- file name.
+	p_role	- 'r' or 't'.
+	p_curve	- curve id of the tag, 0 for the reader.
+	p_seed	- the seed given to trace_seed().
+Output:
+	0 on success, -1 if the file cannot be written (with a message on stderr).
+*/
+int trace_create(const char *p_path, uint8_t p_role, uint16_t p_curve, uint64_t p_seed);
+
+/*
+trace_record:
+	Append a record to the trace being recorded, if any.
+Input:
+	p_type	- TRACE_IN, TRACE_OUT or TRACE_RUN.
+	p_addr	- peer address, or NULL.
+	p_addr_len	- its length, at most TRACE_ADDR_MAX.
+	p_msg	- the message, or NULL.
+	p_len	- its length, at most TRACE_MSG_MAX.
+*/
+void trace_record(uint8_t p_type, const void *p_addr, unsigned p_addr_len, const void *p_msg, unsigned p_len);
+
+/*
+trace_open:
+	Open a trace for replay.
+Input:
+	p_path	- file name.
+	p_header	- variable for taking its header.
+Output:
+	0 on success, -1 if the file cannot be read or is not a trace (with a message on stderr).
+*/
+int trace_open(const char *p_path, struct trace_header *p_header);
+
+/*
+trace_next:
+	Read the next record of the trace opened for replay.
+Input:
+	p_record	- variable for taking the record.
+Output:
+	1 for a record, 0 at the end of the trace, -1 if it is truncated or corrupt (with a message on stderr).
+*/
+int trace_next(struct trace_record *p_record);
+
+/*
+trace_close:
+	Close the trace being recorded or replayed.
+*/
+void trace_close(void);
+
+/*
+trace_seed:
+	Make the random bytes of nano-ecc a function of p_seed alone: the DRBG is instantiated from it
+	(ECC_DRBG=1), or rand() is seeded with it.
+*/
+void trace_seed(uint64_t p_seed);
+
+/*
+trace_new_seed:
+	A seed for a run that is recorded without one given, drawn from getrandom(). Exits if there is no
+	kernel entropy.
+*/
+uint64_t trace_new_seed(void);
+
+#endif /* IBIHOP_TRACE_H_ */
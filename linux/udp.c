@@ -0,0 +1,82 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+*/
+#define _POSIX_C_SOURCE 200809L
+#include "udp.h"
+#include <netdb.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+int udp_resolve(const char *p_host, const char *p_port, struct sockaddr_storage *p_addr, socklen_t *p_len)
+{
+    struct addrinfo l_hints, *l_res;
+    int l_err;
+
+    memset(&l_hints, 0, sizeof(l_hints));
+    l_hints.ai_family = AF_UNSPEC;
+    l_hints.ai_socktype = SOCK_DGRAM;
+    l_err = getaddrinfo(p_host, p_port, &l_hints, &l_res);
+    if(l_err != 0)
+    {
+        fprintf(stderr, "%s port %s: %s\n", p_host, p_port, gai_strerror(l_err));
+        return -1;
+    }
+    memcpy(p_addr, l_res->ai_addr, l_res->ai_addrlen);
+    *p_len = l_res->ai_addrlen;
+    freeaddrinfo(l_res);
+    return 0;
+}
+
+int udp_open(int p_family, const char *p_port)
+{
+    struct addrinfo l_hints, *l_res;
+    int l_fd, l_off = 0, l_err;
+
+    memset(&l_hints, 0, sizeof(l_hints));
+    l_hints.ai_family = p_family;
+    l_hints.ai_socktype = SOCK_DGRAM;
+    l_hints.ai_flags = AI_PASSIVE;
+    l_err = getaddrinfo(NULL, p_port, &l_hints, &l_res);
+    if(l_err != 0)
+    {
+        fprintf(stderr, "port %s: %s\n", p_port, gai_strerror(l_err));
+        return -1;
+    }
+    l_fd = socket(l_res->ai_family, SOCK_DGRAM, 0);
+    if(l_fd < 0)
+    {
+        perror("socket");
+    }
+    else
+    {
+        if(p_family == AF_INET6)
+        {
+            setsockopt(l_fd, IPPROTO_IPV6, IPV6_V6ONLY, &l_off, sizeof(l_off));
+        }
+        if(bind(l_fd, l_res->ai_addr, l_res->ai_addrlen) != 0)
+        {
+            fprintf(stderr, "bind port %s: ", p_port);
+            perror(NULL);
+            close(l_fd);
+            l_fd = -1;
+        }
+    }
+    freeaddrinfo(l_res);
+    return l_fd;
+}
+
+uint64_t udp_now_us(void)
+{
+    struct timespec l_ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &l_ts);
+    return (uint64_t)l_ts.tv_sec * 1000000 + (uint64_t)l_ts.tv_nsec / 1000;
+}
@@ -0,0 +1,55 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Shared by the Linux reader and tag: the ports and message layout of client.c and server.c, UDP
+sockets over IPv6 or IPv4, and a monotonic clock.
+*/
+#ifndef IBIHOP_UDP_H_
+#define IBIHOP_UDP_H_
+
+#include <stdint.h>
+#include <sys/socket.h>
+
+/* UDP_SERVER_PORT and UDP_CLIENT_PORT of server.c and client.c. The mote reader always answers to
+   the tag port, so the Linux tag binds it unless told otherwise. */
+#define IBIHOP_READER_PORT "5678"
+#define IBIHOP_TAG_PORT "8765"
+
+/* Every message is a flag byte and up to two values of the curve, padded as the motes send them. */
+#define IBIHOP_MSG_LEN(digits) (2 * (digits) + 2)
+
+/*
+udp_resolve:
+	Resolve a host and port.
+Input:
+	p_host	- name or address, IPv6 or IPv4.
+	p_port	- port number.
+	p_addr	- variable for taking the address.
+	p_len	- variable for taking its length.
+Output:
+	0 on success, -1 if the address cannot be resolved (with a message on stderr).
+*/
+int udp_resolve(const char *p_host, const char *p_port, struct sockaddr_storage *p_addr, socklen_t *p_len);
+
+/*
+udp_open:
+	Open a UDP socket bound to a local port on every address. An IPv6 socket takes IPv4 too.
+Input:
+	p_family	- AF_INET6 or AF_INET.
+	p_port	- local port, "0" for any.
+Output:
+	the socket, or -1 (with a message on stderr).
+*/
+int udp_open(int p_family, const char *p_port);
+
+/*
+udp_now_us:
+	Microseconds of CLOCK_MONOTONIC.
+*/
+uint64_t udp_now_us(void);
+
+#endif /* IBIHOP_UDP_H_ */
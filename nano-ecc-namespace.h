@@ -0,0 +1,76 @@
+/*
+
+Created
+  based on nano-ecc: https://github.com/iSECPartners/nano-ecc
+by
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Prefixes every external symbol of nano-ecc.c and ibihop.c with ECC_NAMESPACE, so that several
+curves can be linked into one image (see ibihop-curve.h). Included by nano-ecc.h when
+ECC_NAMESPACE is defined.
+*/
+
+#ifndef NANOECC_NAMESPACE_H_
+#define NANOECC_NAMESPACE_H_
+
+#define ECC_NS1(ns, name) ns##name
+#define ECC_NS2(ns, name) ECC_NS1(ns, name)
+#define ECC_NS(name) ECC_NS2(ECC_NAMESPACE, name)
+
+#define vli_clear                ECC_NS(vli_clear)
+#define vli_isZero               ECC_NS(vli_isZero)
+#define vli_testBit              ECC_NS(vli_testBit)
+#define vli_numBits              ECC_NS(vli_numBits)
+#define vli_set                  ECC_NS(vli_set)
+#define vli_cmp                  ECC_NS(vli_cmp)
+#define vli_sub                  ECC_NS(vli_sub)
+#define vli_modAdd               ECC_NS(vli_modAdd)
+#define vli_modSub               ECC_NS(vli_modSub)
+#define vli_modMult_fast         ECC_NS(vli_modMult_fast)
+#define vli_modInv               ECC_NS(vli_modInv)
+#define vli_modMult              ECC_NS(vli_modMult)
+#define vli_print                ECC_NS(vli_print)
+#define EccPoint_isZero          ECC_NS(EccPoint_isZero)
+#define EccPoint_double_jacobian ECC_NS(EccPoint_double_jacobian)
+#define apply_z                  ECC_NS(apply_z)
+#define XYcZ_add                 ECC_NS(XYcZ_add)
+#define XYcZ_addC                ECC_NS(XYcZ_addC)
+#define EccPoint_mult            ECC_NS(EccPoint_mult)
+#define EccPoint_mult_batch      ECC_NS(EccPoint_mult_batch)
+#define EccPoint_isSum           ECC_NS(EccPoint_isSum)
+#define ecc_make_key             ECC_NS(ecc_make_key)
+#define ecc_valid_public_key     ECC_NS(ecc_valid_public_key)
+#define ecdsa_sign               ECC_NS(ecdsa_sign)
+#define ecdsa_verify             ECC_NS(ecdsa_verify)
+#define ecc_bytes2native         ECC_NS(ecc_bytes2native)
+#define ecc_native2bytes         ECC_NS(ecc_native2bytes)
+#define ecc_table_init           ECC_NS(ecc_table_init)
+#define ecc_x86_64_has_adx       ECC_NS(ecc_x86_64_has_adx)
+#define ecc_simd_lanes           ECC_NS(ecc_simd_lanes)
+#define ecc_stats_get            ECC_NS(ecc_stats_get)
+#define ecc_stats_reset          ECC_NS(ecc_stats_reset)
+#define NegtiveNX                ECC_NS(NegtiveNX)
+#define ModNInv                  ECC_NS(ModNInv)
+#define ModNInv_batch            ECC_NS(ModNInv_batch)
+#define ModNReduce               ECC_NS(ModNReduce)
+#define ModNAdd                  ECC_NS(ModNAdd)
+#define ModNSub                  ECC_NS(ModNSub)
+#define ModNMult                 ECC_NS(ModNMult)
+#define IsGenerator              ECC_NS(IsGenerator)
+#define FastCompute              ECC_NS(FastCompute)
+#define getRandomBytes           ECC_NS(getRandomBytes)
+#define getRandomBytes2          ECC_NS(getRandomBytes2)
+#define GetN                     ECC_NS(GetN)
+#define GetP                     ECC_NS(GetP)
+#define GetG                     ECC_NS(GetG)
+#define IBIHOP_KeyGen            ECC_NS(IBIHOP_KeyGen)
+#define IBIHOP_Pass1             ECC_NS(IBIHOP_Pass1)
+#define IBIHOP_Pass1_batch       ECC_NS(IBIHOP_Pass1_batch)
+#define IBIHOP_Pass2             ECC_NS(IBIHOP_Pass2)
+#define IBIHOP_Pass3             ECC_NS(IBIHOP_Pass3)
+#define IBIHOP_Pass3_batch       ECC_NS(IBIHOP_Pass3_batch)
+#define IBIHOP_Pass4             ECC_NS(IBIHOP_Pass4)
+#define IBIHOP_TagVerf           ECC_NS(IBIHOP_TagVerf)
+
+#endif /* NANOECC_NAMESPACE_H_ */
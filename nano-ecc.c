@@ -12,6 +12,10 @@ by
 #include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
+#include <string.h>
+#if ECC_DRBG
+#include "ecc-drbg.h"
+#endif
 
 typedef unsigned int uint;
 
@@ -20,6 +24,8 @@ typedef unsigned int uint;
 
 #define Curve_P_16 {  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
     0xFF, 0xFF, 0xFF, 0xFD, 0xFF, 0xFF, 0xFF }
+#define Curve_P_20 {  0xFF, 0xFF, 0xFF, 0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 }
 #define Curve_P_24 {  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFE, \
     0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
     0xFF, 0xFF, 0xFF }
@@ -34,6 +40,8 @@ typedef unsigned int uint;
 
 #define Curve_B_16 {  0xD3, 0x5E, 0xEE, 0x2C, 0x3C, 0x99, 0x24, 0xD8, 0x3D, \
     0xF4, 0x79, 0x10, 0xC1, 0x79, 0x75, 0xE8 }
+#define Curve_B_20 {  0x45, 0xFA, 0x65, 0xC5, 0xAD, 0xD4, 0xD4, 0x81, 0x9F, \
+    0xF8, 0xAC, 0x65, 0x8B, 0x7A, 0xBD, 0x54, 0xFC, 0xBE, 0x97, 0x1C, 0x00 }
 #define Curve_B_24 {  0xB1, 0xB9, 0x46, 0xC1, 0xEC, 0xDE, 0xB8, 0xFE, 0x49, \
     0x30, 0x24, 0x72, 0xAB, 0xE9, 0xA7, 0x0F, 0xE7, 0x80, 0x9C, 0xE5, 0x19, \
     0x05, 0x21, 0x64 }
@@ -52,6 +60,12 @@ typedef unsigned int uint;
     {0x83, 0x7A, 0xED, 0xDD, 0x92, 0xA2, 0x2D, 0xC0, 0x13, 0xEB, 0xAF, 0x5B, \
         0x39, 0xC8, 0x5A, 0xCF}}
 
+#define Curve_G_20 { \
+    {0x82, 0xFC, 0xCB, 0x13, 0xB9, 0x8B, 0xC3, 0x68, 0x89, 0x69, 0x64, 0x46, \
+        0x28, 0x73, 0xF5, 0x8E, 0x68, 0xB5, 0x96, 0x4A, 0x00}, \
+    {0x32, 0xFB, 0xC5, 0x7A, 0x37, 0x51, 0x23, 0x04, 0x12, 0xC9, 0xDC, 0x59, \
+        0x7D, 0x94, 0x68, 0x31, 0x55, 0x28, 0xA6, 0x23, 0x00}}
+
 #define Curve_G_24 { \
     {0x12, 0x10, 0xFF, 0x82, 0xFD, 0x0A, 0xFF, 0xF4, 0x00, 0x88, 0xA1, 0x43, \
         0xEB, 0x20, 0xBF, 0x7C, 0xF6, 0x90, 0x30, 0xB0, 0x0E, 0xA8, 0x8D, \
@@ -82,6 +96,8 @@ typedef unsigned int uint;
 
 #define Curve_N_16 {  0x15, 0xA1, 0x38, 0x90, 0x1B, 0x0D, 0xA3, 0x75, 0x00, \
     0x00, 0x00, 0x00, 0xFE, 0xFF, 0xFF, 0xFF }
+#define Curve_N_20 {  0x57, 0x22, 0x75, 0xCA, 0xD3, 0xAE, 0x27, 0xF9, 0xC8, \
+    0xF4, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01 }
 #define Curve_N_24 {  0x31, 0x28, 0xD2, 0xB4, 0xB1, 0xC9, 0x6B, 0x14, 0x36, \
     0xF8, 0xDE, 0x99, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
     0xFF, 0xFF, 0xFF}
@@ -93,6 +109,71 @@ typedef unsigned int uint;
     0x4D, 0x63, 0xC7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
     0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
     0xFF, 0xFF, 0xFF}
+/* curve25519: G is (9, y); the x-only arithmetic only uses its y through the generator table. */
+#define Curve_P_25519 {  0xED, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F }
+
+#define Curve_G_25519 { \
+    {0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, \
+    {0xD9, 0xD3, 0xCE, 0x7E, 0xA2, 0xC5, 0xE9, 0x29, 0xB2, 0x61, 0x7C, 0x6D, \
+        0x7E, 0x4D, 0x3D, 0x92, 0x4C, 0xD1, 0x48, 0x77, 0x2C, 0xDD, 0x1E, \
+        0xE0, 0xB4, 0x86, 0xA0, 0xB8, 0xA1, 0x19, 0xAE, 0x20}}
+
+#define Curve_N_25519 {  0xED, 0xD3, 0xF5, 0x5C, 0x1A, 0x63, 0x12, 0x58, 0xD6, \
+    0x9C, 0xF7, 0xA2, 0xDE, 0xF9, 0xDE, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10 }
+
+/* Montgomery coefficient A = 486662. */
+#define Curve_A_25519 {  0x06, 0x6D, 0x07 }
+
+/* x of the two points of order 8; 0 (order 2), 1 and p-1 (order 4) are the other points of small order. */
+#define Curve_X8_25519 { \
+    {0xE0, 0xEB, 0x7A, 0x7C, 0x3B, 0x41, 0xB8, 0xAE, 0x16, 0x56, 0xE3, 0xFA, \
+        0xF1, 0x9F, 0xC4, 0x6A, 0xDA, 0x09, 0x8D, 0xEB, 0x9C, 0x32, 0xB1, \
+        0xFD, 0x86, 0x62, 0x05, 0x16, 0x5F, 0x49, 0xB8, 0x00}, \
+    {0x5F, 0x9C, 0x95, 0xBC, 0xA3, 0x50, 0x8C, 0x24, 0xB1, 0xD0, 0xB1, 0x55, \
+        0x9C, 0x83, 0xEF, 0x5B, 0x04, 0x44, 0x5C, 0xC4, 0x58, 0x1C, 0x8E, \
+        0x86, 0xD8, 0x22, 0x4E, 0xDD, 0xD0, 0x9F, 0x11, 0x57}}
+
+/* The short Weierstrass form y^2 = x^3 + a*x + b of curve25519, used by the generator table: x = u + A/3 maps the
+   Montgomery point (u, y) onto it, and its a = (3 - A^2)/3. */
+#define Curve_W_25519 {  0x51, 0x24, 0xAD, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, \
+    0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, \
+    0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0x2A }
+#define Curve_WA_25519 {  0x44, 0xA1, 0x14, 0x49, 0x98, 0xAA, 0xAA, 0xAA, 0xAA, \
+    0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, \
+    0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0x2A }
+
+/* sect163k1: f(z) = z^163 + z^7 + z^6 + z^3 + 1 stands in for p, and a = b = 1. */
+#define Curve_P_163 {  0xC9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08 }
+#define Curve_B_163 {  0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }
+
+#define Curve_G_163 { \
+    {0xE8, 0xEE, 0x94, 0x5C, 0x5E, 0x6D, 0x4E, 0xDE, 0x93, 0xD7, 0x07, 0xAA, \
+        0xAC, 0x11, 0xBC, 0x7B, 0x53, 0xC0, 0x13, 0xFE, 0x02}, \
+    {0xD9, 0xA3, 0xDA, 0xCC, 0x38, 0xD5, 0x36, 0x05, 0x80, 0x2E, 0x1F, 0x32, \
+        0x58, 0xFF, 0x38, 0x5D, 0xB0, 0x0F, 0x07, 0x89, 0x02}}
+
+#define Curve_N_163 {  0xEF, 0xA5, 0xF8, 0x99, 0x0D, 0xCC, 0xE0, 0xA2, 0x08, \
+    0x01, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04 }
+
+/* 2^(8*NUM_ECC_DIGITS) % p, what a carry out of the top digit is worth, for ECC_LAZY_REDUCTION. */
+#define Curve_K_16 {  0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0x02 }
+#define Curve_K_20 {  0x00, 0x01, 0x00, 0x00, 0x80 }
+#define Curve_K_24 {  0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01 }
+#define Curve_K_32 {  0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+    0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
+    0xFF, 0xFF, 0xFF, 0xFE, 0xFF, 0xFF, 0xFF }
+#define Curve_K_48 {  0x01, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
+    0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x01 }
+#define Curve_K_25519 {  0x26 }
+
 #define PKT { \
     {0xEE, 0xB9, 0x10, 0x51, 0x7B, 0xBD, 0xF3, 0x7A, 0x68, 0x48, 0x50, 0xF7, 0xD5, 0xAF, 0xD5, 0x4E, 0x6F, 0x9D, 0xA6, 0xFE, 0x83, 0x50, 0x6C, 0x73}, \
     {0x4A, 0x91, 0xDD, 0x1F, 0x30, 0x05, 0x1D, 0x88, 0xB7, 0x76, 0x3D, 0xE1, 0x9F, 0x4E, 0x8A, 0x5F, 0xA9, 0xE4, 0x80, 0x12, 0xD5, 0x4D, 0x8B, 0xDD}}
@@ -107,9 +188,26 @@ typedef unsigned int uint;
 
 
 static uint8_t curve_p[NUM_ECC_DIGITS] = CONCAT(Curve_P_, ECC_CURVE);
+#if (ECC_CURVE == curve25519)
+static uint8_t curve_A[NUM_ECC_DIGITS] = Curve_A_25519;
+static uint8_t curve_x8[2][NUM_ECC_DIGITS] = Curve_X8_25519;
+#if ECC_FIXED_TABLE
+static uint8_t curve_w[NUM_ECC_DIGITS] = Curve_W_25519;
+static uint8_t curve_wa[NUM_ECC_DIGITS] = Curve_WA_25519;
+#endif
+#else
 static uint8_t curve_b[NUM_ECC_DIGITS] = CONCAT(Curve_B_, ECC_CURVE);
+#endif
 static EccPoint curve_G = CONCAT(Curve_G_, ECC_CURVE);
 static uint8_t curve_n[NUM_ECC_DIGITS] = CONCAT(Curve_N_, ECC_CURVE);
+#if (ECC_LAZY_REDUCTION && ECC_CURVE != sect163k1)
+static uint8_t curve_k[NUM_ECC_DIGITS] = CONCAT(Curve_K_, ECC_CURVE);
+#endif
+
+#if (ECC_CURVE == sect163k1)
+#define TNAF_DIGITS (NUM_ECC_DIGITS + 3) /* integers of the tau-adic reduction, see tnaf_reduce() */
+#define TNAF_LENGTH 167 /* digits of the tau-adic NAF of a reduced scalar: at most m + a + 3 (Guide to ECC, 3.4) */
+#endif
 
 
 void vli_clear(uint8_t *p_vli)
@@ -185,6 +283,20 @@ void vli_set(uint8_t *p_dest, uint8_t *p_src)
     }
 }
 
+#if (ECC_CURVE == sect163k1 || ECC_FIXED_TABLE)
+/* Copies p_src to p_dest if p_move is 1, leaves p_dest if it is 0, with the same memory accesses either way. */
+static void vli_cmov(uint8_t *p_dest, uint8_t *p_src, uint8_t p_move)
+{
+    uint8_t l_mask = -p_move;
+    uint i;
+
+    for(i = 0; i < NUM_ECC_DIGITS; ++i)
+    {
+        p_dest[i] ^= (p_dest[i] ^ p_src[i]) & l_mask;
+    }
+}
+#endif
+
 /* Returns sign of p_left - p_right. */
 int vli_cmp(uint8_t *p_left, uint8_t *p_right)
 {
@@ -233,6 +345,19 @@ static void vli_rshift1(uint8_t *p_vli)
     }
 }
 
+#if ECC_UNROLL
+    #include "nano-ecc-unrolled.inc"
+#endif
+
+#ifndef ECC_UNROLL_ADD
+    #define ECC_UNROLL_ADD 0
+#endif
+#ifndef ECC_UNROLL_MMOD
+    #define ECC_UNROLL_MMOD 0
+#endif
+
+#if !ECC_UNROLL_ADD
+
 /* Computes p_result = p_left + p_right, returning carry. Can modify in place. */
 static uint8_t vli_add(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right)
 {
@@ -267,6 +392,131 @@ uint8_t vli_sub(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right)
     return l_borrow;
 }
 
+#endif /* !ECC_UNROLL_ADD */
+
+#if (ECC_ASM == ecc_asm_x86_64)
+    #include "nano-ecc-x86_64.inc"
+#elif (ECC_ASM == ecc_asm_msp430)
+    #include "nano-ecc-msp430.inc"
+#elif (ECC_ASM == ecc_asm_cortexm)
+    #include "nano-ecc-cortexm.inc"
+#endif
+
+/* Set by a backend (or the unrolled kernels) that provides its own vli_mult(), vli_square()
+   or vli_mmod_fast(). */
+#ifndef ECC_ASM_MULT
+    #define ECC_ASM_MULT 0
+#endif
+#ifndef ECC_ASM_SQUARE
+    #define ECC_ASM_SQUARE 0
+#endif
+#ifndef ECC_WORD_MMOD
+    #define ECC_WORD_MMOD 0
+#endif
+
+/* Fermat inversion only beats the binary GCD with the word-level secp192r1/secp256r1 reductions (see nano-ecc.h). */
+#ifndef ECC_FERMAT_INV
+    #define ECC_FERMAT_INV (ECC_WORD_MMOD && (ECC_CURVE == secp192r1 || ECC_CURVE == secp256r1))
+#endif
+
+/* The SIMD ladders are those of the prime curves; curve25519 and sect163k1 ignore ECC_SIMD. */
+#define ECC_SIMD_LADDER (ECC_SIMD && ECC_CURVE != curve25519 && ECC_CURVE != sect163k1)
+
+/* ------ Temporaries ------ */
+
+typedef uint8_t EccVli[NUM_ECC_DIGITS];
+
+/* The temporaries of the field and point functions, by call depth: a function only calls functions of a lower
+   depth, so all the functions of one depth can share a slot (one union below). With ECC_SCRATCH this is the
+   arena they are taken from; without it, it only gives the size of each function's local arrays. */
+typedef struct EccScratch
+{
+#if (!ECC_WORD_MMOD && !ECC_UNROLL_MMOD && ECC_CURVE != curve25519 && ECC_CURVE != sect163k1)
+    union
+    {
+#if (ECC_CURVE == secp160r1)
+        uint8_t mmod[2 * NUM_ECC_DIGITS - 20];
+#elif (ECC_CURVE == secp384r1)
+        uint8_t mmod[2 * NUM_ECC_DIGITS];
+#else
+        uint8_t mmod[NUM_ECC_DIGITS];
+#endif
+    } d0;
+#endif
+    union
+    {
+        uint8_t product[2 * NUM_ECC_DIGITS];  /* vli_modMult_fast(), vli_modSquare_fast() */
+#if (ECC_CURVE == sect163k1)
+        struct { EccVli table[16]; uint8_t product[2 * NUM_ECC_DIGITS]; } comb;
+        struct { uint8_t wide[NUM_ECC_DIGITS + TNAF_DIGITS], q0[TNAF_DIGITS], q1[TNAF_DIGITS], t[TNAF_DIGITS]; } tnafReduce;
+#endif
+    } d1;
+    union
+    {
+        EccVli point[3];       /* doubling, apply_z(), XYcZ_add(), XYcZ_addC() */
+        EccVli modInv[4];      /* vli_modInv() */
+        EccVli validKey[3];    /* ecc_valid_public_key() */
+#if ECC_FERMAT_INV
+        EccVli modInvFast[8];  /* vli_modInv_fast(): x1, x2, x3, t1, t2 and up to three per curve */
+#endif
+#if (ECC_CURVE == curve25519)
+        EccVli xladder[5];
+        EccVli isSum[5];
+#endif
+    } d2;
+#if (ECC_CURVE != curve25519 || ECC_FIXED_TABLE)
+    union
+    {
+#if (ECC_CURVE != curve25519 && ECC_CURVE != sect163k1)
+        EccVli initialDouble[1];
+#endif
+#if (ECC_CURVE == sect163k1 || ECC_FIXED_TABLE)
+        EccVli addMixed[3];
+#endif
+    } d3;
+#endif
+#if (ECC_CURVE == sect163k1 || ECC_FIXED_TABLE)
+    union
+    {
+#if (ECC_CURVE == sect163k1)
+        struct { uint8_t r0[TNAF_DIGITS], r1[TNAF_DIGITS]; EccVli xy[3], sum[3]; } tnafAdd;
+#endif
+#if ECC_FIXED_TABLE
+        struct { EccPoint entry[1]; EccVli sum[3]; } tableSum;
+#endif
+    } d4;
+#endif
+    union
+    {
+        struct { uint8_t product[2 * NUM_ECC_DIGITS], multiple[2 * NUM_ECC_DIGITS]; } modMult;  /* vli_modMult() */
+#if (ECC_CURVE == curve25519 || ECC_CURVE == sect163k1 || ECC_FIXED_TABLE)
+        EccVli mult[3];        /* EccPoint_mult() with X, Y, Z; FastCompute() on sect163k1 */
+#endif
+#if (ECC_CURVE != curve25519 && ECC_CURVE != sect163k1)
+        struct { EccVli Rx[2], Ry[2], z[1]; } ladder;  /* EccPoint_mult() */
+        struct { EccVli v[6]; EccPoint sum[1]; } fastCompute;
+#endif
+    } d5;
+} EccScratch;
+
+#if ECC_SCRATCH
+static EccScratch ecc_scratch;
+/* Declares p_name as a pointer of type p_type * to the slot p_slot of the arena, or as a local array of that size. */
+#define ECC_TEMP(p_type, p_name, p_slot) p_type *p_name = ecc_scratch.p_slot
+#else
+#define ECC_TEMP(p_type, p_name, p_slot) p_type p_name[sizeof(((EccScratch *)0)->p_slot) / sizeof(p_type)]
+#endif
+
+#if ECC_STATS
+static EccStats ecc_stats;
+/* Counts one operation of the kind p_field of EccStats; nothing without ECC_STATS. */
+#define ECC_STAT(p_field) (++ecc_stats.p_field)
+#else
+#define ECC_STAT(p_field) ((void)0)
+#endif
+
+#if !ECC_ASM_MULT
+
 /* Computes p_result = p_left * p_right. */
 static void vli_mult(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right)
 {
@@ -293,6 +543,10 @@ static void vli_mult(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right)
     p_result[NUM_ECC_DIGITS*2 - 1] = (uint8_t)r01;
 }
 
+#endif /* !ECC_ASM_MULT */
+
+#if !ECC_UNROLL_ADD
+
 /* Computes p_result = (p_left + p_right) % p_mod.
    Assumes that p_left < p_mod and p_right < p_mod, p_result != p_mod. */
 void vli_modAdd(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right, uint8_t *p_mod)
@@ -316,13 +570,29 @@ void vli_modSub(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right, uint8_t *p
     }
 }
 
-#if ECC_CURVE == secp128r1
+#endif /* !ECC_UNROLL_ADD */
+
+#if (ECC_CURVE == sect163k1)
+
+#include "nano-ecc-gf2m.inc"
+
+#else /* ECC_CURVE == sect163k1 */
+
+#if ECC_WORD_MMOD
+
+/* vli_mmod_fast() is provided by the word-level reductions in nano-ecc-word.inc. */
+
+#elif ECC_UNROLL_MMOD
+
+/* vli_mmod_fast() is provided by the generated nano-ecc-unrolled.inc. */
+
+#elif ECC_CURVE == secp128r1
 
 /* Computes p_result = p_product % curve_p.
    See algorithm 5 and 6 from http://www.isys.uni-klu.ac.at/PDF/2001-0126-MT.pdf */
 static void vli_mmod_fast(uint8_t *p_result, uint8_t *p_product)
 {
-    uint8_t l_tmp[NUM_ECC_DIGITS];
+    ECC_TEMP(uint8_t, l_tmp, d0.mmod);
     int l_carry;
 
     vli_set(p_result, p_product);
@@ -441,13 +711,70 @@ static void vli_mmod_fast(uint8_t *p_result, uint8_t *p_product)
     }
 }
 
+#elif ECC_CURVE == secp160r1
+
+/* Computes p_result = p_product % curve_p. p = 2^160 - 2^31 - 1 ends inside byte 20, so the bits from 2^160 up (c1)
+   are cleared and added back as c1 + c1*2^31: three bytes and seven bits up. A full product is down to 161 bits
+   after two passes and almost always done after the third; what is left is below 2^160 < 2p. */
+#define P160_HIGH (2 * NUM_ECC_DIGITS - 20) /* bytes of a product from 2^160 up */
+
+static void vli_mmod_fast(uint8_t *p_result, uint8_t *p_product)
+{
+    ECC_TEMP(uint8_t, l_tmp, d0.mmod);
+    uint8_t l_top;
+    uint16_t l_acc;
+    uint i;
+
+    for(;;)
+    {
+        l_top = 0;
+        for(i = 0; i < P160_HIGH; ++i)
+        {
+            l_tmp[i] = p_product[20 + i];
+            l_top |= l_tmp[i];
+            p_product[20 + i] = 0;
+        }
+        if(!l_top)
+        {
+            break;
+        }
+
+        /* c1*2^31 < 2^207, so the sum ends below byte 27. */
+        l_acc = 0;
+        for(i = 0; i < 27; ++i)
+        {
+            l_acc += p_product[i];
+            if(i < P160_HIGH)
+            {
+                l_acc += l_tmp[i];
+            }
+            if(i >= 3 && i - 3 < P160_HIGH)
+            {
+                l_acc += (uint8_t)(l_tmp[i - 3] << 7);
+            }
+            if(i >= 4 && i - 4 < P160_HIGH)
+            {
+                l_acc += l_tmp[i - 4] >> 1;
+            }
+            p_product[i] = (uint8_t)l_acc;
+            l_acc >>= 8;
+        }
+    }
+
+    if(vli_cmp(p_product, curve_p) >= 0)
+    {
+        vli_sub(p_product, p_product, curve_p);
+    }
+    vli_set(p_result, p_product);
+}
+
 #elif ECC_CURVE == secp192r1
 
 /* Computes p_result = p_product % curve_p.
    See algorithm 5 and 6 from http://www.isys.uni-klu.ac.at/PDF/2001-0126-MT.pdf */
 static void vli_mmod_fast(uint8_t *p_result, uint8_t *p_product)
 {
-    uint8_t l_tmp[NUM_ECC_DIGITS];
+    ECC_TEMP(uint8_t, l_tmp, d0.mmod);
     int l_carry;
 
     vli_set(p_result, p_product);
@@ -500,7 +827,7 @@ static void vli_mmod_fast(uint8_t *p_result, uint8_t *p_product)
    from http://www.nsa.gov/ia/_files/nist-routines.pdf */
 static void vli_mmod_fast(uint8_t *p_result, uint8_t *p_product)
 {
-    uint8_t l_tmp[NUM_ECC_DIGITS];
+    ECC_TEMP(uint8_t, l_tmp, d0.mmod);
     int l_carry;
 
     /* t */
@@ -756,14 +1083,8 @@ static void omega_mult(uint8_t *p_result, uint8_t *p_right)
 {
     /* Multiply by (2^128 + 2^96 - 2^32 + 1). */
     vli_set(p_result, p_right); /* 1 */
-    p_result[16 + NUM_ECC_DIGITS] = vli_add(p_result + 12, p_result + 12, p_right); /* 2^96 + 1 */
-    p_result[17 + NUM_ECC_DIGITS] = 0;
-    p_result[18 + NUM_ECC_DIGITS] = 0;
-    p_result[19 + NUM_ECC_DIGITS] = 0;
-    p_result[20 + NUM_ECC_DIGITS] = vli_add(p_result + 16, p_result + 16, p_right); /* 2^128 + 2^96 + 1 */
-    p_result[21 + NUM_ECC_DIGITS] = 0;
-    p_result[22 + NUM_ECC_DIGITS] = 0;
-    p_result[23 + NUM_ECC_DIGITS] = 0;
+    p_result[12 + NUM_ECC_DIGITS] = vli_add(p_result + 12, p_result + 12, p_right); /* 2^96 + 1 */
+    p_result[16 + NUM_ECC_DIGITS] = vli_add(p_result + 16, p_result + 16, p_right); /* 2^128 + 2^96 + 1 */
     if(vli_sub(p_result + 4, p_result + 4, p_right)) /* 2^128 + 2^96 - 2^32 + 1 */
     { /* Propagate borrow if necessary. */
         uint i;
@@ -783,7 +1104,7 @@ static void omega_mult(uint8_t *p_result, uint8_t *p_right)
     section "Curve-Specific Optimizations" */
 static void vli_mmod_fast(uint8_t *p_result, uint8_t *p_product)
 {
-    uint8_t l_tmp[2*NUM_ECC_DIGITS];
+    ECC_TEMP(uint8_t, l_tmp, d0.mmod);
 
     while(!vli_isZero(p_product + NUM_ECC_DIGITS)) /* While c1 != 0 */
     {
@@ -807,25 +1128,63 @@ static void vli_mmod_fast(uint8_t *p_result, uint8_t *p_product)
         }
     }
 
-    while(vli_cmp(p_product, curve_p) > 0)
+    while(vli_cmp(p_product, curve_p) >= 0)
     {
         vli_sub(p_product, p_product, curve_p);
     }
     vli_set(p_result, p_product);
 }
 
+#elif ECC_CURVE == curve25519
+
+/* Computes p_result = p_product % curve_p. With 2^256 = 38 (mod p), the top half is added to the bottom half
+   times 38. The carry out of that (at most 38) is folded back the same way, twice: the first fold carries
+   out at most 1, and only when the result is then below 38*38, so the second cannot carry. At most two
+   subtractions of p are left. */
+static void vli_mmod_fast(uint8_t *p_result, uint8_t *p_product)
+{
+    uint16_t l_acc = 0;
+    uint i, l_fold;
+
+    for(i = 0; i < NUM_ECC_DIGITS; ++i)
+    {
+        l_acc += p_product[i] + 38 * (uint16_t)p_product[NUM_ECC_DIGITS + i];
+        p_result[i] = (uint8_t)l_acc;
+        l_acc >>= 8;
+    }
+
+    for(l_fold = 0; l_fold < 2; ++l_fold)
+    {
+        l_acc *= 38;
+        for(i = 0; i < NUM_ECC_DIGITS; ++i)
+        {
+            l_acc += p_result[i];
+            p_result[i] = (uint8_t)l_acc;
+            l_acc >>= 8;
+        }
+    }
+
+    while(vli_cmp(p_result, curve_p) >= 0)
+    {
+        vli_sub(p_result, p_result, curve_p);
+    }
+}
+
 #endif
 
 /* Computes p_result = (p_left * p_right) % curve_p. */
 void vli_modMult_fast(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right)
 {
-   uint8_t l_product[2 * NUM_ECC_DIGITS];
+   ECC_TEMP(uint8_t, l_product, d1.product);
+   ECC_STAT(modMult);
    vli_mult(l_product, p_left, p_right);
    vli_mmod_fast(p_result, l_product);
 }
 
 #if ECC_SQUARE_FUNC
 
+#if !ECC_ASM_SQUARE
+
 /* Computes p_result = p_left^2. */
 static void vli_square(uint8_t *p_result, uint8_t *p_left)
 {
@@ -855,10 +1214,13 @@ static void vli_square(uint8_t *p_result, uint8_t *p_left)
     p_result[NUM_ECC_DIGITS*2 - 1] = (uint8_t)r01;
 }
 
+#endif /* !ECC_ASM_SQUARE */
+
 /* Computes p_result = p_left^2 % curve_p. */
 static void vli_modSquare_fast(uint8_t *p_result, uint8_t *p_left)
 {
-    uint8_t l_product[2 * NUM_ECC_DIGITS];
+    ECC_TEMP(uint8_t, l_product, d1.product);
+    ECC_STAT(modSquare);
     vli_square(l_product, p_left);
     vli_mmod_fast(p_result, l_product);
 }
@@ -870,6 +1232,70 @@ static void vli_modSquare_fast(uint8_t *p_result, uint8_t *p_left)
 
 #endif /* ECC_SQUARE_FUNC */
 
+#if ECC_LAZY_REDUCTION
+
+/* Adds curve_k to p_vli if p_mask is 0xFF, nothing if it is 0, with the same memory accesses either way.
+   Returns the carry. */
+static uint8_t vli_addK(uint8_t *p_vli, uint8_t p_mask)
+{
+    uint16_t l_acc = 0;
+    uint i;
+
+    for(i = 0; i < NUM_ECC_DIGITS; ++i)
+    {
+        l_acc += p_vli[i] + (curve_k[i] & p_mask);
+        p_vli[i] = (uint8_t)l_acc;
+        l_acc >>= 8;
+    }
+    return (uint8_t)l_acc;
+}
+
+/* Subtracts curve_k from p_vli if p_mask is 0xFF, like vli_addK(). Returns the borrow. */
+static uint8_t vli_subK(uint8_t *p_vli, uint8_t p_mask)
+{
+    uint16_t l_acc = 0;
+    uint i;
+
+    for(i = 0; i < NUM_ECC_DIGITS; ++i)
+    {
+        l_acc = p_vli[i] - (curve_k[i] & p_mask) - l_acc;
+        p_vli[i] = (uint8_t)l_acc;
+        l_acc = (l_acc >> 8) & 1;
+    }
+    return (uint8_t)l_acc;
+}
+
+/* Computes p_result = (p_left + p_right) % curve_p, without fully reducing: the inputs may be any value
+   below 2^(8*NUM_ECC_DIGITS), and so is p_result. A carry is worth curve_k = 2^(8*NUM_ECC_DIGITS) % p and is
+   folded back in. That can carry once more, but only leaves a value below curve_k < 2^(8*NUM_ECC_DIGITS-1),
+   so the second fold cannot. Both folds always run, so the time does not depend on the values, and there is
+   no vli_cmp(). Every vli_mmod_fast() accepts such values and returns them reduced. */
+static void vli_modAdd_fast(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right)
+{
+    uint8_t l_carry = vli_add(p_result, p_left, p_right);
+    l_carry = vli_addK(p_result, -l_carry);
+    vli_addK(p_result, -l_carry);
+}
+
+/* Computes p_result = (p_left - p_right) % curve_p, with the same range as vli_modAdd_fast(). A borrow
+   subtracts curve_k; a second borrow leaves at least 2^(8*NUM_ECC_DIGITS) - curve_k > curve_k, so a third
+   cannot happen. */
+static void vli_modSub_fast(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right)
+{
+    uint8_t l_borrow = vli_sub(p_result, p_left, p_right);
+    l_borrow = vli_subK(p_result, -l_borrow);
+    vli_subK(p_result, -l_borrow);
+}
+
+#else /* ECC_LAZY_REDUCTION */
+
+#define vli_modAdd_fast(result, left, right) vli_modAdd((result), (left), (right), curve_p)
+#define vli_modSub_fast(result, left, right) vli_modSub((result), (left), (right), curve_p)
+
+#endif /* ECC_LAZY_REDUCTION */
+
+#endif /* ECC_CURVE == sect163k1 */
+
 #define EVEN(vli) (!(vli[0] & 1))
 /* Computes p_result = (1 / p_input) % p_mod. All VLIs are the same size.
    See "From Euclid's GCD to Montgomery Multiplication to the Great Divide"
@@ -882,9 +1308,26 @@ static void vli_modSquare_fast(uint8_t *p_result, uint8_t *p_left)
 
 void vli_modInv(uint8_t *p_result, uint8_t *p_input, uint8_t *p_mod)
 {
-    uint8_t a[NUM_ECC_DIGITS], b[NUM_ECC_DIGITS], u[NUM_ECC_DIGITS], v[NUM_ECC_DIGITS];
+    ECC_TEMP(uint8_t, a, d2.modInv[0]);
+    ECC_TEMP(uint8_t, b, d2.modInv[1]);
+    ECC_TEMP(uint8_t, u, d2.modInv[2]);
+    ECC_TEMP(uint8_t, v, d2.modInv[3]);
     uint8_t l_carry;
 
+    if(p_mod == curve_n)
+    {
+        ECC_STAT(modNInv);
+    }
+    else
+    {
+        ECC_STAT(modInv);
+    }
+    if(vli_isZero(p_input))
+    {
+        vli_clear(p_result); /* 0 has no inverse; the loop below would not end. */
+        return;
+    }
+
     vli_set(a, p_input);
     vli_set(b, p_mod);
     vli_clear(u);
@@ -964,6 +1407,172 @@ void vli_modInv(uint8_t *p_result, uint8_t *p_input, uint8_t *p_mod)
     vli_set(p_result, u);
 }
 
+#if ECC_FERMAT_INV
+
+/* Computes p_result = p_input^(2^p_squarings) * p_mult % curve_p, or just the squarings if p_mult is NULL.
+   p_result may be p_input, but not p_mult. */
+static void vli_modSquareMult_fast(uint8_t *p_result, uint8_t *p_input, uint p_squarings, uint8_t *p_mult)
+{
+    uint i;
+
+    vli_set(p_result, p_input);
+    for(i = 0; i < p_squarings; ++i)
+    {
+        vli_modSquare_fast(p_result, p_result);
+    }
+    if(p_mult)
+    {
+        vli_modMult_fast(p_result, p_result, p_mult);
+    }
+}
+
+/* Computes p_result = (1 / p_input) % curve_p as p_input^(p-2), with a fixed addition chain for each curve.
+   xN below holds p_input^(2^N - 1); the comments give p-2 as runs of bits from the top. */
+static void vli_modInv_fast(uint8_t *p_result, uint8_t *p_input)
+{
+    ECC_TEMP(uint8_t, x1, d2.modInvFast[0]);
+    ECC_TEMP(uint8_t, x2, d2.modInvFast[1]);
+    ECC_TEMP(uint8_t, x3, d2.modInvFast[2]);
+    ECC_TEMP(uint8_t, t1, d2.modInvFast[3]);
+    ECC_TEMP(uint8_t, t2, d2.modInvFast[4]);
+    ECC_STAT(modInv);
+
+    vli_set(x1, p_input);
+    vli_modSquareMult_fast(x2, x1, 1, x1);
+    vli_modSquareMult_fast(x3, x2, 1, x1);
+
+#if (ECC_CURVE == secp128r1)
+    /* p-2 = 1{30} 0 1{95} 0 1 */
+    ECC_TEMP(uint8_t, x5, d2.modInvFast[5]);
+    ECC_TEMP(uint8_t, x30, d2.modInvFast[6]);
+
+    vli_modSquareMult_fast(x5, x3, 2, x2);
+    vli_modSquareMult_fast(t1, x5, 5, x5);       /* x10 */
+    vli_modSquareMult_fast(t1, t1, 5, x5);       /* x15 */
+    vli_modSquareMult_fast(x30, t1, 15, t1);
+    vli_modSquareMult_fast(t2, x30, 30, x30);    /* x60 */
+    vli_modSquareMult_fast(t2, t2, 30, x30);     /* x90 */
+    vli_modSquareMult_fast(t2, t2, 5, x5);       /* x95 */
+
+    vli_modSquareMult_fast(t1, x30, 1, NULL);
+    vli_modSquareMult_fast(t1, t1, 95, t2);
+    vli_modSquareMult_fast(p_result, t1, 2, x1);
+
+#elif (ECC_CURVE == secp160r1)
+    /* p-2 = 1{128} 0 1{29} 0 1 */
+    ECC_TEMP(uint8_t, x4, d2.modInvFast[5]);
+    ECC_TEMP(uint8_t, x29, d2.modInvFast[6]);
+
+    vli_modSquareMult_fast(x4, x2, 2, x2);
+    vli_modSquareMult_fast(t1, x4, 4, x4);       /* x8 */
+    vli_modSquareMult_fast(t2, t1, 8, t1);       /* x16 */
+    vli_modSquareMult_fast(t2, t2, 8, t1);       /* x24 */
+    vli_modSquareMult_fast(t2, t2, 4, x4);       /* x28 */
+    vli_modSquareMult_fast(x29, t2, 1, x1);
+    vli_modSquareMult_fast(t1, x29, 3, x3);      /* x32 */
+    vli_modSquareMult_fast(t2, t1, 32, t1);      /* x64 */
+    vli_modSquareMult_fast(t1, t2, 64, t2);      /* x128 */
+
+    vli_modSquareMult_fast(t1, t1, 1, NULL);
+    vli_modSquareMult_fast(t1, t1, 29, x29);
+    vli_modSquareMult_fast(p_result, t1, 2, x1);
+
+#elif (ECC_CURVE == secp192r1)
+    /* p-2 = 1{127} 0 1{62} 0 1 */
+    ECC_TEMP(uint8_t, x6, d2.modInvFast[5]);
+    ECC_TEMP(uint8_t, x62, d2.modInvFast[6]);
+
+    vli_modSquareMult_fast(x6, x3, 3, x3);
+    vli_modSquareMult_fast(t1, x6, 6, x6);       /* x12 */
+    vli_modSquareMult_fast(t2, t1, 12, t1);      /* x24 */
+    vli_modSquareMult_fast(t2, t2, 6, x6);       /* x30 */
+    vli_modSquareMult_fast(t2, t2, 1, x1);       /* x31 */
+    vli_modSquareMult_fast(x62, t2, 31, t2);
+    vli_modSquareMult_fast(t1, x62, 62, x62);    /* x124 */
+    vli_modSquareMult_fast(t1, t1, 3, x3);       /* x127 */
+
+    vli_modSquareMult_fast(t1, t1, 1, NULL);
+    vli_modSquareMult_fast(t1, t1, 62, x62);
+    vli_modSquareMult_fast(p_result, t1, 2, x1);
+
+#elif (ECC_CURVE == secp256r1)
+    /* p-2 = 1{32} 0{31} 1 0{96} 1{94} 0 1 */
+    ECC_TEMP(uint8_t, x32, d2.modInvFast[5]);
+
+    vli_modSquareMult_fast(t1, x3, 3, x3);       /* x6 */
+    vli_modSquareMult_fast(t2, t1, 6, t1);       /* x12 */
+    vli_modSquareMult_fast(t1, t2, 3, x3);       /* x15 */
+    vli_modSquareMult_fast(t2, t1, 15, t1);      /* x30 */
+    vli_modSquareMult_fast(x32, t2, 2, x2);
+    vli_modSquareMult_fast(t1, x32, 30, t2);     /* x62 */
+    vli_modSquareMult_fast(t2, t1, 32, x32);     /* x94 */
+
+    vli_modSquareMult_fast(t1, x32, 32, x1);
+    vli_modSquareMult_fast(t1, t1, 96, NULL);
+    vli_modSquareMult_fast(t1, t1, 94, t2);
+    vli_modSquareMult_fast(p_result, t1, 2, x1);
+
+#elif (ECC_CURVE == secp384r1)
+    /* p-2 = 1{255} 0 1{32} 0{64} 1{30} 0 1 */
+    ECC_TEMP(uint8_t, x15, d2.modInvFast[5]);
+    ECC_TEMP(uint8_t, x30, d2.modInvFast[6]);
+    ECC_TEMP(uint8_t, x32, d2.modInvFast[7]);
+
+    vli_modSquareMult_fast(t1, x3, 3, x3);       /* x6 */
+    vli_modSquareMult_fast(t2, t1, 6, t1);       /* x12 */
+    vli_modSquareMult_fast(x15, t2, 3, x3);
+    vli_modSquareMult_fast(x30, x15, 15, x15);
+    vli_modSquareMult_fast(x32, x30, 2, x2);
+    vli_modSquareMult_fast(t1, x30, 30, x30);    /* x60 */
+    vli_modSquareMult_fast(t2, t1, 60, t1);      /* x120 */
+    vli_modSquareMult_fast(t1, t2, 120, t2);     /* x240 */
+    vli_modSquareMult_fast(t1, t1, 15, x15);     /* x255 */
+
+    vli_modSquareMult_fast(t1, t1, 1, NULL);
+    vli_modSquareMult_fast(t1, t1, 32, x32);
+    vli_modSquareMult_fast(t1, t1, 64, NULL);
+    vli_modSquareMult_fast(t1, t1, 30, x30);
+    vli_modSquareMult_fast(p_result, t1, 2, x1);
+
+#elif (ECC_CURVE == curve25519)
+    /* p-2 = 1{250} 0 1 0 1 1 */
+    ECC_TEMP(uint8_t, x5, d2.modInvFast[5]);
+    ECC_TEMP(uint8_t, x10, d2.modInvFast[6]);
+    ECC_TEMP(uint8_t, x50, d2.modInvFast[7]);
+
+    vli_modSquareMult_fast(x5, x3, 2, x2);
+    vli_modSquareMult_fast(x10, x5, 5, x5);
+    vli_modSquareMult_fast(t1, x10, 10, x10);    /* x20 */
+    vli_modSquareMult_fast(t2, t1, 20, t1);      /* x40 */
+    vli_modSquareMult_fast(x50, t2, 10, x10);
+    vli_modSquareMult_fast(t1, x50, 50, x50);    /* x100 */
+    vli_modSquareMult_fast(t2, t1, 100, t1);     /* x200 */
+    vli_modSquareMult_fast(t1, t2, 50, x50);     /* x250 */
+
+    vli_modSquareMult_fast(t1, t1, 2, x1);
+    vli_modSquareMult_fast(p_result, t1, 3, x2);
+
+#elif (ECC_CURVE == sect163k1)
+    /* 2^163 - 2 = 1{162} 0, where every power is a squaring (Itoh-Tsujii) */
+    vli_modSquareMult_fast(t1, x3, 2, x2);       /* x5 */
+    vli_modSquareMult_fast(t2, t1, 5, t1);       /* x10 */
+    vli_modSquareMult_fast(t1, t2, 10, t2);      /* x20 */
+    vli_modSquareMult_fast(t2, t1, 20, t1);      /* x40 */
+    vli_modSquareMult_fast(t1, t2, 40, t2);      /* x80 */
+    vli_modSquareMult_fast(t1, t1, 1, x1);       /* x81 */
+    vli_modSquareMult_fast(t2, t1, 81, t1);      /* x162 */
+
+    vli_modSquareMult_fast(p_result, t2, 1, NULL);
+
+#endif
+}
+
+#else /* ECC_FERMAT_INV */
+
+#define vli_modInv_fast(result, input) vli_modInv((result), (input), curve_p)
+
+#endif /* ECC_FERMAT_INV */
+
 /* ------ Point operations ------ */
 
 /* Returns 1 if p_point is the point at infinity, 0 otherwise. */
@@ -972,114 +1581,568 @@ int EccPoint_isZero(EccPoint *p_point)
     return (vli_isZero(p_point->x) && vli_isZero(p_point->y));
 }
 
-/* Point multiplication algorithm using Montgomery's ladder with co-Z coordinates.
-From http://eprint.iacr.org/2011/338.pdf
+#if (ECC_CURVE == sect163k1)
+
+/* Point multiplication on sect163k1 with the tau-adic NAF (Solinas; Hankerson, Menezes, Vanstone, "Guide to Elliptic
+Curve Cryptography", section 3.4). The Frobenius map tau(x, y) = (x^2, y^2) of a Koblitz curve satisfies
+tau^2 = tau - 2, so a scalar written as sum u_i*tau^i, u_i in {-1, 0, 1}, needs no doublings at all:
+k*P = sum u_i*tau^i(P). The scalar is first reduced mod delta = (tau^163 - 1)/(tau - 1), whose norm is n, which
+leaves about 164 digits, a third of them non-zero. The digits come out least significant first, so the sum runs
+right to left: tau^i(P) is kept affine (two squarings per digit) and added into a Lopez-Dahab accumulator
+(x = X/Z, y = Y/Z^2) with one mixed addition per non-zero digit.
+delta*P is only the point at infinity for P of order n, so a point of order 2n, such as (0, 1), can come out
+off by the point of order 2.
 */
 
-/* Double in place */
-void EccPoint_double_jacobian(uint8_t *X1, uint8_t *Y1, uint8_t *Z1)
-{
-    /* t1 = X, t2 = Y, t3 = Z */
-    uint8_t t4[NUM_ECC_DIGITS];
-    uint8_t t5[NUM_ECC_DIGITS];
-
-    if(vli_isZero(Z1))
-    {
-        return;
-    }
-
-    vli_modSquare_fast(t4, Y1);   /* t4 = y1^2 */
-    vli_modMult_fast(t5, X1, t4); /* t5 = x1*y1^2 = A */
-    vli_modSquare_fast(t4, t4);   /* t4 = y1^4 */
-    vli_modMult_fast(Y1, Y1, Z1); /* t2 = y1*z1 = z3 */
-    vli_modSquare_fast(Z1, Z1);   /* t3 = z1^2 */
+/* The integers below are two's complement, TNAF_DIGITS bytes. delta = d0 + d1*tau, s0 = d0 + d1, and g0, g1 are
+   s0/n and d1/n scaled by 2^176: k*g0 >> 168 is k*s0/n with 8 fraction bits. */
 
-    vli_modAdd(X1, X1, Z1, curve_p); /* t1 = x1 + z1^2 */
-    vli_modAdd(Z1, Z1, Z1, curve_p); /* t3 = 2*z1^2 */
-    vli_modSub(Z1, X1, Z1, curve_p); /* t3 = x1 - z1^2 */
-    vli_modMult_fast(X1, X1, Z1);    /* t1 = x1^2 - z1^4 */
+static const uint8_t tnaf_d0[TNAF_DIGITS] = {0x77, 0xA0, 0xAC, 0x33, 0x2A, 0xA8, 0xFB, 0xAA, 0x40, 0x82, 0x01};
+static const uint8_t tnaf_d1[TNAF_DIGITS] = {0xDA, 0x2A, 0x11, 0x40, 0xFC, 0x7B, 0xB1, 0x26, 0xF4, 0x9F};
+static const uint8_t tnaf_s0[TNAF_DIGITS] = {0x51, 0xCB, 0xBD, 0x73, 0x26, 0x24, 0xAD, 0xD1, 0x34, 0x22, 0x02};
+static const uint8_t tnaf_g0[TNAF_DIGITS] = {0x96, 0xFB, 0xD3, 0x72, 0xEF, 0x9C, 0x09, 0x49, 0x6B, 0x34, 0x8D, 0x88};
+static const uint8_t tnaf_g1[TNAF_DIGITS] = {0xF7, 0x6B, 0xB6, 0x4A, 0x04, 0x10, 0xFF, 0x5E, 0xAC, 0x09, 0xFD, 0x27};
 
-    vli_modAdd(Z1, X1, X1, curve_p); /* t3 = 2*(x1^2 - z1^4) */
-    vli_modAdd(X1, X1, Z1, curve_p); /* t1 = 3*(x1^2 - z1^4) */
-    if(vli_testBit(X1, 0))
+/* Computes p_result = p_left + p_right. Can modify in place. */
+static void tnaf_add(uint8_t *p_result, const uint8_t *p_left, const uint8_t *p_right)
+{
+    uint16_t l_sum = 0;
+    uint i;
+    for(i = 0; i < TNAF_DIGITS; ++i)
     {
-        uint8_t l_carry = vli_add(X1, X1, curve_p);
-        vli_rshift1(X1);
-        X1[NUM_ECC_DIGITS-1] |= l_carry << 7;
+        l_sum += (uint16_t)p_left[i] + p_right[i];
+        p_result[i] = (uint8_t)l_sum;
+        l_sum >>= 8;
     }
-    else
+}
+
+/* Computes p_result = p_left - p_right. Can modify in place. */
+static void tnaf_sub(uint8_t *p_result, const uint8_t *p_left, const uint8_t *p_right)
+{
+    uint8_t l_borrow = 0;
+    uint i;
+    for(i = 0; i < TNAF_DIGITS; ++i)
     {
-        vli_rshift1(X1);
+        uint16_t l_diff = (uint16_t)p_left[i] - p_right[i] - l_borrow;
+        p_result[i] = (uint8_t)l_diff;
+        l_borrow = (l_diff >> 8) & 1;
     }
-                     /* t1 = 3/2*(x1^2 - z1^4) = B */
-
-    vli_modSquare_fast(Z1, X1);      /* t3 = B^2 */
-    vli_modSub(Z1, Z1, t5, curve_p); /* t3 = B^2 - A */
-    vli_modSub(Z1, Z1, t5, curve_p); /* t3 = B^2 - 2A = x3 */
-    vli_modSub(t5, t5, Z1, curve_p); /* t5 = A - x3 */
-    vli_modMult_fast(X1, X1, t5);    /* t1 = B * (A - x3) */
-    vli_modSub(t4, X1, t4, curve_p); /* t4 = B * (A - x3) - y1^4 = y3 */
-
-    vli_set(X1, Z1);
-    vli_set(Z1, Y1);
-    vli_set(Y1, t4);
 }
 
-/* Modify (x1, y1) => (x1 * z^2, y1 * z^3) */
-void apply_z(uint8_t *X1, uint8_t *Y1, uint8_t *Z)
+/* Computes p_vli += p_value, -256 <= p_value < 256. */
+static void tnaf_addInt(uint8_t *p_vli, int p_value)
 {
-    uint8_t t1[NUM_ECC_DIGITS];
+    uint8_t l_value[TNAF_DIGITS];
 
-    vli_modSquare_fast(t1, Z);    /* z^2 */
-    vli_modMult_fast(X1, X1, t1); /* x1 * z^2 */
-    vli_modMult_fast(t1, t1, Z);  /* z^3 */
-    vli_modMult_fast(Y1, Y1, t1); /* y1 * z^3 */
+    memset(l_value, -(p_value < 0) & 0xFF, TNAF_DIGITS);
+    l_value[0] = (uint8_t)p_value;
+    tnaf_add(p_vli, p_vli, l_value);
 }
 
-/* P = (x1, y1) => 2P, (x2, y2) => P' */
-static void XYcZ_initial_double(uint8_t *X1, uint8_t *Y1, uint8_t *X2, uint8_t *Y2, uint8_t *p_initialZ)
+/* Computes p_vli = floor(p_vli / 2). */
+static void tnaf_rshift1(uint8_t *p_vli)
 {
-    uint8_t z[NUM_ECC_DIGITS];
-
-    vli_set(X2, X1);
-    vli_set(Y2, Y1);
-
-    vli_clear(z);
-    z[0] = 1;
-    if(p_initialZ)
+    uint i;
+    for(i = 0; i < TNAF_DIGITS - 1; ++i)
     {
-        vli_set(z, p_initialZ);
+        p_vli[i] = (p_vli[i] >> 1) | (uint8_t)(p_vli[i + 1] << 7);
     }
-    apply_z(X1, Y1, z);
+    p_vli[TNAF_DIGITS - 1] = (p_vli[TNAF_DIGITS - 1] >> 1) | (p_vli[TNAF_DIGITS - 1] & 0x80);
+}
 
-    EccPoint_double_jacobian(X1, Y1, z);
+/* Computes the low p_resultLen bytes of p_left * p_right (p_leftLen and p_rightLen bytes, unsigned), which is
+   also the two's complement product when all three lengths are TNAF_DIGITS. p_result must not overlap the inputs. */
+static void tnaf_mult(uint8_t *p_result, uint p_resultLen, const uint8_t *p_left, uint p_leftLen,
+    const uint8_t *p_right, uint p_rightLen)
+{
+    uint16_t l_acc;
+    uint i, j;
 
-    apply_z(X2, Y2, z);
+    memset(p_result, 0, p_resultLen);
+    for(i = 0; i < p_leftLen && i < p_resultLen; ++i)
+    {
+        l_acc = 0;
+        for(j = 0; j < p_rightLen && i + j < p_resultLen; ++j)
+        {
+            l_acc += (uint16_t)p_left[i] * p_right[j] + p_result[i + j];
+            p_result[i + j] = (uint8_t)l_acc;
+            l_acc >>= 8;
+        }
+        if(i + j < p_resultLen)
+        {
+            p_result[i + j] = (uint8_t)l_acc;
+        }
+    }
 }
 
-/* Input P = (x1, y1, Z), Q = (x2, y2, Z)
-   Output P' = (x1', y1', Z3), P + Q = (x3, y3, Z3)
-   or P => P', Q => P + Q
-*/
-void XYcZ_add(uint8_t *X1, uint8_t *Y1, uint8_t *X2, uint8_t *Y2)
+/* Computes r0 + r1*tau = p_scalar partmod delta (Guide to ECC, Algorithms 3.62 and 3.63 with mu = 1): p_scalar minus
+   the multiple q*delta closest to it, where q = (q0 + q1*tau) is p_scalar/delta = p_scalar*(s0 - d1*tau)/n rounded
+   in Z[tau]. */
+static void tnaf_reduce(uint8_t *r0, uint8_t *r1, uint8_t *p_scalar)
 {
-    /* t1 = X1, t2 = Y1, t3 = X2, t4 = Y2 */
-    uint8_t t5[NUM_ECC_DIGITS];
+    ECC_TEMP(uint8_t, l_wide, d1.tnafReduce.wide);
+    ECC_TEMP(uint8_t, q0, d1.tnafReduce.q0);
+    ECC_TEMP(uint8_t, q1, d1.tnafReduce.q1);
+    ECC_TEMP(uint8_t, t, d1.tnafReduce.t);
+    int e0, e1, eta;
+    int h0 = 0, h1 = 0;
+    uint i;
 
-    vli_modSub(t5, X2, X1, curve_p); /* t5 = x2 - x1 */
-    vli_modSquare_fast(t5, t5);      /* t5 = (x2 - x1)^2 = A */
-    vli_modMult_fast(X1, X1, t5);    /* t1 = x1*A = B */
-    vli_modMult_fast(X2, X2, t5);    /* t3 = x2*A = C */
-    vli_modSub(Y2, Y2, Y1, curve_p); /* t4 = y2 - y1 */
-    vli_modSquare_fast(t5, Y2);      /* t5 = (y2 - y1)^2 = D */
+    /* q0 = k*s0/n, q1 = -k*d1/n, with 8 fraction bits */
+    tnaf_mult(l_wide, NUM_ECC_DIGITS + TNAF_DIGITS, p_scalar, NUM_ECC_DIGITS, tnaf_g0, TNAF_DIGITS);
+    memcpy(q0, l_wide + NUM_ECC_DIGITS, TNAF_DIGITS);
+    tnaf_mult(l_wide, NUM_ECC_DIGITS + TNAF_DIGITS, p_scalar, NUM_ECC_DIGITS, tnaf_g1, TNAF_DIGITS);
+    memset(t, 0, TNAF_DIGITS);
+    tnaf_sub(q1, t, l_wide + NUM_ECC_DIGITS);
+
+    /* Round both to the nearest integer; e0 and e1 are what that took off, in 1/256. */
+    tnaf_addInt(q0, 128);
+    tnaf_addInt(q1, 128);
+    e0 = (int)q0[0] - 128;
+    e1 = (int)q1[0] - 128;
+    for(i = 0; i < 8; ++i)
+    {
+        tnaf_rshift1(q0);
+        tnaf_rshift1(q1);
+    }
+
+    /* Move to a neighbour if that is closer in the norm of Z[tau]. */
+    eta = 2 * e0 + e1;
+    if(eta >= 256)
+    {
+        if(e0 - 3 * e1 < -256)
+        {
+            h1 = 1;
+        }
+        else
+        {
+            h0 = 1;
+        }
+    }
+    else if(e0 + 4 * e1 >= 512)
+    {
+        h1 = 1;
+    }
+    if(eta < -256)
+    {
+        if(e0 - 3 * e1 >= 256)
+        {
+            h1 = -1;
+        }
+        else
+        {
+            h0 = -1;
+        }
+    }
+    else if(e0 + 4 * e1 < -512)
+    {
+        h1 = -1;
+    }
+    tnaf_addInt(q0, h0);
+    tnaf_addInt(q1, h1);
+
+    /* r0 = k - d0*q0 + 2*d1*q1, r1 = -d1*q0 - s0*q1 */
+    memset(r0, 0, TNAF_DIGITS);
+    vli_set(r0, p_scalar);
+    tnaf_mult(t, TNAF_DIGITS, tnaf_d0, TNAF_DIGITS, q0, TNAF_DIGITS);
+    tnaf_sub(r0, r0, t);
+    tnaf_mult(t, TNAF_DIGITS, tnaf_d1, TNAF_DIGITS, q1, TNAF_DIGITS);
+    tnaf_add(r0, r0, t);
+    tnaf_add(r0, r0, t);
+
+    memset(r1, 0, TNAF_DIGITS);
+    tnaf_mult(t, TNAF_DIGITS, tnaf_d1, TNAF_DIGITS, q0, TNAF_DIGITS);
+    tnaf_sub(r1, r1, t);
+    tnaf_mult(t, TNAF_DIGITS, tnaf_s0, TNAF_DIGITS, q1, TNAF_DIGITS);
+    tnaf_sub(r1, r1, t);
+}
+
+/* Returns the next digit u of the tau-adic NAF of r0 + r1*tau (Guide to ECC, Algorithm 3.61 with mu = 1) and
+   replaces r0 + r1*tau by (r0 + r1*tau - u)/tau = (r1 + (r0 - u)/2) - (r0 - u)/2 * tau. */
+static int tnaf_next(uint8_t *r0, uint8_t *r1)
+{
+    uint8_t l_half[TNAF_DIGITS];
+    int u;
+
+    /* 0 for an even r0, else 2 - ((r0 - 2*r1) mod 4), i.e. 1 or -1, without a branch on the scalar. */
+    u = (int)(r0[0] & 1) * (2 - (int)(((uint)r0[0] - 2 * (uint)r1[0]) & 3));
+    tnaf_addInt(r0, -u);
+
+    memcpy(l_half, r0, TNAF_DIGITS);
+    tnaf_rshift1(l_half);
+    tnaf_add(r0, r1, l_half);
+    memset(r1, 0, TNAF_DIGITS);
+    tnaf_sub(r1, r1, l_half);
+    return u;
+}
+
+#if ECC_FIXED_TABLE
+/* Doubles the Lopez-Dahab point (X1, Y1, Z1) in place, for a = b = 1:
+   Z3 = X1^2*Z1^2, X3 = X1^4 + Z1^4, Y3 = Z1^4*Z3 + X3*(Z3 + Y1^2 + Z1^4). */
+static void EccPoint_double_ld(uint8_t *X1, uint8_t *Y1, uint8_t *Z1)
+{
+    ECC_TEMP(uint8_t, t1, d2.point[0]);
+    ECC_TEMP(uint8_t, t2, d2.point[1]);
+    ECC_STAT(pointDouble);
+
+    vli_modSquare_fast(t1, Z1);   /* t1 = z1^2 */
+    vli_modSquare_fast(t2, X1);   /* t2 = x1^2 */
+    vli_modMult_fast(Z1, t1, t2); /* z3 = x1^2*z1^2 */
+    vli_modSquare_fast(t1, t1);   /* t1 = z1^4 */
+    vli_modSquare_fast(t2, t2);   /* t2 = x1^4 */
+    vli_xor(X1, t2, t1);          /* x3 = x1^4 + z1^4 */
+    vli_modSquare_fast(Y1, Y1);   /* y1 = y1^2 */
+    vli_xor(Y1, Y1, Z1);
+    vli_xor(Y1, Y1, t1);          /* y1 = z3 + y1^2 + z1^4 */
+    vli_modMult_fast(Y1, Y1, X1);
+    vli_modMult_fast(t1, t1, Z1); /* t1 = z1^4*z3 */
+    vli_xor(Y1, Y1, t1);          /* y3 */
+}
+
+#endif
+
+/* Modify (x1, y1) => (x1 * z, y1 * z^2): with z = 1/Z, the Lopez-Dahab point (X, Y, Z) back to affine. */
+void apply_z(uint8_t *X1, uint8_t *Y1, uint8_t *Z)
+{
+    ECC_TEMP(uint8_t, t1, d2.point[0]);
+
+    vli_modMult_fast(X1, X1, Z);  /* x1 * z */
+    vli_modSquare_fast(t1, Z);    /* z^2 */
+    vli_modMult_fast(Y1, Y1, t1); /* y1 * z^2 */
+}
+
+#if ECC_FIXED_TABLE
+/* Adds the affine point (x2, y2) to the Lopez-Dahab point (X1, Y1, Z1) in place (Guide to ECC, Algorithm 3.25 with
+   a = 1). Z1 = 0 stands for the point at infinity. Only the generator table uses it; EccPoint_tnaf_add() runs
+   EccPoint_add_mixed_regular(). */
+static void EccPoint_add_mixed(uint8_t *X1, uint8_t *Y1, uint8_t *Z1, uint8_t *x2, uint8_t *y2)
+{
+    ECC_TEMP(uint8_t, t1, d3.addMixed[0]);
+    ECC_TEMP(uint8_t, t2, d3.addMixed[1]);
+    ECC_TEMP(uint8_t, t3, d3.addMixed[2]);
+    ECC_STAT(pointAdd);
+
+    if(vli_isZero(Z1))
+    {
+        vli_set(X1, x2);
+        vli_set(Y1, y2);
+        Z1[0] = 1;
+        return;
+    }
+
+    vli_modMult_fast(t1, Z1, x2); /* t1 = z1*x2 */
+    vli_modSquare_fast(t2, Z1);   /* t2 = z1^2 */
+    vli_xor(X1, X1, t1);          /* x1 = x1 + z1*x2 = B */
+    vli_modMult_fast(t1, Z1, X1); /* t1 = z1*B = C */
+    vli_modMult_fast(t3, t2, y2); /* t3 = z1^2*y2 */
+    vli_xor(Y1, Y1, t3);          /* y1 = y1 + z1^2*y2 = A */
+
+    if(vli_isZero(X1))
+    {
+        if(!vli_isZero(Y1))
+        {
+            vli_clear(Z1); /* P + (-P) */
+            return;
+        }
+        vli_set(X1, x2);
+        vli_set(Y1, y2);
+        vli_clear(Z1);
+        Z1[0] = 1;
+        EccPoint_double_ld(X1, Y1, Z1);
+        return;
+    }
+
+    vli_modSquare_fast(Z1, t1);   /* z3 = C^2 */
+    vli_modMult_fast(t3, t1, Y1); /* t3 = C*A = E */
+    vli_xor(t1, t1, t2);          /* t1 = C + a*z1^2 */
+    vli_modSquare_fast(t2, X1);   /* t2 = B^2 */
+    vli_modMult_fast(X1, t2, t1); /* x1 = B^2*(C + a*z1^2) */
+    vli_modSquare_fast(t2, Y1);   /* t2 = A^2 */
+    vli_xor(X1, X1, t2);
+    vli_xor(X1, X1, t3);          /* x3 = A^2 + E + B^2*(C + a*z1^2) */
+    vli_modMult_fast(t2, x2, Z1);
+    vli_xor(t2, t2, X1);          /* t2 = x3 + x2*z3 = F */
+    vli_modSquare_fast(t1, Z1);   /* t1 = z3^2 */
+    vli_xor(t3, t3, Z1);          /* t3 = E + z3 */
+    vli_modMult_fast(Y1, t3, t2); /* y1 = (E + z3)*F */
+    vli_xor(t2, x2, y2);
+    vli_modMult_fast(t3, t1, t2); /* t3 = (x2 + y2)*z3^2 = G */
+    vli_xor(Y1, Y1, t3);          /* y3 = (E + z3)*F + G */
+}
+
+#endif /* ECC_FIXED_TABLE */
+
+/* EccPoint_add_mixed() without its tests for the point at infinity and for P + P, so that it runs the same
+   field operations whatever the points. The result is meaningless when Z1 = 0 or (x2, y2) = +-(X1/Z1, Y1/Z1^2);
+   EccPoint_tnaf_add() handles the first case and the second has negligible probability for its scalars. */
+static void EccPoint_add_mixed_regular(uint8_t *X1, uint8_t *Y1, uint8_t *Z1, uint8_t *x2, uint8_t *y2)
+{
+    ECC_TEMP(uint8_t, t1, d3.addMixed[0]);
+    ECC_TEMP(uint8_t, t2, d3.addMixed[1]);
+    ECC_TEMP(uint8_t, t3, d3.addMixed[2]);
+    ECC_STAT(pointAdd);
+
+    vli_modMult_fast(t1, Z1, x2); /* t1 = z1*x2 */
+    vli_modSquare_fast(t2, Z1);   /* t2 = z1^2 */
+    vli_xor(X1, X1, t1);          /* x1 = x1 + z1*x2 = B */
+    vli_modMult_fast(t1, Z1, X1); /* t1 = z1*B = C */
+    vli_modMult_fast(t3, t2, y2); /* t3 = z1^2*y2 */
+    vli_xor(Y1, Y1, t3);          /* y1 = y1 + z1^2*y2 = A */
+    vli_modSquare_fast(Z1, t1);   /* z3 = C^2 */
+    vli_modMult_fast(t3, t1, Y1); /* t3 = C*A = E */
+    vli_xor(t1, t1, t2);          /* t1 = C + a*z1^2 */
+    vli_modSquare_fast(t2, X1);   /* t2 = B^2 */
+    vli_modMult_fast(X1, t2, t1); /* x1 = B^2*(C + a*z1^2) */
+    vli_modSquare_fast(t2, Y1);   /* t2 = A^2 */
+    vli_xor(X1, X1, t2);
+    vli_xor(X1, X1, t3);          /* x3 = A^2 + E + B^2*(C + a*z1^2) */
+    vli_modMult_fast(t2, x2, Z1);
+    vli_xor(t2, t2, X1);          /* t2 = x3 + x2*z3 = F */
+    vli_modSquare_fast(t1, Z1);   /* t1 = z3^2 */
+    vli_xor(t3, t3, Z1);          /* t3 = E + z3 */
+    vli_modMult_fast(Y1, t3, t2); /* y1 = (E + z3)*F */
+    vli_xor(t2, x2, y2);
+    vli_modMult_fast(t3, t1, t2); /* t3 = (x2 + y2)*z3^2 = G */
+    vli_xor(Y1, Y1, t3);          /* y3 = (E + z3)*F + G */
+}
+
+/* Adds p_scalar * p_point to the Lopez-Dahab point (X, Y, Z). Every one of the TNAF_LENGTH digits costs one
+   mixed addition of P, -P or (for a zero digit) P into a copy that is then dropped, and the digit only picks
+   values through masks, so the time and the memory accesses do not depend on the scalar. The sum stays the
+   point at infinity, Z = 0, until the first non-zero digit, which then gives (x, y, 1) instead. */
+static void EccPoint_tnaf_add(uint8_t *X, uint8_t *Y, uint8_t *Z, EccPoint *p_point, uint8_t *p_scalar)
+{
+    ECC_TEMP(uint8_t, r0, d4.tnafAdd.r0);
+    ECC_TEMP(uint8_t, r1, d4.tnafAdd.r1);
+    ECC_TEMP(uint8_t, x, d4.tnafAdd.xy[0]);
+    ECC_TEMP(uint8_t, y, d4.tnafAdd.xy[1]);
+    ECC_TEMP(uint8_t, l_y, d4.tnafAdd.xy[2]);
+    ECC_TEMP(uint8_t, l_X, d4.tnafAdd.sum[0]);
+    ECC_TEMP(uint8_t, l_Y, d4.tnafAdd.sum[1]);
+    ECC_TEMP(uint8_t, l_Z, d4.tnafAdd.sum[2]);
+    uint8_t l_infinity, l_nonzero;
+    uint i, j;
+    int u;
+
+    tnaf_reduce(r0, r1, p_scalar);
+    vli_set(x, p_point->x);
+    vli_set(y, p_point->y);
+    l_infinity = vli_isZero(Z); /* set by the caller, not by the scalar */
+
+    for(i = 0; i < TNAF_LENGTH; ++i)
+    {
+        u = tnaf_next(r0, r1);
+        l_nonzero = (uint8_t)(u & 1);
+        vli_xor(l_y, x, y);        /* -(x, y) = (x, x + y) */
+        vli_cmov(l_y, y, ((uint8_t)(u + 1) >> 1) & 1); /* back to (x, y) if u = 1 */
+
+        vli_set(l_X, X);
+        vli_set(l_Y, Y);
+        vli_set(l_Z, Z);
+        EccPoint_add_mixed_regular(l_X, l_Y, l_Z, x, l_y);
+        vli_cmov(l_X, x, l_infinity);
+        vli_cmov(l_Y, l_y, l_infinity);
+        for(j = 0; j < NUM_ECC_DIGITS; ++j)
+        {
+            l_Z[j] &= (uint8_t)(l_infinity - 1);
+        }
+        l_Z[0] |= l_infinity;
+
+        vli_cmov(X, l_X, l_nonzero);
+        vli_cmov(Y, l_Y, l_nonzero);
+        vli_cmov(Z, l_Z, l_nonzero);
+        l_infinity &= (uint8_t)(l_nonzero ^ 1);
+
+        vli_modSquare_fast(x, x);  /* tau */
+        vli_modSquare_fast(y, y);
+    }
+}
+
+/* Computes p_scalar * p_point as the Lopez-Dahab point (X, Y, Z). The point at infinity comes out as (0, 0, 1). */
+static void EccPoint_tnaf(uint8_t *X, uint8_t *Y, uint8_t *Z, EccPoint *p_point, uint8_t *p_scalar)
+{
+    vli_clear(Z);
+    EccPoint_tnaf_add(X, Y, Z, p_point, p_scalar);
+    if(vli_isZero(Z))
+    {
+        vli_clear(X);
+        vli_clear(Y);
+        Z[0] = 1;
+    }
+}
+
+/* Completes EccPoint_tnaf(), given p_inverse = 1 / Z. */
+static void EccPoint_tnaf_finish(EccPoint *p_result, uint8_t *X, uint8_t *Y, uint8_t *p_inverse)
+{
+    apply_z(X, Y, p_inverse);
+    vli_set(p_result->x, X);
+    vli_set(p_result->y, Y);
+}
+
+#else /* ECC_CURVE == sect163k1 */
+
+/* Point multiplication algorithm using Montgomery's ladder with co-Z coordinates.
+From http://eprint.iacr.org/2011/338.pdf
+*/
+
+#if (ECC_CURVE == curve25519)
+
+#if ECC_FIXED_TABLE
+/* Double in place, on the short Weierstrass form of curve25519 where a is not -3. Only the generator table uses it.
+   M = 3*x1^2 + a*z1^4, S = 4*x1*y1^2, x3 = M^2 - 2S, y3 = M*(S - x3) - 8*y1^4, z3 = 2*y1*z1. */
+void EccPoint_double_jacobian(uint8_t *X1, uint8_t *Y1, uint8_t *Z1)
+{
+    ECC_TEMP(uint8_t, t4, d2.point[0]);
+    ECC_TEMP(uint8_t, t5, d2.point[1]);
+    ECC_TEMP(uint8_t, t6, d2.point[2]);
+    ECC_STAT(pointDouble);
+
+    if(vli_isZero(Z1))
+    {
+        return;
+    }
+
+    vli_modSquare_fast(t4, Z1);      /* t4 = z1^2 */
+    vli_modSquare_fast(t4, t4);      /* t4 = z1^4 */
+    vli_modMult_fast(t4, t4, curve_wa); /* t4 = a*z1^4 */
+    vli_modSquare_fast(t5, X1);      /* t5 = x1^2 */
+    vli_modAdd_fast(t4, t4, t5);
+    vli_modAdd_fast(t5, t5, t5);
+    vli_modAdd_fast(t4, t4, t5);     /* t4 = 3*x1^2 + a*z1^4 = M */
+
+    vli_modMult_fast(Z1, Z1, Y1);    /* t3 = y1*z1 */
+    vli_modAdd_fast(Z1, Z1, Z1);     /* t3 = 2*y1*z1 = z3 */
+    vli_modSquare_fast(Y1, Y1);      /* t2 = y1^2 */
+    vli_modMult_fast(t5, X1, Y1);    /* t5 = x1*y1^2 */
+    vli_modAdd_fast(t5, t5, t5);
+    vli_modAdd_fast(t5, t5, t5);     /* t5 = 4*x1*y1^2 = S */
+    vli_modSquare_fast(Y1, Y1);      /* t2 = y1^4 */
+
+    vli_modSquare_fast(X1, t4);      /* t1 = M^2 */
+    vli_modSub_fast(X1, X1, t5);
+    vli_modSub_fast(X1, X1, t5);     /* t1 = M^2 - 2S = x3 */
+    vli_modSub_fast(t6, t5, X1);     /* t6 = S - x3 */
+    vli_modMult_fast(t6, t6, t4);    /* t6 = M*(S - x3) */
+    vli_modAdd_fast(Y1, Y1, Y1);
+    vli_modAdd_fast(Y1, Y1, Y1);
+    vli_modAdd_fast(Y1, Y1, Y1);     /* t2 = 8*y1^4 */
+    vli_modSub_fast(Y1, t6, Y1);     /* t2 = y3 */
+}
+#endif /* ECC_FIXED_TABLE */
+
+#else
+
+/* Double in place */
+void EccPoint_double_jacobian(uint8_t *X1, uint8_t *Y1, uint8_t *Z1)
+{
+    /* t1 = X, t2 = Y, t3 = Z */
+    ECC_TEMP(uint8_t, t4, d2.point[0]);
+    ECC_TEMP(uint8_t, t5, d2.point[1]);
+    ECC_STAT(pointDouble);
+
+    if(vli_isZero(Z1))
+    {
+        return;
+    }
+
+    vli_modSquare_fast(t4, Y1);   /* t4 = y1^2 */
+    vli_modMult_fast(t5, X1, t4); /* t5 = x1*y1^2 = A */
+    vli_modSquare_fast(t4, t4);   /* t4 = y1^4 */
+    vli_modMult_fast(Y1, Y1, Z1); /* t2 = y1*z1 = z3 */
+    vli_modSquare_fast(Z1, Z1);   /* t3 = z1^2 */
+
+    vli_modAdd_fast(X1, X1, Z1); /* t1 = x1 + z1^2 */
+    vli_modAdd_fast(Z1, Z1, Z1); /* t3 = 2*z1^2 */
+    vli_modSub_fast(Z1, X1, Z1); /* t3 = x1 - z1^2 */
+    vli_modMult_fast(X1, X1, Z1);    /* t1 = x1^2 - z1^4 */
+
+    vli_modAdd_fast(Z1, X1, X1); /* t3 = 2*(x1^2 - z1^4) */
+    vli_modAdd_fast(X1, X1, Z1); /* t1 = 3*(x1^2 - z1^4) */
+    if(vli_testBit(X1, 0))
+    {
+        uint8_t l_carry = vli_add(X1, X1, curve_p);
+        vli_rshift1(X1);
+        X1[NUM_ECC_DIGITS-1] |= l_carry << 7;
+    }
+    else
+    {
+        vli_rshift1(X1);
+    }
+                     /* t1 = 3/2*(x1^2 - z1^4) = B */
+
+    vli_modSquare_fast(Z1, X1);      /* t3 = B^2 */
+    vli_modSub_fast(Z1, Z1, t5); /* t3 = B^2 - A */
+    vli_modSub_fast(Z1, Z1, t5); /* t3 = B^2 - 2A = x3 */
+    vli_modSub_fast(t5, t5, Z1); /* t5 = A - x3 */
+    vli_modMult_fast(X1, X1, t5);    /* t1 = B * (A - x3) */
+    vli_modSub_fast(t4, X1, t4); /* t4 = B * (A - x3) - y1^4 = y3 */
+
+    vli_set(X1, Z1);
+    vli_set(Z1, Y1);
+    vli_set(Y1, t4);
+}
+
+#endif /* ECC_CURVE == curve25519 */
+
+/* Modify (x1, y1) => (x1 * z^2, y1 * z^3) */
+void apply_z(uint8_t *X1, uint8_t *Y1, uint8_t *Z)
+{
+    ECC_TEMP(uint8_t, t1, d2.point[0]);
 
-    vli_modSub(t5, t5, X1, curve_p); /* t5 = D - B */
-    vli_modSub(t5, t5, X2, curve_p); /* t5 = D - B - C = x3 */
-    vli_modSub(X2, X2, X1, curve_p); /* t3 = C - B */
+    vli_modSquare_fast(t1, Z);    /* z^2 */
+    vli_modMult_fast(X1, X1, t1); /* x1 * z^2 */
+    vli_modMult_fast(t1, t1, Z);  /* z^3 */
+    vli_modMult_fast(Y1, Y1, t1); /* y1 * z^3 */
+}
+
+#if (ECC_CURVE != curve25519)
+
+/* P = (x1, y1) => 2P, (x2, y2) => P' */
+static void XYcZ_initial_double(uint8_t *X1, uint8_t *Y1, uint8_t *X2, uint8_t *Y2, uint8_t *p_initialZ)
+{
+    ECC_TEMP(uint8_t, z, d3.initialDouble[0]);
+    ECC_STAT(pointDouble);
+
+    vli_set(X2, X1);
+    vli_set(Y2, Y1);
+
+    vli_clear(z);
+    z[0] = 1;
+    if(p_initialZ)
+    {
+        vli_set(z, p_initialZ);
+    }
+    apply_z(X1, Y1, z);
+
+    EccPoint_double_jacobian(X1, Y1, z);
+
+    apply_z(X2, Y2, z);
+}
+
+/* Input P = (x1, y1, Z), Q = (x2, y2, Z)
+   Output P' = (x1', y1', Z3), P + Q = (x3, y3, Z3)
+   or P => P', Q => P + Q
+*/
+void XYcZ_add(uint8_t *X1, uint8_t *Y1, uint8_t *X2, uint8_t *Y2)
+{
+    /* t1 = X1, t2 = Y1, t3 = X2, t4 = Y2 */
+    ECC_TEMP(uint8_t, t5, d2.point[0]);
+    ECC_STAT(pointAdd);
+
+    vli_modSub_fast(t5, X2, X1); /* t5 = x2 - x1 */
+    vli_modSquare_fast(t5, t5);      /* t5 = (x2 - x1)^2 = A */
+    vli_modMult_fast(X1, X1, t5);    /* t1 = x1*A = B */
+    vli_modMult_fast(X2, X2, t5);    /* t3 = x2*A = C */
+    vli_modSub_fast(Y2, Y2, Y1); /* t4 = y2 - y1 */
+    vli_modSquare_fast(t5, Y2);      /* t5 = (y2 - y1)^2 = D */
+
+    vli_modSub_fast(t5, t5, X1); /* t5 = D - B */
+    vli_modSub_fast(t5, t5, X2); /* t5 = D - B - C = x3 */
+    vli_modSub_fast(X2, X2, X1); /* t3 = C - B */
     vli_modMult_fast(Y1, Y1, X2);    /* t2 = y1*(C - B) */
-    vli_modSub(X2, X1, t5, curve_p); /* t3 = B - x3 */
+    vli_modSub_fast(X2, X1, t5); /* t3 = B - x3 */
     vli_modMult_fast(Y2, Y2, X2);    /* t4 = (y2 - y1)*(B - x3) */
-    vli_modSub(Y2, Y2, Y1, curve_p); /* t4 = y3 */
+    vli_modSub_fast(Y2, Y2, Y1); /* t4 = y3 */
 
     vli_set(X2, t5);
 }
@@ -1091,47 +2154,52 @@ void XYcZ_add(uint8_t *X1, uint8_t *Y1, uint8_t *X2, uint8_t *Y2)
 void XYcZ_addC(uint8_t *X1, uint8_t *Y1, uint8_t *X2, uint8_t *Y2)
 {
     /* t1 = X1, t2 = Y1, t3 = X2, t4 = Y2 */
-    uint8_t t5[NUM_ECC_DIGITS];
-    uint8_t t6[NUM_ECC_DIGITS];
-    uint8_t t7[NUM_ECC_DIGITS];
+    ECC_TEMP(uint8_t, t5, d2.point[0]);
+    ECC_TEMP(uint8_t, t6, d2.point[1]);
+    ECC_TEMP(uint8_t, t7, d2.point[2]);
+    ECC_STAT(pointAdd);
 
-    vli_modSub(t5, X2, X1, curve_p); /* t5 = x2 - x1 */
+    vli_modSub_fast(t5, X2, X1); /* t5 = x2 - x1 */
     vli_modSquare_fast(t5, t5);      /* t5 = (x2 - x1)^2 = A */
     vli_modMult_fast(X1, X1, t5);    /* t1 = x1*A = B */
     vli_modMult_fast(X2, X2, t5);    /* t3 = x2*A = C */
-    vli_modAdd(t5, Y2, Y1, curve_p); /* t4 = y2 + y1 */
-    vli_modSub(Y2, Y2, Y1, curve_p); /* t4 = y2 - y1 */
+    vli_modAdd_fast(t5, Y2, Y1); /* t4 = y2 + y1 */
+    vli_modSub_fast(Y2, Y2, Y1); /* t4 = y2 - y1 */
 
-    vli_modSub(t6, X2, X1, curve_p); /* t6 = C - B */
+    vli_modSub_fast(t6, X2, X1); /* t6 = C - B */
     vli_modMult_fast(Y1, Y1, t6);    /* t2 = y1 * (C - B) */
-    vli_modAdd(t6, X1, X2, curve_p); /* t6 = B + C */
+    vli_modAdd_fast(t6, X1, X2); /* t6 = B + C */
     vli_modSquare_fast(X2, Y2);      /* t3 = (y2 - y1)^2 */
-    vli_modSub(X2, X2, t6, curve_p); /* t3 = x3 */
+    vli_modSub_fast(X2, X2, t6); /* t3 = x3 */
 
-    vli_modSub(t7, X1, X2, curve_p); /* t7 = B - x3 */
+    vli_modSub_fast(t7, X1, X2); /* t7 = B - x3 */
     vli_modMult_fast(Y2, Y2, t7);    /* t4 = (y2 - y1)*(B - x3) */
-    vli_modSub(Y2, Y2, Y1, curve_p); /* t4 = y3 */
+    vli_modSub_fast(Y2, Y2, Y1); /* t4 = y3 */
 
     vli_modSquare_fast(t7, t5);      /* t7 = (y2 + y1)^2 = F */
-    vli_modSub(t7, t7, t6, curve_p); /* t7 = x3' */
-    vli_modSub(t6, t7, X1, curve_p); /* t6 = x3' - B */
+    vli_modSub_fast(t7, t7, t6); /* t7 = x3' */
+    vli_modSub_fast(t6, t7, X1); /* t6 = x3' - B */
     vli_modMult_fast(t6, t6, t5);    /* t6 = (y2 + y1)*(x3' - B) */
-    vli_modSub(Y1, t6, Y1, curve_p); /* t2 = y3' */
+    vli_modSub_fast(Y1, t6, Y1); /* t2 = y3' */
 
     vli_set(X1, t7);
 }
 
-void EccPoint_mult(EccPoint *p_result, EccPoint *p_point, uint8_t *p_scalar, uint8_t *p_initialZ)
+/* Puts in p_denominator the value that must be inverted to find the final 1/Z of a ladder. */
+static void EccPoint_ladder_denominator(uint8_t *p_denominator, uint8_t Rx[2][NUM_ECC_DIGITS],
+    uint8_t Ry[2][NUM_ECC_DIGITS], EccPoint *p_point, uint nb)
 {
-/* If base point is not specified, use the defined geneartor. */
-    if (p_point == NULL)
-	p_point = &curve_G;
-
-    /* R0 and R1 */
-    uint8_t Rx[2][NUM_ECC_DIGITS];
-    uint8_t Ry[2][NUM_ECC_DIGITS];
-    uint8_t z[NUM_ECC_DIGITS];
+    vli_modSub_fast(p_denominator, Rx[1], Rx[0]); /* X1 - X0 */
+    vli_modMult_fast(p_denominator, p_denominator, Ry[1-nb]);     /* Yb * (X1 - X0) */
+    vli_modMult_fast(p_denominator, p_denominator, p_point->x);   /* xP * Yb * (X1 - X0) */
+}
 
+/* Runs the ladder for p_scalar * p_point, leaving the result in Rx[0], Ry[0] with a shared Z.
+   The value that must be inverted to recover 1/Z is put in p_denominator; returns nb,
+   which EccPoint_ladder_finish() needs. */
+static uint EccPoint_ladder(uint8_t Rx[2][NUM_ECC_DIGITS], uint8_t Ry[2][NUM_ECC_DIGITS], uint8_t *p_denominator,
+    EccPoint *p_point, uint8_t *p_scalar, uint8_t *p_initialZ)
+{
     uint i, nb;
 
     vli_set(Rx[1], p_point->x);
@@ -1149,11 +2217,16 @@ void EccPoint_mult(EccPoint *p_result, EccPoint *p_point, uint8_t *p_scalar, uin
     nb = !vli_testBit(p_scalar, 0);
     XYcZ_addC(Rx[1-nb], Ry[1-nb], Rx[nb], Ry[nb]);
 
-    /* Find final 1/Z value. */
-    vli_modSub(z, Rx[1], Rx[0], curve_p); /* X1 - X0 */
-    vli_modMult_fast(z, z, Ry[1-nb]);     /* Yb * (X1 - X0) */
-    vli_modMult_fast(z, z, p_point->x);   /* xP * Yb * (X1 - X0) */
-    vli_modInv(z, z, curve_p);            /* 1 / (xP * Yb * (X1 - X0)) */
+    EccPoint_ladder_denominator(p_denominator, Rx, Ry, p_point, nb);
+    return nb;
+}
+
+/* Completes EccPoint_ladder(), given p_inverse = 1 / p_denominator. */
+static void EccPoint_ladder_finish(EccPoint *p_result, uint8_t Rx[2][NUM_ECC_DIGITS], uint8_t Ry[2][NUM_ECC_DIGITS],
+    uint8_t *p_inverse, EccPoint *p_point, uint nb)
+{
+    uint8_t *z = p_inverse;
+
     vli_modMult_fast(z, z, p_point->y);   /* yP / (xP * Yb * (X1 - X0)) */
     vli_modMult_fast(z, z, Rx[1-nb]);     /* Xb * yP / (xP * Yb * (X1 - X0)) */
     /* End 1/Z calculation */
@@ -1166,36 +2239,662 @@ void EccPoint_mult(EccPoint *p_result, EccPoint *p_point, uint8_t *p_scalar, uin
     vli_set(p_result->y, Ry[0]);
 }
 
-int ecc_make_key(EccPoint *p_publicKey, uint8_t p_privateKey[NUM_ECC_DIGITS], uint8_t p_random[NUM_ECC_DIGITS])
+#else /* ECC_CURVE != curve25519 */
+
+/* x-only Montgomery ladder on curve25519, from RFC 7748. */
+
+/* Swaps p_left and p_right if p_swap is 1, leaves them if it is 0, with the same memory accesses either way. */
+static void vli_cswap(uint8_t *p_left, uint8_t *p_right, uint8_t p_swap)
 {
-    /* Make sure the private key is in the range [1, n-1].
-       For the supported curves, n is always large enough that we only need to subtract once at most. */
-    vli_set(p_privateKey, p_random);
-    if(vli_cmp(curve_n, p_privateKey) != 1)
+    uint8_t l_mask = -p_swap;
+    uint8_t l_diff;
+    uint i;
+
+    for(i = 0; i < NUM_ECC_DIGITS; ++i)
+    {
+        l_diff = (p_left[i] ^ p_right[i]) & l_mask;
+        p_left[i] ^= l_diff;
+        p_right[i] ^= l_diff;
+    }
+}
+
+/* Computes p_result = p_left * (A - 2)/4 % curve_p, (A - 2)/4 = 121665, in one pass instead of a full multiplication. */
+static void vli_modMult_a24(uint8_t *p_result, uint8_t *p_left)
+{
+    uint32_t l_acc = 0;
+    uint i;
+
+    for(i = 0; i < NUM_ECC_DIGITS; ++i)
+    {
+        l_acc += (uint32_t)p_left[i] * 121665;
+        p_result[i] = (uint8_t)l_acc;
+        l_acc >>= 8;
+    }
+
+    /* Fold the part above 2^256 back in as 38 times it, as in vli_mmod_fast(). */
+    while(l_acc)
+    {
+        l_acc *= 38;
+        for(i = 0; i < NUM_ECC_DIGITS; ++i)
+        {
+            l_acc += p_result[i];
+            p_result[i] = (uint8_t)l_acc;
+            l_acc >>= 8;
+        }
+    }
+
+    while(vli_cmp(p_result, curve_p) >= 0)
+    {
+        vli_sub(p_result, p_result, curve_p);
+    }
+}
+
+/* Computes p_scalar * P as X/Z from the x-coordinate p_x of P. The ladder always runs over all 8*NUM_ECC_DIGITS bits
+   of the scalar, swapping without branches. If p_initialZ is given, P starts as (p_x * Z : Z) instead of (p_x : 1).
+   The point at infinity comes out as X = 0, Z = 1, so that Z can always be inverted. */
+static void EccPoint_xladder(uint8_t *X, uint8_t *Z, uint8_t *p_x, uint8_t *p_scalar, uint8_t *p_initialZ)
+{
+    ECC_TEMP(uint8_t, x1, d2.xladder[0]);
+    ECC_TEMP(uint8_t, X3, d2.xladder[1]);
+    ECC_TEMP(uint8_t, Z3, d2.xladder[2]);
+    ECC_TEMP(uint8_t, t1, d2.xladder[3]);
+    ECC_TEMP(uint8_t, t2, d2.xladder[4]);
+    uint8_t l_swap = 0;
+    uint8_t l_bit;
+    int i;
+
+    /* A received x may be anything below 2^256. */
+    vli_set(x1, p_x);
+    while(vli_cmp(x1, curve_p) >= 0)
+    {
+        vli_sub(x1, x1, curve_p);
+    }
+
+    vli_clear(X);
+    X[0] = 1;
+    vli_clear(Z);
+    if(p_initialZ)
+    {
+        vli_modMult_fast(X3, x1, p_initialZ);
+        vli_set(Z3, p_initialZ);
+    }
+    else
+    {
+        vli_set(X3, x1);
+        vli_clear(Z3);
+        Z3[0] = 1;
+    }
+
+    for(i = NUM_ECC_DIGITS * 8 - 1; i >= 0; --i)
+    {
+        ECC_STAT(pointDouble);           /* one ladder step: x-only doubling and differential addition */
+        ECC_STAT(pointAdd);
+        l_bit = (p_scalar[i / 8] >> (i % 8)) & 1;
+        l_swap ^= l_bit;
+        vli_cswap(X, X3, l_swap);
+        vli_cswap(Z, Z3, l_swap);
+        l_swap = l_bit;
+
+        vli_modAdd_fast(t1, X, Z);       /* t1 = x2 + z2 = A */
+        vli_modSub_fast(X, X, Z);        /* x2 = x2 - z2 = B */
+        vli_modAdd_fast(Z, X3, Z3);      /* z2 = x3 + z3 = C */
+        vli_modSub_fast(X3, X3, Z3);     /* x3 = x3 - z3 = D */
+        vli_modMult_fast(Z, Z, X);       /* z2 = CB */
+        vli_modMult_fast(X3, X3, t1);    /* x3 = DA */
+        vli_modAdd_fast(Z3, X3, Z);      /* z3 = DA + CB */
+        vli_modSub_fast(Z, X3, Z);       /* z2 = DA - CB */
+        vli_modSquare_fast(X3, Z3);      /* x3 = (DA + CB)^2 */
+        vli_modSquare_fast(Z, Z);        /* z2 = (DA - CB)^2 */
+        vli_modMult_fast(Z3, Z, x1);     /* z3 = x1*(DA - CB)^2 */
+        vli_modSquare_fast(t1, t1);      /* t1 = A^2 = AA */
+        vli_modSquare_fast(X, X);        /* x2 = B^2 = BB */
+        vli_modSub_fast(t2, t1, X);      /* t2 = AA - BB = E */
+        vli_modMult_fast(X, t1, X);      /* x2 = AA*BB */
+        vli_modMult_a24(Z, t2);          /* z2 = a24*E */
+        vli_modAdd_fast(Z, Z, t1);       /* z2 = AA + a24*E */
+        vli_modMult_fast(Z, Z, t2);      /* z2 = E*(AA + a24*E) */
+    }
+    vli_cswap(X, X3, l_swap);
+    vli_cswap(Z, Z3, l_swap);
+
+    if(vli_isZero(Z))
+    {
+        vli_clear(X);
+        Z[0] = 1;
+    }
+}
+
+/* Completes EccPoint_xladder(), given p_inverse = 1 / Z. */
+static void EccPoint_xladder_finish(EccPoint *p_result, uint8_t *X, uint8_t *p_inverse)
+{
+    vli_modMult_fast(p_result->x, X, p_inverse);
+    vli_clear(p_result->y);
+}
+
+/* With u = xP*xQ, P + Q and P - Q have the x-coordinates that are the roots of
+   (xP - xQ)^2 * x^2 - 2*((u + 1)*(xP + xQ) + 2A*u) * x + (u - 1)^2. All inputs must be below p. */
+int EccPoint_isSum(uint8_t *p_x, uint8_t *p_xP, uint8_t *p_xQ)
+{
+    ECC_TEMP(uint8_t, l_one, d2.isSum[0]);
+    ECC_TEMP(uint8_t, u, d2.isSum[1]);
+    ECC_TEMP(uint8_t, t1, d2.isSum[2]);
+    ECC_TEMP(uint8_t, t2, d2.isSum[3]);
+    ECC_TEMP(uint8_t, t3, d2.isSum[4]);
+
+    vli_clear(l_one);
+    l_one[0] = 1;
+
+    vli_modMult_fast(u, p_xP, p_xQ);         /* u = xP*xQ */
+    vli_modSub(t3, u, l_one, curve_p);
+    vli_modSquare_fast(t3, t3);              /* t3 = (u - 1)^2 */
+
+    vli_modAdd(t1, u, l_one, curve_p);       /* t1 = u + 1 */
+    vli_modAdd(t2, p_xP, p_xQ, curve_p);
+    vli_modMult_fast(t1, t1, t2);            /* t1 = (u + 1)*(xP + xQ) */
+    vli_modMult_fast(u, u, curve_A);         /* u = A*u */
+    vli_modAdd(t1, t1, u, curve_p);
+    vli_modAdd(t1, t1, u, curve_p);          /* t1 = (u + 1)*(xP + xQ) + 2A*u */
+    vli_modAdd(t1, t1, t1, curve_p);
+    vli_modMult_fast(t1, t1, p_x);           /* t1 = 2*(...) * x */
+    vli_modSub(t3, t3, t1, curve_p);         /* t3 = (u - 1)^2 - 2*(...) * x */
+
+    vli_modSub(t2, p_xP, p_xQ, curve_p);
+    vli_modMult_fast(t2, t2, p_x);
+    vli_modSquare_fast(t2, t2);              /* t2 = (xP - xQ)^2 * x^2 */
+    vli_modAdd(t3, t3, t2, curve_p);
+
+    return vli_isZero(t3);
+}
+
+#endif /* ECC_CURVE != curve25519 */
+
+#endif /* ECC_CURVE == sect163k1 */
+
+#if ECC_FIXED_TABLE
+
+static ecc_table_read_fn ecc_table_read;
+
+#define ECC_TABLE_LANE ((uint)-1) /* nb of a batch lane that EccPoint_table_sum() computed */
+
+/* Puts G into p_dest as the table stores it: as is, or on the short Weierstrass form for curve25519. */
+static void EccPoint_table_G(EccPoint *p_dest)
+{
+    *p_dest = curve_G;
+#if (ECC_CURVE == curve25519)
+    vli_modAdd(p_dest->x, p_dest->x, curve_w, curve_p);
+#endif
+}
+
+int ecc_table_init(ecc_table_read_fn p_read)
+{
+    uint8_t l_header[ECC_TABLE_HEADER];
+    EccPoint l_entry, l_G;
+
+    ecc_table_read = NULL;
+    if(p_read == NULL)
+    {
+        return 0;
+    }
+
+    /* Check the header and that the first entry (1 * G) matches this curve. */
+    if(!p_read(0, l_header, ECC_TABLE_HEADER) || memcmp(l_header, "EC", 2) != 0
+        || l_header[2] != (uint8_t)ECC_CURVE || l_header[3] != (uint8_t)(ECC_CURVE >> 8))
+    {
+        return 0;
+    }
+    EccPoint_table_G(&l_G);
+    if(!p_read(ECC_TABLE_OFFSET(0, 1), (uint8_t *)&l_entry, sizeof(EccPoint))
+        || vli_cmp(l_entry.x, l_G.x) != 0 || vli_cmp(l_entry.y, l_G.y) != 0)
+    {
+        return 0;
+    }
+
+    ecc_table_read = p_read;
+    return 1;
+}
+
+#if (ECC_CURVE != sect163k1)
+
+/* Adds the affine point (x2, y2) to the Jacobian point (X1, Y1, Z1) in place. Z1 = 0 stands for the point at infinity.
+   The results are kept fully reduced, since H and r below are tested for zero. */
+static void EccPoint_add_mixed(uint8_t *X1, uint8_t *Y1, uint8_t *Z1, uint8_t *x2, uint8_t *y2)
+{
+    ECC_TEMP(uint8_t, t1, d3.addMixed[0]);
+    ECC_TEMP(uint8_t, t2, d3.addMixed[1]);
+    ECC_TEMP(uint8_t, t3, d3.addMixed[2]);
+    ECC_STAT(pointAdd);
+
+    if(vli_isZero(Z1))
+    {
+        vli_set(X1, x2);
+        vli_set(Y1, y2);
+        Z1[0] = 1;
+        return;
+    }
+
+    vli_modSquare_fast(t1, Z1);      /* t1 = z1^2 */
+    vli_modMult_fast(t2, x2, t1);    /* t2 = x2*z1^2 = U2 */
+    vli_modMult_fast(t1, t1, Z1);    /* t1 = z1^3 */
+    vli_modMult_fast(t1, t1, y2);    /* t1 = y2*z1^3 = S2 */
+    vli_modSub(t2, t2, X1, curve_p); /* t2 = U2 - x1 = H */
+    vli_modSub(t1, t1, Y1, curve_p); /* t1 = S2 - y1 = r */
+
+    if(vli_isZero(t2))
+    {
+        if(!vli_isZero(t1))
+        {
+            vli_clear(Z1); /* P + (-P) */
+            return;
+        }
+        EccPoint_double_jacobian(X1, Y1, Z1);
+#if ECC_LAZY_REDUCTION
+        if(vli_cmp(X1, curve_p) >= 0)
+        {
+            vli_sub(X1, X1, curve_p);
+        }
+        if(vli_cmp(Y1, curve_p) >= 0)
+        {
+            vli_sub(Y1, Y1, curve_p);
+        }
+#endif
+        return;
+    }
+
+    vli_modMult_fast(Z1, Z1, t2);    /* z3 = z1*H */
+    vli_modSquare_fast(t3, t2);      /* t3 = H^2 */
+    vli_modMult_fast(t2, t2, t3);    /* t2 = H^3 */
+    vli_modMult_fast(X1, X1, t3);    /* x1 = x1*H^2 = V */
+    vli_modSquare_fast(t3, t1);      /* t3 = r^2 */
+    vli_modSub(t3, t3, t2, curve_p); /* t3 = r^2 - H^3 */
+    vli_modSub(t3, t3, X1, curve_p);
+    vli_modSub(t3, t3, X1, curve_p); /* t3 = r^2 - H^3 - 2V = x3 */
+    vli_modSub(X1, X1, t3, curve_p); /* x1 = V - x3 */
+    vli_modMult_fast(X1, X1, t1);    /* x1 = r*(V - x3) */
+    vli_modMult_fast(Y1, Y1, t2);    /* y1 = y1*H^3 */
+    vli_modSub(Y1, X1, Y1, curve_p); /* y1 = y3 */
+    vli_set(X1, t3);
+}
+
+#endif /* ECC_CURVE != sect163k1 */
+
+/* Computes p_scalar * G as the Jacobian point (X, Y, Z) from the generator table: one table entry and one mixed
+   addition per byte of the scalar, no doublings. A zero byte reads entry 1 of its row and adds it into a copy
+   that is then dropped, so that the number of reads and additions does not follow the zero bytes. The offsets
+   read still follow the other bytes (see ECC_FIXED_TABLE in nano-ecc.h). The point at infinity comes out as
+   (0, 0, 1). Returns 0 if there is no table or a read failed. */
+static int EccPoint_table_sum(uint8_t *X, uint8_t *Y, uint8_t *Z, uint8_t *p_scalar)
+{
+    ECC_TEMP(EccPoint, l_entry, d4.tableSum.entry);
+    ECC_TEMP(uint8_t, l_X, d4.tableSum.sum[0]);
+    ECC_TEMP(uint8_t, l_Y, d4.tableSum.sum[1]);
+    ECC_TEMP(uint8_t, l_Z, d4.tableSum.sum[2]);
+    uint8_t l_nonzero;
+    uint i;
+
+    if(ecc_table_read == NULL)
+    {
+        return 0;
+    }
+
+    vli_clear(X);
+    vli_clear(Y);
+    vli_clear(Z);
+    for(i = 0; i < NUM_ECC_DIGITS; ++i)
+    {
+        l_nonzero = (uint8_t)(((uint)p_scalar[i] + 0xFF) >> 8);
+        if(!ecc_table_read(ECC_TABLE_OFFSET(i, p_scalar[i] | (l_nonzero ^ 1)), (uint8_t *)l_entry, sizeof(EccPoint)))
+        {
+            return 0;
+        }
+        vli_set(l_X, X);
+        vli_set(l_Y, Y);
+        vli_set(l_Z, Z);
+        EccPoint_add_mixed(l_X, l_Y, l_Z, l_entry->x, l_entry->y);
+        vli_cmov(X, l_X, l_nonzero);
+        vli_cmov(Y, l_Y, l_nonzero);
+        vli_cmov(Z, l_Z, l_nonzero);
+    }
+
+    if(vli_isZero(Z))
+    {
+        vli_clear(X);
+        vli_clear(Y);
+        Z[0] = 1;
+    }
+    return 1;
+}
+
+/* Completes EccPoint_table_sum(), given p_inverse = 1 / Z. */
+static void EccPoint_table_finish(EccPoint *p_result, uint8_t *X, uint8_t *Y, uint8_t *p_inverse)
+{
+    apply_z(X, Y, p_inverse);
+#if (ECC_CURVE == curve25519)
+    /* Back to the Montgomery x, keeping 0 for the point at infinity; y is dropped like the ladder does. */
+    if(!vli_isZero(X) || !vli_isZero(Y))
+    {
+        vli_modSub(X, X, curve_w, curve_p);
+    }
+    vli_clear(Y);
+#endif
+    vli_set(p_result->x, X);
+    vli_set(p_result->y, Y);
+}
+
+#endif /* ECC_FIXED_TABLE */
+
+void EccPoint_mult(EccPoint *p_result, EccPoint *p_point, uint8_t *p_scalar, uint8_t *p_initialZ)
+{
+    ECC_STAT(pointMult);
+#if ECC_FIXED_TABLE
+    if(p_point == NULL)
     {
-        vli_sub(p_privateKey, p_privateKey, curve_n);
+        ECC_TEMP(uint8_t, X, d5.mult[0]);
+        ECC_TEMP(uint8_t, Y, d5.mult[1]);
+        ECC_TEMP(uint8_t, Z, d5.mult[2]);
+
+        if(EccPoint_table_sum(X, Y, Z, p_scalar))
+        {
+            vli_modInv_fast(Z, Z);
+            EccPoint_table_finish(p_result, X, Y, Z);
+            return;
+        }
+    }
+#endif
+/* If base point is not specified, use the defined geneartor. */
+    if (p_point == NULL)
+	p_point = &curve_G;
+
+#if (ECC_CURVE == curve25519)
+    ECC_TEMP(uint8_t, X, d5.mult[0]);
+    ECC_TEMP(uint8_t, Z, d5.mult[1]);
+
+    EccPoint_xladder(X, Z, p_point->x, p_scalar, p_initialZ);
+    vli_modInv_fast(Z, Z);
+    EccPoint_xladder_finish(p_result, X, Z);
+#elif (ECC_CURVE == sect163k1)
+    ECC_TEMP(uint8_t, X, d5.mult[0]);
+    ECC_TEMP(uint8_t, Y, d5.mult[1]);
+    ECC_TEMP(uint8_t, Z, d5.mult[2]);
+
+    EccPoint_tnaf(X, Y, Z, p_point, p_scalar);
+    vli_modInv_fast(Z, Z);
+    EccPoint_tnaf_finish(p_result, X, Y, Z);
+#else
+    /* R0 and R1 */
+    ECC_TEMP(EccVli, Rx, d5.ladder.Rx);
+    ECC_TEMP(EccVli, Ry, d5.ladder.Ry);
+    ECC_TEMP(uint8_t, z, d5.ladder.z[0]);
+    uint nb;
+
+    nb = EccPoint_ladder(Rx, Ry, z, p_point, p_scalar, p_initialZ);
+    vli_modInv_fast(z, z);                /* 1 / (xP * Yb * (X1 - X0)) */
+    EccPoint_ladder_finish(p_result, Rx, Ry, z, p_point, nb);
+#endif
+}
+
+#if ECC_SIMD_LADDER
+    #include "nano-ecc-simd.inc"
+#endif
+
+/* Replaces each of p_values[0..p_count-1] by its inverse mod curve_p, using a single vli_modInv()
+   (Montgomery's trick: invert the running product, then peel the inputs off it one by one).
+   p_prefix must have room for p_count values. A zero input (the point at infinity, e.g. from a bad point
+   of a peer) zeroes the product; each value is then inverted on its own, so the other lanes stay right. */
+static void vli_modInv_batch(uint8_t (*p_values)[NUM_ECC_DIGITS], uint8_t (*p_prefix)[NUM_ECC_DIGITS], uint p_count)
+{
+    uint8_t l_inverse[NUM_ECC_DIGITS];
+    uint8_t l_tmp[NUM_ECC_DIGITS];
+    uint i;
+
+    vli_set(p_prefix[0], p_values[0]);
+    for(i = 1; i < p_count; ++i)
+    {
+        vli_modMult_fast(p_prefix[i], p_prefix[i-1], p_values[i]);
+    }
+
+    if(vli_isZero(p_prefix[p_count-1]))
+    {
+        for(i = 0; i < p_count; ++i)
+        {
+            vli_modInv_fast(p_values[i], p_values[i]);
+        }
+        return;
+    }
+
+    vli_modInv_fast(l_inverse, p_prefix[p_count-1]);
+
+    for(i = p_count - 1; i > 0; --i)
+    {
+        vli_modMult_fast(l_tmp, l_inverse, p_prefix[i-1]);    /* 1 / v[i] */
+        vli_modMult_fast(l_inverse, l_inverse, p_values[i]);  /* 1 / (v[0] * .. * v[i-1]) */
+        vli_set(p_values[i], l_tmp);
+    }
+    vli_set(p_values[0], l_inverse);
+}
+
+void EccPoint_mult_batch(EccPoint *p_results, EccPoint *p_points, uint8_t (*p_scalars)[NUM_ECC_DIGITS], unsigned p_count)
+{
+    uint8_t Rx[ECC_BATCH_MAX][2][NUM_ECC_DIGITS];
+#if (ECC_CURVE != curve25519 || ECC_FIXED_TABLE)
+    uint8_t Ry[ECC_BATCH_MAX][2][NUM_ECC_DIGITS];
+#endif
+#if ((ECC_CURVE != curve25519 && ECC_CURVE != sect163k1) || ECC_FIXED_TABLE)
+    uint nb[ECC_BATCH_MAX];
+#endif
+    uint8_t z[ECC_BATCH_MAX][NUM_ECC_DIGITS];
+    uint8_t l_prefix[ECC_BATCH_MAX][NUM_ECC_DIGITS];
+    unsigned l_done, l_lanes, i;
+#if ECC_SIMD_LADDER
+    const EccSimd *l_simd = ecc_simd_engine();
+    uint l_ladder[ECC_BATCH_MAX];
+    uint l_ladders;
+#endif
+
+    for(l_done = 0; l_done < p_count; l_done += l_lanes)
+    {
+        l_lanes = p_count - l_done;
+        if(l_lanes > ECC_BATCH_MAX)
+        {
+            l_lanes = ECC_BATCH_MAX;
+        }
+#if ECC_SIMD_LADDER
+        l_ladders = 0;
+#endif
+
+        for(i = 0; i < l_lanes; ++i)
+        {
+            EccPoint *l_point = (p_points ? &p_points[l_done + i] : &curve_G);
+            ECC_STAT(pointMult);
+#if ECC_FIXED_TABLE
+            if(p_points == NULL && EccPoint_table_sum(Rx[i][0], Ry[i][0], z[i], p_scalars[l_done + i]))
+            {
+                nb[i] = ECC_TABLE_LANE;
+                continue;
+            }
+#endif
+#if (ECC_CURVE == curve25519)
+            EccPoint_xladder(Rx[i][0], z[i], l_point->x, p_scalars[l_done + i], NULL);
+#if ECC_FIXED_TABLE
+            nb[i] = 0;
+#endif
+#elif (ECC_CURVE == sect163k1)
+            EccPoint_tnaf(Rx[i][0], Ry[i][0], z[i], l_point, p_scalars[l_done + i]);
+#if ECC_FIXED_TABLE
+            nb[i] = 0;
+#endif
+#else
+#if ECC_SIMD_LADDER
+            /* a scalar of 0 or 1 has no ladder steps to share */
+            if(l_simd && vli_numBits(p_scalars[l_done + i]) >= 2)
+            {
+                l_ladder[l_ladders++] = i;
+                continue;
+            }
+#endif
+            nb[i] = EccPoint_ladder(Rx[i], Ry[i], z[i], l_point, p_scalars[l_done + i], NULL);
+#endif
+        }
+#if ECC_SIMD_LADDER
+        if(l_ladders)
+        {
+            EccPoint_ladder_simd(l_simd, Rx, Ry, z, nb, l_ladder, l_ladders, (p_points ? &p_points[l_done] : NULL),
+                &p_scalars[l_done]);
+        }
+#endif
+
+        vli_modInv_batch(z, l_prefix, l_lanes);
+
+        for(i = 0; i < l_lanes; ++i)
+        {
+#if ECC_FIXED_TABLE
+            if(nb[i] == ECC_TABLE_LANE)
+            {
+                EccPoint_table_finish(&p_results[l_done + i], Rx[i][0], Ry[i][0], z[i]);
+                continue;
+            }
+#endif
+#if (ECC_CURVE == curve25519)
+            EccPoint_xladder_finish(&p_results[l_done + i], Rx[i][0], z[i]);
+#elif (ECC_CURVE == sect163k1)
+            EccPoint_tnaf_finish(&p_results[l_done + i], Rx[i][0], Ry[i][0], z[i]);
+#else
+            EccPoint *l_point = (p_points ? &p_points[l_done + i] : &curve_G);
+            EccPoint_ladder_finish(&p_results[l_done + i], Rx[i], Ry[i], z[i], l_point, nb[i]);
+#endif
+        }
     }
+}
+
+int ecc_make_key(EccPoint *p_publicKey, uint8_t p_privateKey[NUM_ECC_DIGITS], uint8_t p_random[NUM_ECC_DIGITS])
+{
+    /* Make sure the private key is in the range [1, n-1]. */
+    vli_set(p_privateKey, p_random);
+    ModNReduce(p_privateKey);
 
     if(vli_isZero(p_privateKey))
     {
         return 0; /* The private key cannot be 0 (mod p). */
     }
 
-    EccPoint_mult(p_publicKey, &curve_G, p_privateKey, NULL);
+    EccPoint_mult(p_publicKey, NULL, p_privateKey, NULL);
+    return 1;
+}
+
+#if (ECC_CURVE == curve25519)
+
+/* The x-only ladder takes any x below p, whether on curve25519 or on its twist, in the subgroup of order n or not.
+   Pass3 sends f = x(sk_r*R) + e for the tag's R, and sk_r is not clamped: with R of small order, or R = P + T for
+   T of small order, a tag could guess x(sk_r*R) from sk_r mod 8 and check each guess f - guess against e*E = G.
+   So x is rejected if it is that of a point of order 2, 4 or 8; if x^3 + A*x^2 + x is not a square, that is, R is
+   on the twist; and unless (n-1)*R = -R, which has the same x, so R is in the subgroup of order n. The last costs
+   a ladder. */
+int ecc_valid_public_key(EccPoint *p_publicKey)
+{
+    ECC_TEMP(uint8_t, l_tmp1, d2.validKey[0]);
+    ECC_TEMP(uint8_t, l_tmp2, d2.validKey[1]);
+    ECC_TEMP(uint8_t, X, d5.mult[0]);
+    ECC_TEMP(uint8_t, Z, d5.mult[1]);
+    ECC_TEMP(uint8_t, l_scalar, d5.mult[2]);
+    uint i;
+
+    if(vli_isZero(p_publicKey->x) || vli_cmp(curve_p, p_publicKey->x) != 1)
+    {
+        return 0;
+    }
+
+    vli_clear(l_tmp1);
+    l_tmp1[0] = 1;
+    vli_sub(l_tmp2, curve_p, l_tmp1);
+    if(vli_cmp(p_publicKey->x, l_tmp1) == 0 || vli_cmp(p_publicKey->x, l_tmp2) == 0 ||
+        vli_cmp(p_publicKey->x, curve_x8[0]) == 0 || vli_cmp(p_publicKey->x, curve_x8[1]) == 0)
+    {
+        return 0;
+    }
+
+    vli_modAdd(l_tmp2, p_publicKey->x, curve_A, curve_p);
+    vli_modMult_fast(l_tmp2, l_tmp2, p_publicKey->x);
+    vli_modAdd(l_tmp2, l_tmp2, l_tmp1, curve_p);
+    vli_modMult_fast(l_tmp1, l_tmp2, p_publicKey->x);    /* l_tmp1 = ((x + A)*x + 1)*x */
+
+    /* Euler's criterion: l_tmp1^((p-1)/2) is 1 for a square, with (p-1)/2 = 1{250} 0 1 1 0. */
+    vli_set(l_tmp2, l_tmp1);
+    for(i = 1; i < 250; ++i)
+    {
+        vli_modSquare_fast(l_tmp2, l_tmp2);
+        vli_modMult_fast(l_tmp2, l_tmp2, l_tmp1);
+    }
+    vli_modSquare_fast(l_tmp2, l_tmp2);
+    vli_modSquare_fast(l_tmp2, l_tmp2);
+    vli_modMult_fast(l_tmp2, l_tmp2, l_tmp1);
+    vli_modSquare_fast(l_tmp2, l_tmp2);
+    vli_modMult_fast(l_tmp2, l_tmp2, l_tmp1);
+    vli_modSquare_fast(l_tmp2, l_tmp2);
+    vli_clear(l_tmp1);
+    l_tmp1[0] = 1;
+    if(vli_cmp(l_tmp2, l_tmp1) != 0)
+    {
+        return 0;
+    }
+
+    /* X/Z = x((n-1)*R), compared with x without inverting Z; the point at infinity comes out as X = 0. */
+    vli_sub(l_scalar, curve_n, l_tmp1);
+    EccPoint_xladder(X, Z, p_publicKey->x, l_scalar, NULL);
+    vli_modMult_fast(l_tmp1, p_publicKey->x, Z);
+    return vli_cmp(X, l_tmp1) == 0;
+}
+
+#elif (ECC_CURVE == sect163k1)
+
+int ecc_valid_public_key(EccPoint *p_publicKey)
+{
+    ECC_TEMP(uint8_t, l_tmp1, d2.validKey[0]);
+    ECC_TEMP(uint8_t, l_tmp2, d2.validKey[1]);
+
+    if(EccPoint_isZero(p_publicKey))
+    {
+        return 0;
+    }
+
+    /* Both coordinates must be reduced, of degree below 163. */
+    if((p_publicKey->x[NUM_ECC_DIGITS-1] | p_publicKey->y[NUM_ECC_DIGITS-1]) & 0xF8)
+    {
+        return 0;
+    }
+
+    vli_xor(l_tmp1, p_publicKey->y, p_publicKey->x);
+    vli_modMult_fast(l_tmp1, l_tmp1, p_publicKey->y); /* tmp1 = y^2 + xy */
+
+    vli_set(l_tmp2, p_publicKey->x);
+    l_tmp2[0] ^= 1;                                   /* tmp2 = x + 1 */
+    vli_modMult_fast(l_tmp2, l_tmp2, p_publicKey->x);
+    vli_modMult_fast(l_tmp2, l_tmp2, p_publicKey->x); /* tmp2 = x^3 + ax^2 */
+    vli_xor(l_tmp2, l_tmp2, curve_b);                 /* tmp2 = x^3 + ax^2 + b */
+
+    /* Make sure that y^2 + xy == x^3 + ax^2 + b */
+    if(vli_cmp(l_tmp1, l_tmp2) != 0)
+    {
+        return 0;
+    }
+
     return 1;
 }
 
+#else
+
 int ecc_valid_public_key(EccPoint *p_publicKey)
 {
-    uint8_t na[NUM_ECC_DIGITS] = {3}; /* -a = 3 */
-    uint8_t l_tmp1[NUM_ECC_DIGITS];
-    uint8_t l_tmp2[NUM_ECC_DIGITS];
+    ECC_TEMP(uint8_t, na, d2.validKey[0]);
+    ECC_TEMP(uint8_t, l_tmp1, d2.validKey[1]);
+    ECC_TEMP(uint8_t, l_tmp2, d2.validKey[2]);
 
     if(EccPoint_isZero(p_publicKey))
     {
         return 0;
     }
 
+    vli_clear(na);
+    na[0] = 3; /* -a = 3 */
+
     if(vli_cmp(curve_p, p_publicKey->x) != 1 || vli_cmp(curve_p, p_publicKey->y) != 1)
     {
         return 0;
@@ -1217,18 +2916,17 @@ int ecc_valid_public_key(EccPoint *p_publicKey)
     return 1;
 }
 
-#if ECC_ECDSA
-
-/* -------- ECDSA code -------- */
+#endif /* ECC_CURVE == curve25519 */
 
 /* Computes p_result = (p_left * p_right) % p_mod. */
 void vli_modMult(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right, uint8_t *p_mod)
 {
-    uint8_t l_product[2 * NUM_ECC_DIGITS];
-    uint8_t l_modMultiple[2 * NUM_ECC_DIGITS];
+    ECC_TEMP(uint8_t, l_product, d5.modMult.product);
+    ECC_TEMP(uint8_t, l_modMultiple, d5.modMult.multiple);
     uint l_digitShift, l_bitShift;
     uint l_productBits;
     uint l_modBits = vli_numBits(p_mod);
+    ECC_STAT(modNMult);
     
     vli_mult(l_product, p_left, p_right);
     l_productBits = vli_numBits(l_product + NUM_ECC_DIGITS);
@@ -1286,10 +2984,16 @@ void vli_modMult(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right, uint8_t *
     vli_set(p_result, l_product);
 }
 
-uint max(uint a, uint b)
+#if (ECC_CURVE != curve25519 && ECC_CURVE != sect163k1)
+static uint max(uint a, uint b)
 {
     return (a > b ? a : b);
 }
+#endif
+
+#if ECC_ECDSA
+
+/* -------- ECDSA code -------- */
 
 int ecdsa_sign(uint8_t r[NUM_ECC_DIGITS], uint8_t s[NUM_ECC_DIGITS], uint8_t p_privateKey[NUM_ECC_DIGITS],
     uint8_t p_random[NUM_ECC_DIGITS], uint8_t p_hash[NUM_ECC_DIGITS])
@@ -1363,7 +3067,7 @@ int ecdsa_verify(EccPoint *p_publicKey, uint8_t p_hash[NUM_ECC_DIGITS], uint8_t
     vli_set(ty, curve_G.y);
     vli_modSub(z, l_sum.x, tx, curve_p); /* Z = x2 - x1 */
     XYcZ_add(tx, ty, l_sum.x, l_sum.y);
-    vli_modInv(z, z, curve_p); /* Z = 1/Z */
+    vli_modInv_fast(z, z); /* Z = 1/Z */
     apply_z(l_sum.x, l_sum.y, z);
     
     /* Use Shamir's trick to calculate u1*G + u2*Q */
@@ -1388,13 +3092,13 @@ int ecdsa_verify(EccPoint *p_publicKey, uint8_t p_hash[NUM_ECC_DIGITS], uint8_t
             vli_set(tx, l_point->x);
             vli_set(ty, l_point->y);
             apply_z(tx, ty, z);
-            vli_modSub(tz, rx, tx, curve_p); /* Z = x2 - x1 */
+            vli_modSub_fast(tz, rx, tx); /* Z = x2 - x1 */
             XYcZ_add(tx, ty, rx, ry);
             vli_modMult_fast(z, z, tz);
         }
     }
 
-    vli_modInv(z, z, curve_p); /* Z = 1/Z */
+    vli_modInv_fast(z, z); /* Z = 1/Z */
     apply_z(rx, ry, z);
     
     /* v = x1 (mod n) */
@@ -1452,6 +3156,27 @@ void ModNInv(uint8_t *p_result, uint8_t *p_input)
     vli_modInv(p_result, p_input, curve_n);
 }
 
+/* Return p_inputs[i]^-1 mod n for each i.
+   There is no fast reduction mod n, so the shared-inversion trick used for curve_p would cost
+   more in vli_modMult() than it saves; invert one by one. */
+void ModNInv_batch(uint8_t (*p_results)[NUM_ECC_DIGITS], uint8_t (*p_inputs)[NUM_ECC_DIGITS], unsigned p_count)
+{
+    unsigned i;
+    for(i = 0; i < p_count; ++i)
+    {
+        vli_modInv(p_results[i], p_inputs[i], curve_n);
+    }
+}
+
+/* Return x mod n */
+void ModNReduce(uint8_t *x)
+{
+    while(vli_cmp(x, curve_n) >= 0)
+    {
+        vli_sub(x, x, curve_n);
+    }
+}
+
 /* Return p_left + p_right mod n */
 void ModNAdd(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right)
 {
@@ -1476,18 +3201,45 @@ int IsGenerator(EccPoint* p_point)
    return vli_cmp(p_point->x, curve_G.x); 
 }
 
+#if (ECC_CURVE == sect163k1)
+/* Return tQ + mR, pairing the operands like the Shamir's trick version below does (IBIHOP_TagVerf() relies on it).
+   Both tau-adic NAFs are added into one accumulator, which takes a single inversion. */
+void FastCompute(uint8_t* x, EccPoint* R, EccPoint* Q, uint8_t* t, uint8_t* m)
+{
+    ECC_TEMP(uint8_t, X, d5.mult[0]);
+    ECC_TEMP(uint8_t, Y, d5.mult[1]);
+    ECC_TEMP(uint8_t, Z, d5.mult[2]);
+    ECC_STAT(pointMult);
+
+    if (R == NULL)
+    {
+      R = &curve_G;
+    }
+    if (Q == NULL)
+    {
+      Q = &curve_G;
+    }
+
+    vli_clear(Z);
+    EccPoint_tnaf_add(X, Y, Z, Q, t);
+    EccPoint_tnaf_add(X, Y, Z, R, m);
+    vli_modInv_fast(Z, Z); /* 0 for the point at infinity, which gives x = 0 */
+    vli_modMult_fast(x, X, Z);
+}
+
+#elif (ECC_CURVE != curve25519)
 /* Return tR + mQ */
 void FastCompute(uint8_t* x, EccPoint* R, EccPoint* Q, uint8_t* t, uint8_t* m)
 {
     /* Calculate l_sum = G + Q. */
-    uint8_t u1[NUM_ECC_DIGITS], u2[NUM_ECC_DIGITS];
-    uint8_t z[NUM_ECC_DIGITS];
-    EccPoint l_sum;
-    uint8_t rx[NUM_ECC_DIGITS];
-    uint8_t ry[NUM_ECC_DIGITS];
-    uint8_t tx[NUM_ECC_DIGITS];
-    uint8_t ty[NUM_ECC_DIGITS];
-    uint8_t tz[NUM_ECC_DIGITS];
+    ECC_TEMP(uint8_t, z, d5.fastCompute.v[0]);
+    ECC_TEMP(EccPoint, l_sum, d5.fastCompute.sum);
+    ECC_TEMP(uint8_t, rx, d5.fastCompute.v[1]);
+    ECC_TEMP(uint8_t, ry, d5.fastCompute.v[2]);
+    ECC_TEMP(uint8_t, tx, d5.fastCompute.v[3]);
+    ECC_TEMP(uint8_t, ty, d5.fastCompute.v[4]);
+    ECC_TEMP(uint8_t, tz, d5.fastCompute.v[5]);
+    ECC_STAT(pointMult);
 
     if (R ==  NULL)
     {
@@ -1498,23 +3250,20 @@ void FastCompute(uint8_t* x, EccPoint* R, EccPoint* Q, uint8_t* t, uint8_t* m)
       Q = &curve_G;
     }
 
-    vli_set(l_sum.x, R->x);
-    vli_set(l_sum.y, R->y);
+    vli_set(l_sum->x, R->x);
+    vli_set(l_sum->y, R->y);
     vli_set(tx, Q->x);
     vli_set(ty, Q->y);
-    vli_modSub(z, l_sum.x, tx, curve_p); /* Z = x2 - x1 */
-    XYcZ_add(tx, ty, l_sum.x, l_sum.y);
-    vli_modInv(z, z, curve_p); /* Z = 1/Z */
-    apply_z(l_sum.x, l_sum.y, z);
-
-    vli_set(u1, t);
-    vli_set(u2, m);
-
-    /* Use Shamir's trick to calculate u1*G + u2*Q */
-    EccPoint *l_points[4] = {NULL, Q, R, &l_sum};
-    uint l_numBits = max(vli_numBits(u1), vli_numBits(u2));
+    vli_modSub(z, l_sum->x, tx, curve_p); /* Z = x2 - x1 */
+    XYcZ_add(tx, ty, l_sum->x, l_sum->y);
+    vli_modInv_fast(z, z); /* Z = 1/Z */
+    apply_z(l_sum->x, l_sum->y, z);
+
+    /* Use Shamir's trick to calculate t*R + m*Q */
+    EccPoint *l_points[4] = {NULL, Q, R, l_sum};
+    uint l_numBits = max(vli_numBits(t), vli_numBits(m));
     
-    EccPoint *l_point = l_points[(!!vli_testBit(u1, l_numBits-1)) | ((!!vli_testBit(u2, l_numBits-1)) << 1)];
+    EccPoint *l_point = l_points[(!!vli_testBit(t, l_numBits-1)) | ((!!vli_testBit(m, l_numBits-1)) << 1)];
     vli_set(rx, l_point->x);
     vli_set(ry, l_point->y);
     vli_clear(z);
@@ -1525,35 +3274,52 @@ void FastCompute(uint8_t* x, EccPoint* R, EccPoint* Q, uint8_t* t, uint8_t* m)
     {
         EccPoint_double_jacobian(rx, ry, z);
         
-        int l_index = (!!vli_testBit(u1, k)) | ((!!vli_testBit(u2, k)) << 1);
+        int l_index = (!!vli_testBit(t, k)) | ((!!vli_testBit(m, k)) << 1);
         EccPoint *l_point = l_points[l_index];
         if(l_point)
         {
             vli_set(tx, l_point->x);
             vli_set(ty, l_point->y);
             apply_z(tx, ty, z);
-            vli_modSub(tz, rx, tx, curve_p); //* Z = x2 - x1 
+            vli_modSub_fast(tz, rx, tx); //* Z = x2 - x1 
             XYcZ_add(tx, ty, rx, ry);
             vli_modMult_fast(z, z, tz);
         }
     }
 
-    vli_modInv(z, z, curve_p); /* Z = 1/Z */
+    vli_modInv_fast(z, z); /* Z = 1/Z */
     apply_z(rx, ry, z);
     vli_set(x, rx);
 }
+#endif /* ECC_CURVE == sect163k1 */
 
 /* Gerarte random numbers. */
 void getRandomBytes(uint8_t *p_dest, unsigned p_size)
 {
+#if ECC_DRBG
+    ecc_drbg_generate(p_dest, p_size);
+#else
 //  srand(time(NULL));
     unsigned i;
     for (i = 0; i < p_size; ++i)
     {
 	p_dest[i] = (uint8_t)rand() % 256;
     }
+#endif
 }
 
+#if ECC_STATS
+void ecc_stats_get(EccStats *p_stats)
+{
+    *p_stats = ecc_stats;
+}
+
+void ecc_stats_reset(void)
+{
+    memset(&ecc_stats, 0, sizeof(ecc_stats));
+}
+#endif
+
 /* Return the current modulo n. */
 void GetN(uint8_t* p_dest)
 {
@@ -13,7 +13,14 @@ by
 #include <stdint.h>
 #include <stdlib.h>
 
-/* Define as 1 to enable ECDSA functions, 0 to disable.
+/* ECC_NAMESPACE - If defined, e.g. as secp256r1_, every external symbol of nano-ecc.c and ibihop.c gets this prefix
+                   so that the library can be built for several curves into one image (see ibihop-curve.h).
+*/
+#ifdef ECC_NAMESPACE
+#include "nano-ecc-namespace.h"
+#endif
+
+/* Define as 1 to enable ECDSA functions, 0 to disable. Not available with curve25519 and sect163k1.
  */
 #define ECC_ECDSA 1
 
@@ -23,32 +30,167 @@ ECC_SQUARE_FUNC - If enabled, this will cause a specific function to be used for
 */
 #define ECC_SQUARE_FUNC 1
 
+/* ECC_UNROLL - If enabled, the field arithmetic uses the straight-line, curve-specialized kernels from
+                nano-ecc-unrolled.inc (generated by tools/gen-unrolled.py; the Makefile does this for
+                ECC_UNROLL=1) instead of the loops. Faster but much larger, see README.md. With an ECC_ASM
+                backend only add/sub/modAdd/modSub are replaced, and secp160r1 keeps its vli_mmod_fast().
+*/
+#ifndef ECC_UNROLL
+    #define ECC_UNROLL 0
+#endif
+
+/* ECC_LAZY_REDUCTION - If enabled, the additions and subtractions inside the point formulas keep their results
+                        anywhere below 2^(8*NUM_ECC_DIGITS) instead of below p. A carry or borrow is folded
+                        back in as 2^(8*NUM_ECC_DIGITS) % p in a fixed number of passes, without comparing
+                        with p; the next multiplication reduces fully.
+*/
+#ifndef ECC_LAZY_REDUCTION
+    #define ECC_LAZY_REDUCTION 0
+#endif
+
+/* ECC_FERMAT_INV - If enabled, inversion mod p (at the end of every point multiplication and FastCompute) computes
+                    a^(p-2) with a fixed addition chain of squarings and multiplications instead of the binary GCD.
+                    If not defined, nano-ecc.c enables it exactly where the word-level secp192r1/secp256r1
+                    reductions are used (ecc_asm_x86_64/ecc_asm_cortexm), the only builds where it is faster.
+*/
+
+/* ECC_FIXED_TABLE - If enabled, multiplications of the generator (EccPoint_mult and EccPoint_mult_batch without a base
+                     point, so ecc_make_key and IBIHOP Pass1/Pass2) add up entries j*2^(8i)*G of a precomputed table
+                     instead of running the ladder: NUM_ECC_DIGITS mixed additions and no doublings. The table
+                     (ECC_TABLE_SIZE bytes, written by tools/gen-table.c) does not fit in ROM; it is read through the
+                     callback given to ecc_table_init(), e.g. from the external flash (ecc-table.c).
+                     The offset of every read is a byte of the scalar: anyone who can watch the flash bus, or share
+                     it, reads the scalar off it. Every byte is read and added, zero bytes included, so the timing
+                     no longer shows them, but the addresses do. Do not use the table with secret scalars (private
+                     keys, IBIHOP's r and e) where the SPI bus or the flash chip is reachable by someone else.
+*/
+#ifndef ECC_FIXED_TABLE
+    #define ECC_FIXED_TABLE 0
+#endif
+
+/* ECC_SIMD - If enabled, EccPoint_mult_batch() runs the ladders of a batch on the prime curves side by side in
+              SIMD lanes (nano-ecc-simd.inc): 8 lanes of radix 2^52 limbs with AVX-512 IFMA, or 4 lanes of radix
+              2^26 limbs with AVX2, whichever the CPU has, chosen at runtime by CPUID. CPUs with neither run the
+              ladders one by one as without it. x86-64 hosts only (the reader); curve25519 and sect163k1 ignore it.
+*/
+#ifndef ECC_SIMD
+    #define ECC_SIMD 0
+#endif
+#if (ECC_SIMD && !defined(__x86_64__))
+    #error "ECC_SIMD needs an x86-64 host"
+#endif
+
+/* ECC_BATCH_MAX - Number of independent scalar multiplications (or inversions) that the *_batch functions
+                   run together. They share one field inversion, at the cost of about 6*NUM_ECC_DIGITS bytes
+                   of stack per lane. Larger batches are processed in chunks of this size. 1 on MSP430, whose
+                   10 KB of RAM cannot spare the lanes (the reader's batch buffers grow with it too), 8 with
+                   ECC_SIMD, to fill the IFMA lanes, 4 elsewhere.
+*/
+#ifndef ECC_BATCH_MAX
+    #ifdef __MSP430__
+        #define ECC_BATCH_MAX 1
+    #elif ECC_SIMD
+        #define ECC_BATCH_MAX 8
+    #else
+        #define ECC_BATCH_MAX 4
+    #endif
+#endif
+
+/* ECC_SCRATCH - If enabled, the field and point temporaries of the tag's operations (EccPoint_mult, FastCompute,
+                 EccPoint_isSum, ecc_valid_public_key, the mod n helpers and everything they call) are taken from
+                 one static arena instead of the stack. Functions at the same call depth share a slot of it, so
+                 the arena is the sum of the largest temporaries of each depth (see EccScratch in nano-ecc.c),
+                 and the stack only keeps return addresses and scalars. The library is then not reentrant.
+                 The *_batch functions and ECDSA keep their own arrays on the stack.
+*/
+#ifndef ECC_SCRATCH
+    #define ECC_SCRATCH 0
+#endif
+
+/* ECC_DRBG - If enabled, getRandomBytes takes its bytes from the ChaCha20 generator in ecc-drbg.c, seeded
+              from getrandom() on Linux or from CC2420 RSSI noise on Sky/Z1, instead of rand(). The Contiki
+              build turns it on; the host tools and benchmarks keep rand() so that runs are repeatable.
+*/
+#ifndef ECC_DRBG
+    #define ECC_DRBG 0
+#endif
+
+/* ECC_STATS - If enabled, the field operations (products, squarings and inversions mod p, products and inversions
+               mod n) and the point doublings, additions and multiplications are counted in an EccStats, read
+               with ecc_stats_get() and cleared with ecc_stats_reset(). Disabled, the counting compiles to nothing.
+*/
+#ifndef ECC_STATS
+    #define ECC_STATS 0
+#endif
+
 /* Inline assembly options.
-Currently we do not provide any inline assembly options. In the future we plan to offer
-inline assembly for AVR and 8051.
+ecc_asm_none   - Portable C, 8-bit digits.
+ecc_asm_x86_64 - 64-bit multiply/square with MULX/ADCX/ADOX for readers running on a Linux host,
+                 with a portable 64-bit fallback chosen at runtime by CPUID. secp192r1 and secp256r1
+                 also get word-level fast reductions.
+ecc_asm_msp430 - 16-bit product-scanning multiply/square on the MSP430 16x16 hardware multiplier
+                 (MPY/MAC), e.g. the MSP430F1611 on Tmote Sky.
+ecc_asm_cortexm - 32-bit multiply/square with UMAAL on Cortex-M4 (UMULL/UMLAL on Cortex-M3), plus
+                 word-level fast reductions for every secp curve.
 
 Note: You must choose the appropriate option for your target architecture, or compilation will fail
 with strange assembler messages.
 */
 #define ecc_asm_none   0
+#define ecc_asm_x86_64 1
+#define ecc_asm_msp430 2
+#define ecc_asm_cortexm 3
 #ifndef ECC_ASM
     #define ECC_ASM ecc_asm_none
 #endif
 
-/* Curve selection options. */
+/* Curve selection options. A secp curve's value is the byte length of its p (and its NUM_ECC_DIGITS, except for
+secp160r1).
+secp160r1  - p = 2^160 - 2^31 - 1, but the group order n is a 161-bit number, so scalars and coordinates take 21
+             bytes; the top byte of a coordinate is always 0.
+curve25519 - The Montgomery curve y^2 = x^3 + 486662x^2 + x over 2^255 - 19 (RFC 7748), with x-only arithmetic:
+             EccPoint_mult() runs the Montgomery ladder on x alone and returns y = 0, and the point at infinity
+             comes out as x = 0. There is no ECDSA and no FastCompute(); EccPoint_isSum() takes its place in
+             IBIHOP_TagVerf(). The group order n is about 2^252, so scalars are reduced mod n with ModNReduce().
+sect163k1  - The Koblitz curve K-163, y^2 + xy = x^3 + x^2 + 1 over GF(2^163), in 21-byte polynomials. The field
+             arithmetic is carry-less (nano-ecc-gf2m.inc) and EccPoint_mult() uses the tau-adic NAF of the scalar,
+             so there are no point doublings. Every one of its 167 digits costs one addition, zero digits included,
+             so that the time does not reveal the scalar; inversion is always Itoh-Tsujii (ECC_FERMAT_INV), and the ECC_ASM
+             backends only speed up the arithmetic mod n. No ECDSA and no ECC_UNROLL.
+*/
 #define secp128r1 16
+#define secp160r1 20
 #define secp192r1 24
 #define secp256r1 32
 #define secp384r1 48
+#define curve25519 25519
+#define sect163k1 163
 #ifndef ECC_CURVE
     #define ECC_CURVE secp192r1
 #endif
 
-#if (ECC_CURVE != secp128r1 && ECC_CURVE != secp192r1 && ECC_CURVE != secp256r1 && ECC_CURVE != secp384r1)
+#if (ECC_CURVE != secp128r1 && ECC_CURVE != secp160r1 && ECC_CURVE != secp192r1 && ECC_CURVE != secp256r1 \
+    && ECC_CURVE != secp384r1 && ECC_CURVE != curve25519 && ECC_CURVE != sect163k1)
     #error "Must define ECC_CURVE to one of the available curves"
 #endif
 
-#define NUM_ECC_DIGITS ECC_CURVE
+#if (ECC_CURVE == secp160r1)
+    #define NUM_ECC_DIGITS 21
+#elif (ECC_CURVE == curve25519)
+    #define NUM_ECC_DIGITS 32
+    #undef ECC_ECDSA
+    #define ECC_ECDSA 0
+#elif (ECC_CURVE == sect163k1)
+    #define NUM_ECC_DIGITS 21
+    #undef ECC_ECDSA
+    #define ECC_ECDSA 0
+    #undef ECC_UNROLL
+    #define ECC_UNROLL 0
+    #undef ECC_FERMAT_INV
+    #define ECC_FERMAT_INV 1
+#else
+    #define NUM_ECC_DIGITS ECC_CURVE
+#endif
 
 typedef struct EccPoint
 {
@@ -168,6 +310,28 @@ Output:
 */
 void ModNInv(uint8_t *p_result, uint8_t *p_input);
 
+/*
+ModNInv_batch:
+	Compute the multiplicative inverses of p_count numbers mod n.
+Input:
+	p_results	- array of p_count variables for taking the results
+	p_inputs	- array of p_count non-zero big integers
+	p_count		- number of inputs.
+Output:
+	p_results	- p_results[i] = p_inputs[i]^-1 mod n.
+*/
+void ModNInv_batch(uint8_t (*p_results)[NUM_ECC_DIGITS], uint8_t (*p_inputs)[NUM_ECC_DIGITS], unsigned p_count);
+
+/*
+ModNReduce:
+	Reduce a big integer mod n, e.g. an x-coordinate (below p) or a random number before it is used as a scalar.
+Input:
+	x	- a big integer.
+Output:
+	x	- x mod n.
+*/
+void ModNReduce(uint8_t *x);
+
 /*
 ModNAdd:
 	Compute the addtion of two big integers mod n.
@@ -212,11 +376,66 @@ Input:
 	p_point	- the base point for the calculation; if NULL - use the generator as the base point.
 	p_scalar- the scalar value.
 	p_initialZ - initial value of calculation, usually be NULL.
+		     Not used when the generator table (ECC_FIXED_TABLE) computes the result, nor on sect163k1.
 Output:
 	p_dest	- the value of the new EC point p_scalar(p_piont) mod n.
 */
 void EccPoint_mult(EccPoint *p_result, EccPoint *p_point, uint8_t *p_scalar, uint8_t *p_initialZ);
 
+/*
+EccPoint_mult_batch:
+	Compute p_count independent point multiplications. The ladders run one after the other (side by side
+	in SIMD lanes with ECC_SIMD), and their final 1/Z values are found with a single shared inversion.
+Input:
+	p_results	- array of p_count variables for taking the results
+	p_points	- array of p_count base points; if NULL - use the generator for all of them.
+	p_scalars	- array of p_count scalars.
+	p_count		- number of multiplications.
+Output:
+	p_results	- p_results[i] = p_scalars[i](p_points[i]).
+*/
+void EccPoint_mult_batch(EccPoint *p_results, EccPoint *p_points, uint8_t (*p_scalars)[NUM_ECC_DIGITS], unsigned p_count);
+
+#if ECC_FIXED_TABLE
+/* Generator table layout: a 4-byte header ("EC", then ECC_CURVE as 16 bits little-endian), then for each byte position
+   i < NUM_ECC_DIGITS the 255 affine points j*2^(8i)*G, j = 1..255, stored as EccPoint. curve25519 tables hold the
+   points on the short Weierstrass form of the curve (x + 486662/3, y), since the x-only formulas cannot add them. */
+#define ECC_TABLE_HEADER 4
+#define ECC_TABLE_ROW    255
+#define ECC_TABLE_OFFSET(i, j) (ECC_TABLE_HEADER + ((uint32_t)(i) * ECC_TABLE_ROW + (j) - 1) * sizeof(EccPoint))
+#define ECC_TABLE_SIZE   ECC_TABLE_OFFSET(NUM_ECC_DIGITS, 1)
+
+typedef int (*ecc_table_read_fn)(uint32_t p_offset, uint8_t *p_dest, unsigned p_size);
+
+/*
+ecc_table_init:
+	Select the generator table used by EccPoint_mult() and EccPoint_mult_batch() when no base point is given.
+	If a read fails later on, that multiplication falls back to the ladder.
+Input:
+	p_read	- reads p_size bytes at p_offset of the table into p_dest, returning 1 on success and 0 on error;
+		  NULL - stop using a table.
+Output:
+	1	- the table header and its first entry (G) are valid; the table is used from now on.
+	0	- no table is used.
+*/
+int ecc_table_init(ecc_table_read_fn p_read);
+#endif
+
+#if (ECC_CURVE == curve25519)
+/*
+EccPoint_isSum:
+	Check, from x-coordinates only, whether p_x belongs to P + Q or P - Q.
+Input:
+	p_x	- x-coordinate to check.
+	p_xP	- x-coordinate of P.
+	p_xQ	- x-coordinate of Q.
+Output:
+	1	- p_x is the x-coordinate of P + Q or of P - Q.
+	0	- it is neither.
+*/
+int EccPoint_isSum(uint8_t *p_x, uint8_t *p_xP, uint8_t *p_xQ);
+
+#else
 /*
 FastCompute:
 	Compute tR+mQ by using Shamir's trick.
@@ -230,6 +449,7 @@ Output:
 	x	- value of x-coordinate of result EC point.
 */
 void FastCompute(uint8_t* x, EccPoint* R, EccPoint* Q, uint8_t* t, uint8_t* m);
+#endif
 
 
 /*
@@ -246,7 +466,7 @@ int IsGenerator(EccPoint* p_piont);
 
 /*
 getRandomBytes:
-	Generate a random big integer.
+	Generate a random big integer, from ecc_drbg_generate() if ECC_DRBG is enabled and from rand() otherwise.
 Input:
 	p_dest	- variable for taking the result
 	p_size	- size of the integer
@@ -300,6 +520,58 @@ Output:
 void GetG(EccPoint* g_dest);
 
 
+#if ECC_STATS
+/* Operations counted since the last ecc_stats_reset() (ECC_STATS=1). Each curve of a multi-curve image has its own. */
+typedef struct EccStats
+{
+    uint32_t modMult;     /* multiplications mod p (mod f(z) on sect163k1) */
+    uint32_t modSquare;   /* squarings mod p */
+    uint32_t modInv;      /* inversions mod p; the products of the ECC_FERMAT_INV chain are counted as well */
+    uint32_t modNMult;    /* multiplications mod n (ModNMult, ECDSA) */
+    uint32_t modNInv;     /* inversions mod n (ModNInv, ECDSA) */
+    uint32_t pointDouble; /* point doublings; one curve25519 ladder step counts as a doubling and an addition */
+    uint32_t pointAdd;    /* point additions: co-Z, mixed (tables, sect163k1) and ladder steps */
+    uint32_t pointMult;   /* scalar multiplications: EccPoint_mult, each lane of EccPoint_mult_batch, FastCompute */
+} EccStats;
+
+/*
+ecc_stats_get:
+	Take a snapshot of the operation counters. The difference of two snapshots is the cost of what ran in between.
+Output:
+	p_stats	- the counters.
+*/
+void ecc_stats_get(EccStats *p_stats);
+
+/*
+ecc_stats_reset:
+	Set all operation counters to 0.
+*/
+void ecc_stats_reset(void);
+#endif
+
+#if (ECC_ASM == ecc_asm_x86_64)
+/*
+ecc_x86_64_has_adx:
+	Check whether the MULX/ADX code path is used on this CPU.
+Output:
+	1	- MULX/ADCX/ADOX are used.
+	0	- the portable 64-bit code is used.
+*/
+int ecc_x86_64_has_adx(void);
+#endif
+
+#if ECC_SIMD
+/*
+ecc_simd_lanes:
+	Check which SIMD ladders EccPoint_mult_batch() uses on this CPU.
+Output:
+	8	- AVX-512 IFMA.
+	4	- AVX2.
+	0	- none: the ladders run one by one (and always on curve25519 and sect163k1).
+*/
+int ecc_simd_lanes(void);
+#endif
+
 //int getRandomBytes2(void *p_dest, unsigned p_size);
 #endif 
 
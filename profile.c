@@ -0,0 +1,111 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+One IBIHOP handshake on a single mote, reader and tag in the same image, for profiling the ECC code of
+ECC_CURVE in MSPsim (sim/profiler.py). Every pass runs between the lines
+
+	PROFILE begin <pass> <curve>
+	PROFILE end <pass> <curve>
+
+with a pause after each line so that the Cooja script can clear the profiler before the pass and dump
+it after. The radio is off and there is no network traffic, so apart from the clock interrupt the
+cycles between the two lines are those of the pass.
+
+	make profile TARGET=sky ECC_CURVE=secp160r1
+*/
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "dev/watchdog.h"
+#include "ibihop.h"
+#include "nano-ecc.h"
+#include "ibihop-keys.h"
+#if ECC_FIXED_TABLE
+#include "ecc-table.h"
+#endif
+#if ECC_DRBG
+#include "ecc-drbg.h"
+#endif
+#include <stdio.h>
+
+/* Time for the script to act on a marker line before the mote goes on. */
+#ifndef PROFILE_PAUSE
+#define PROFILE_PAUSE (CLOCK_SECOND / 8)
+#endif
+
+static EccPoint pk_s = IBIHOP_KEY(PKS, ECC_CURVE);	/* Reader's public key. */
+static EccPoint pk_c = IBIHOP_KEY(PKC, ECC_CURVE);	/* Tag's public key. */
+static uint8_t sk_s[NUM_ECC_DIGITS] = IBIHOP_KEY(SKS, ECC_CURVE);	/* Reader's private key. */
+static uint8_t sk_c[NUM_ECC_DIGITS] = IBIHOP_KEY(SKC, ECC_CURVE);	/* Tag's private key. */
+
+static const char * const pass_names[] = {"P1", "P2", "P3", "P4", "TagVerf"};
+
+static EccPoint E, R;
+static uint8_t e[NUM_ECC_DIGITS], e_inv[NUM_ECC_DIGITS];
+static uint8_t r[NUM_ECC_DIGITS], f[NUM_ECC_DIGITS], s[NUM_ECC_DIGITS];
+
+PROCESS(profile_process, "IBIHOP profile");
+AUTOSTART_PROCESSES(&profile_process);
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(profile_process, ev, data)
+{
+  static struct etimer pause;
+  static uint8_t pass;
+  static int result;
+
+  PROCESS_BEGIN();
+
+  NETSTACK_MAC.off(0);
+  watchdog_stop();
+#if ECC_FIXED_TABLE
+  if(!ecc_table_open(ecc_table_init)) {
+    printf("No generator table for this curve, using the ladder\n");
+  }
+#endif
+#if ECC_DRBG
+  {
+    uint8_t l_warmup;
+    ecc_drbg_generate(&l_warmup, 1);	/* Gather the seed outside the passes. */
+  }
+#endif
+
+  result = 0;
+  for(pass = 0; pass < 5; pass++) {
+    etimer_set(&pause, PROFILE_PAUSE);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&pause));
+    printf("PROFILE begin %s %u\n", pass_names[pass], ECC_CURVE);
+    etimer_set(&pause, PROFILE_PAUSE);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&pause));
+
+    switch(pass) {
+    case 0:
+      IBIHOP_Pass1(&E, e, e_inv);
+      break;
+    case 1:
+      IBIHOP_Pass2(&R, r);
+      break;
+    case 2:
+      IBIHOP_Pass3(f, &R, e, sk_s);
+      break;
+    case 3:
+      result |= IBIHOP_Pass4(s, &pk_s, &E, f, r, sk_c);
+      break;
+    case 4:
+      result |= IBIHOP_TagVerf(R, e_inv, s, pk_c);
+      break;
+    }
+
+    printf("PROFILE end %s %u\n", pass_names[pass], ECC_CURVE);
+  }
+
+  etimer_set(&pause, PROFILE_PAUSE);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&pause));
+  printf("PROFILE done %s\n", result == 0 ? "OK" : "FAILED");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -40,8 +40,18 @@
 #include <string.h>
 #include <ctype.h>
 #include "dev/watchdog.h"
-#include "ibihop.h"
 #include "nano-ecc.h"
+#include "ibihop-curve.h"
+#include "ibihop-keys.h"
+#if ECC_FIXED_TABLE
+#include "ecc-table.h"
+#endif
+#include "ibihop-stats.h"
+#include "ibihop-trace.h"
+#if ECC_DRBG
+#include "ecc-drbg.h"
+#include "net/linkaddr.h"
+#endif
 
 #define DEBUG DEBUG_NONE
 #include "net/ip/uip-debug.h"
@@ -53,115 +63,371 @@
 
 #define UDP_EXAMPLE_ID  190
 
-#define PKC { \
-    {0xEE, 0xB9, 0x10, 0x51, 0x7B, 0xBD, 0xF3, 0x7A, 0x68, 0x48, 0x50, 0xF7, 0xD5, 0xAF, 0xD5, 0x4E, 0x6F, 0x9D, 0xA6, 0xFE, 0x83, 0x50, 0x6C, 0x73}, \
-    {0x4A, 0x91, 0xDD, 0x1F, 0x30, 0x05, 0x1D, 0x88, 0xB7, 0x76, 0x3D, 0xE1, 0x9F, 0x4E, 0x8A, 0x5F, 0xA9, 0xE4, 0x80, 0x12, 0xD5, 0x4D, 0x8B, 0xDD}}
+#ifndef IBIHOP_MAX_SESSIONS
+#define IBIHOP_MAX_SESSIONS 4	/* Number of tags that can be in a handshake at the same time. */
+#endif
+#ifndef IBIHOP_SESSION_TIMEOUT
+#define IBIHOP_SESSION_TIMEOUT (30 * CLOCK_SECOND)	/* A session waiting longer for message 2 or 4 is reclaimed. */
+#endif
 
-#define SKS {0x61, 0xAC, 0x91, 0xAE, 0xBC, 0xF3, 0x33, 0x86, 0x2C, 0xEF, 0xBB, 0x11, 0x01, 0x23, 0xD7, 0x1B, 0xB9, 0x4A, 0xBE, 0xAC, 0x9B, 0xF5, 0xBE, 0x46}
+#define MSG_LEN (2 * IBIHOP_MAX_DIGITS + 2)	/* Longest message, for the largest curve */
+#define MSG_LEN_OF(curve) (2 * (curve)->digits + 2)
 
 static struct uip_udp_conn *server_conn;
 
+/* Per-tag handshake state. Sessions waiting for a Pass1/Pass3 computation form the pending queue,
+   which the server process drains in batches of ECC_BATCH_MAX. */
+enum {
+  SESSION_FREE,
+  SESSION_PASS1_PENDING,	/* "hello" received, challenge E not computed yet */
+  SESSION_WAIT_R,		/* E sent, waiting for message 2 */
+  SESSION_PASS3_PENDING,	/* R received, f not computed yet */
+  SESSION_WAIT_S		/* f sent, waiting for message 4 */
+};
+
+/* Server's private key and client's public key for every curve of the image (see ibihop-keys.h). */
+struct curve_keys {
+  uint16_t curve;
+  uint8_t *sk_s;
+  uint8_t *pk_c;
+};
 
-static EccPoint E;
-static EccPoint R;
-static EccPoint pk_c = PKC;	//Client's public key
-static uint8_t sk_s[NUM_ECC_DIGITS] = SKS;	//Server's private key
-static uint8_t e[NUM_ECC_DIGITS],e_inv[NUM_ECC_DIGITS]; 
-static uint8_t f[NUM_ECC_DIGITS];
-static uint8_t s[NUM_ECC_DIGITS];
-static clock_time_t start_time;
+#define CURVE_KEYS(id, digits) \
+  static uint8_t sk_s_##id[digits] = SKS_##id; \
+  static uint8_t pk_c_##id[2][digits] = PKC_##id;
+#if IBIHOP_WITH_secp128r1
+CURVE_KEYS(16, 16)
+#endif
+#if IBIHOP_WITH_secp160r1
+CURVE_KEYS(20, 21)
+#endif
+#if IBIHOP_WITH_secp192r1
+CURVE_KEYS(24, 24)
+#endif
+#if IBIHOP_WITH_secp256r1
+CURVE_KEYS(32, 32)
+#endif
+#if IBIHOP_WITH_secp384r1
+CURVE_KEYS(48, 48)
+#endif
+#if IBIHOP_WITH_curve25519
+CURVE_KEYS(25519, 32)
+#endif
+#if IBIHOP_WITH_sect163k1
+CURVE_KEYS(163, 21)
+#endif
+
+static const struct curve_keys curve_keys[] = {
+#if IBIHOP_WITH_secp128r1
+  { 16, sk_s_16, pk_c_16[0] },
+#endif
+#if IBIHOP_WITH_secp160r1
+  { 20, sk_s_20, pk_c_20[0] },
+#endif
+#if IBIHOP_WITH_secp192r1
+  { 24, sk_s_24, pk_c_24[0] },
+#endif
+#if IBIHOP_WITH_secp256r1
+  { 32, sk_s_32, pk_c_32[0] },
+#endif
+#if IBIHOP_WITH_secp384r1
+  { 48, sk_s_48, pk_c_48[0] },
+#endif
+#if IBIHOP_WITH_curve25519
+  { 25519, sk_s_25519, pk_c_25519[0] },
+#endif
+#if IBIHOP_WITH_sect163k1
+  { 163, sk_s_163, pk_c_163[0] },
+#endif
+};
+
+struct session {
+  uip_ipaddr_t addr;
+  uint8_t state;
+  const IBIHOP_Curve *curve;	/* Curve the tag asked for in its hello */
+  const struct curve_keys *keys;
+  uint8_t R[2 * IBIHOP_MAX_DIGITS];
+  uint8_t e[IBIHOP_MAX_DIGITS], e_inv[IBIHOP_MAX_DIGITS];
+  clock_time_t touched;		/* clock_time() of the last message of the handshake */
+#if IBIHOP_STATS
+  clock_time_t started;		/* clock_time() of the hello, for the latency histogram */
+#endif
+};
+
+static struct session sessions[IBIHOP_MAX_SESSIONS];
 
 PROCESS(udp_server_process, "UDP server process");
 AUTOSTART_PROCESSES(&udp_server_process);
 /*---------------------------------------------------------------------------*/
+static const struct curve_keys *
+keys_find(uint16_t curve)
+{
+  unsigned i;
+  for(i = 0; i < sizeof(curve_keys) / sizeof(curve_keys[0]); i++) {
+    if(curve_keys[i].curve == curve) {
+      return &curve_keys[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static struct session *
+session_find(uip_ipaddr_t *addr)
+{
+  int i;
+  for(i = 0; i < IBIHOP_MAX_SESSIONS; i++) {
+    if(sessions[i].state != SESSION_FREE && uip_ipaddr_cmp(&sessions[i].addr, addr)) {
+      return &sessions[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static struct session *
+session_new(uip_ipaddr_t *addr)
+{
+  int i;
+  clock_time_t age, oldest;
+  struct session *session = session_find(addr);
+
+  if(session != NULL) {
+    return session;		/* The tag restarted its handshake. */
+  }
+  for(i = 0; i < IBIHOP_MAX_SESSIONS; i++) {
+    if(sessions[i].state == SESSION_FREE) {
+      uip_ipaddr_copy(&sessions[i].addr, addr);
+      return &sessions[i];
+    }
+  }
+  /* Table full: reclaim the session that has waited longest for its tag, once past the timeout, so that
+     tags which went away (or hellos never meant to be answered) cannot hold the table for good. */
+  oldest = IBIHOP_SESSION_TIMEOUT;
+  for(i = 0; i < IBIHOP_MAX_SESSIONS; i++) {
+    age = clock_time() - sessions[i].touched;
+    if((sessions[i].state == SESSION_WAIT_R || sessions[i].state == SESSION_WAIT_S) && age >= oldest) {
+      session = &sessions[i];
+      oldest = age;
+    }
+  }
+  if(session != NULL) {
+    ibihop_stats_count(IBIHOP_STATS_FAILED);
+    uip_ipaddr_copy(&session->addr, addr);
+  }
+  return session;
+}
+/*---------------------------------------------------------------------------*/
+static void
+send_reply(struct session *session, char *buf)
+{
+  uip_udp_packet_sendto(server_conn, buf, MSG_LEN_OF(session->curve), &session->addr, UIP_HTONS(UDP_CLIENT_PORT));
+}
+/*---------------------------------------------------------------------------*/
+/* Collects up to ECC_BATCH_MAX sessions in the given state, all on the curve of the first one found. */
+static int
+pending_collect(uint8_t state, struct session **batch)
+{
+  int i, n = 0;
+  for(i = 0; i < IBIHOP_MAX_SESSIONS && n < ECC_BATCH_MAX; i++) {
+    if(sessions[i].state == state && (n == 0 || sessions[i].curve == batch[0]->curve)) {
+      batch[n++] = &sessions[i];
+    }
+  }
+  return n;
+}
+#if IBIHOP_STATS
+/* Sessions waiting for a Pass1 or Pass3 computation. */
+static uint8_t
+pending_count(void)
+{
+  uint8_t i, n = 0;
+  for(i = 0; i < IBIHOP_MAX_SESSIONS; i++) {
+    if(sessions[i].state == SESSION_PASS1_PENDING || sessions[i].state == SESSION_PASS3_PENDING) {
+      n++;
+    }
+  }
+  return n;
+}
+#endif
+/*---------------------------------------------------------------------------*/
+static void
+process_pending(void)
+{
+  struct session *batch[ECC_BATCH_MAX];
+  const IBIHOP_Curve *curve;
+  /* Values of the batch, packed with the size of its curve. */
+  uint8_t points[ECC_BATCH_MAX * 2 * IBIHOP_MAX_DIGITS];
+  uint8_t e[ECC_BATCH_MAX * IBIHOP_MAX_DIGITS], e_inv[ECC_BATCH_MAX * IBIHOP_MAX_DIGITS];
+  uint8_t f[ECC_BATCH_MAX * IBIHOP_MAX_DIGITS];
+  char buf[MSG_LEN];
+  int i, n;
+  unsigned j, N;
+
+  while((n = pending_collect(SESSION_PASS1_PENDING, batch)) > 0) {
+    curve = batch[0]->curve;
+    N = curve->digits;
+    ibihop_pass_begin(IBIHOP_PASS_OPS(curve->StatsReset));
+    curve->Pass1_batch(points, e, e_inv, n);	/*pass 1: reader sends challenges to the tags*/
+    ibihop_pass_end(IBIHOP_TRACE_PASS1, n, curve->id, IBIHOP_PASS_OPS(curve->StatsGet));	/* printed once the replies are out */
+
+    for(i = 0; i < n; i++) {
+      memcpy(batch[i]->e, &e[i * N], N);
+      memcpy(batch[i]->e_inv, &e_inv[i * N], N);
+      batch[i]->state = SESSION_WAIT_R;
+      batch[i]->touched = clock_time();
+
+      memset(buf, 0, sizeof(buf));
+      buf[0] = '1';				/*Reader's challenge message*/
+      for(j = 0; j < 2 * N; ++j)		/* x, then y */
+      {
+        buf[j+1] = points[i * 2 * N + j];
+      }
+      IBIHOP_TRACE_DEBUG(IBIHOP_TRACE_SENT, '1', curve->id, 0);
+      send_reply(batch[i], buf);
+    }
+  }
+
+  while((n = pending_collect(SESSION_PASS3_PENDING, batch)) > 0) {
+    curve = batch[0]->curve;
+    N = curve->digits;
+    for(i = 0; i < n; i++) {
+      memcpy(&points[i * 2 * N], batch[i]->R, 2 * N);
+      memcpy(&e[i * N], batch[i]->e, N);
+    }
+    ibihop_pass_begin(IBIHOP_PASS_OPS(curve->StatsReset));
+    curve->Pass3_batch(f, points, e, batch[0]->keys->sk_s, n);	/*pass 3: reader replies the tags by f.*/
+    ibihop_pass_end(IBIHOP_TRACE_PASS3, n, curve->id, IBIHOP_PASS_OPS(curve->StatsGet));
+
+    for(i = 0; i < n; i++) {
+      batch[i]->state = SESSION_WAIT_S;
+      batch[i]->touched = clock_time();
+
+      memset(buf, 0, sizeof(buf));
+      buf[0] = '3';				/*Authentication message flag.*/
+      for(j = 0; j < N; ++j)
+      {
+        buf[j+1] = f[i * N + j];
+      }
+      IBIHOP_TRACE_DEBUG(IBIHOP_TRACE_SENT, '3', curve->id, 0);
+      send_reply(batch[i], buf);
+    }
+  }
+  ibihop_stats_queue(pending_count());
+}
+/*---------------------------------------------------------------------------*/
 static void
 tcpip_handler(void)
 {
     char *appdata;
-    char buf[50];
-    unsigned i;
-    buf[0] = 0;
+    char buf[MSG_LEN];
+    uint8_t s[IBIHOP_MAX_DIGITS];
+    struct session *session;
+    const IBIHOP_Curve *curve;
+    const struct curve_keys *keys;
+    uint16_t id;
+    unsigned i, N;
 
     if(uip_newdata()) {
     	appdata = (char *)uip_appdata;
     	appdata[uip_datalen()] = 0;
-    	PRINTF("SERVER: DATA recv '%s' from ", appdata);
-    	PRINTF("%d",
-        UIP_IP_BUF->srcipaddr.u8[sizeof(UIP_IP_BUF->srcipaddr.u8) - 1]);
-    	PRINTF("\n");
+    	IBIHOP_TRACE_DEBUG(IBIHOP_TRACE_RECEIVED, appdata[0], 0,
+    	    UIP_IP_BUF->srcipaddr.u8[sizeof(UIP_IP_BUF->srcipaddr.u8) - 1]);
 
-    if ( strncmp(appdata, "hello", 5) == 0 )	/*Recieved tag's request and send a challenge to tag.*/
+    if ( strncmp(appdata, "hello", 5) == 0 )	/*Recieved tag's request; queue a challenge for it.*/
     {
-//
-	start_time = clock_time();
-    	IBIHOP_Pass1(&E, e, e_inv);	/*pass 1: reader sends challenge to tag*/
-	printf("P1: Completion time %lu / %lu\n", (unsigned long)clock_time() - start_time, CLOCK_SECOND); /* Print the time consumption (number of ticks) of IBIHOP_Pass1(). 1 clock second = 128 ticks */
-    	PRINTF("SERVER: DATA sending reply\n");
-    
-    	buf[0] = '1';				/*Reader's challenge message*/
-    	for(i = 0; i < NUM_ECC_DIGITS; ++i)
-    	{
-        	buf[i+1] = E.x[i];
-		buf[i+NUM_ECC_DIGITS+1] = E.y[i];
-    	}
-    	buf[2*NUM_ECC_DIGITS+1] = 0;
+	id = ECC_CURVE;		/* A bare "hello" is for the default curve; "hello" + 2 bytes (LE) names one. */
+	if(uip_datalen() >= 7) {
+	    id = (uint8_t)appdata[5] | ((uint16_t)(uint8_t)appdata[6] << 8);
+	}
+	curve = IBIHOP_FindCurve(id);
+	keys = keys_find(id);
+	if(curve == NULL || keys == NULL) {
+	    IBIHOP_TRACE_DEBUG(IBIHOP_TRACE_NO_CURVE, 0, id, 0);
+	    ibihop_stats_count(IBIHOP_STATS_DROPPED);
+	    return;
+	}
+	session = session_new(&UIP_IP_BUF->srcipaddr);
+	if(session == NULL) {
+	    IBIHOP_TRACE_DEBUG(IBIHOP_TRACE_NO_SESSION, 0, id, 0);
+	    ibihop_stats_count(IBIHOP_STATS_DROPPED);
+	    return;
+	}
+	session->curve = curve;
+	session->keys = keys;
+	session->state = SESSION_PASS1_PENDING;
+#if IBIHOP_STATS
+	session->started = clock_time();
+#endif
+	ibihop_stats_count(IBIHOP_STATS_STARTED);
+	ibihop_stats_queue(pending_count());
+	process_poll(&udp_server_process);
     }
-    else if ( strncmp(appdata, "2", 1) == 0 )	/*Recived tag's challenge and response an authentication message.*/
+    else if ( strncmp(appdata, "2", 1) == 0 )	/*Recived tag's challenge; queue the authentication message.*/
     {
-       for(i = 0; i < NUM_ECC_DIGITS; ++i)
-    	{
-            R.x[i] = (uint8_t)appdata[i+1];
-	    R.y[i] = (uint8_t)appdata[i+NUM_ECC_DIGITS+1];
-    	}
-
-//
-	start_time = clock_time();
-    	IBIHOP_Pass3(f, &R, e, sk_s);	/*pass 3: reader replies tag by f.*/
-	printf("P3: Completion time %lu / %lu\n", (unsigned long)clock_time() - start_time, CLOCK_SECOND);
-    	PRINTF("SERVER: Reply f to tag.\n");
-    
-    
-    	buf[0] = '3';				/*Authentication message flag.*/
-    	for(i = 0; i < NUM_ECC_DIGITS; ++i)
+	session = session_find(&UIP_IP_BUF->srcipaddr);
+	if(session == NULL || session->state != SESSION_WAIT_R || uip_datalen() < 2 * session->curve->digits + 1) {
+	    IBIHOP_TRACE_ERROR(IBIHOP_TRACE_UNEXPECTED, '2', 0, 0);
+	    ibihop_stats_count(IBIHOP_STATS_UNEXPECTED);
+	    return;
+	}
+        for(i = 0; i < 2 * session->curve->digits; ++i)	/* x, then y */
     	{
-            buf[i+1] = f[i];
+            session->R[i] = (uint8_t)appdata[i+1];
     	}
-	buf[NUM_ECC_DIGITS+1] = 0;
+	if(!session->curve->ValidPublicKey(session->R)) {	/* Off-curve or small-order R would leak sk_s through f, and stall the batch. */
+	    IBIHOP_TRACE_ERROR(IBIHOP_TRACE_UNEXPECTED, '2', session->curve->id, 0);
+	    ibihop_stats_count(IBIHOP_STATS_UNEXPECTED);
+	    return;
+	}
+	session->state = SESSION_PASS3_PENDING;
+	ibihop_stats_queue(pending_count());
+	process_poll(&udp_server_process);
     }
     else if( strncmp(appdata, "4", 1) == 0 )	/*Tag confirmed reader is valid.*/
     {
-    	printf("Reader authentication done!\n");
+	session = session_find(&UIP_IP_BUF->srcipaddr);
+	if(session == NULL || session->state != SESSION_WAIT_S || uip_datalen() < session->curve->digits + 1) {
+	    IBIHOP_TRACE_ERROR(IBIHOP_TRACE_UNEXPECTED, '4', 0, 0);
+	    ibihop_stats_count(IBIHOP_STATS_UNEXPECTED);
+	    return;
+	}
+    	IBIHOP_TRACE_INFO(IBIHOP_TRACE_READER_OK, 0, session->curve->id, 0);
 
-    	for (i = 0; i < NUM_ECC_DIGITS; ++i){
+	N = session->curve->digits;
+    	for (i = 0; i < N; ++i){
 	    s[i] = (uint8_t)appdata[i+1];
     	}
 
-	start_time = clock_time();
-	if (IBIHOP_TagVerf(R, e_inv, s, pk_c) != 0)		/*Tag is authenticated.*/
+	ibihop_pass_begin(IBIHOP_PASS_OPS(session->curve->StatsReset));
+	if (session->curve->TagVerf(session->R, session->e_inv, s, session->keys->pk_c) != 0)		/*Tag is authenticated.*/
 	{
-	    printf("Tag is invalid!\n");
+	    IBIHOP_TRACE_ERROR(IBIHOP_TRACE_TAG_INVALID, 0, session->curve->id, 0);
+	    ibihop_stats_handshake(session->started, 0);
     	}
     	else
     	{
-	    printf("TagVerf: Completion time %lu / %lu\n", (unsigned long)clock_time() - start_time, CLOCK_SECOND);
-	    buf[0] = '5';				
-	    buf[1] = 0;
+	    ibihop_pass_end(IBIHOP_TRACE_TAGVERF, 0, session->curve->id, IBIHOP_PASS_OPS(session->curve->StatsGet));
+	    ibihop_stats_handshake(session->started, 1);
+	    memset(buf, 0, sizeof(buf));
+	    buf[0] = '5';
+	    IBIHOP_TRACE_DEBUG(IBIHOP_TRACE_SENT, '5', session->curve->id, 0);
+	    send_reply(session, buf);
     	}
+	session->state = SESSION_FREE;
     }
     else if(strncmp(appdata, "8", 1) == 0)
     {
-	PRINTF("Reader authentication failed!!\n");
+	IBIHOP_TRACE_ERROR(IBIHOP_TRACE_READER_INVALID, 0, 0, 0);
+	ibihop_stats_count(IBIHOP_STATS_READER_REJECTED);
+	session = session_find(&UIP_IP_BUF->srcipaddr);
+	if(session != NULL) {
+	    ibihop_stats_handshake(session->started, 0);
+	    session->state = SESSION_FREE;
+	}
     }
     else
     {
-	PRINTF("Authentication failed!\n");
-    }
-
-    if(strlen(buf) > 0)	/*Send message to tag.*/
-    {
-	uip_ipaddr_copy(&server_conn->ripaddr, &UIP_IP_BUF->srcipaddr);
-	uip_udp_packet_send(server_conn, buf, sizeof(buf));
-	uip_create_unspecified(&server_conn->ripaddr);
+	IBIHOP_TRACE_ERROR(IBIHOP_TRACE_UNEXPECTED, appdata[0], 0, 0);
+	ibihop_stats_count(IBIHOP_STATS_UNEXPECTED);
     }
   }
 }
@@ -199,6 +465,22 @@ PROCESS_THREAD(udp_server_process, ev, data)
 
   PRINTF("UDP server started\n");
 watchdog_stop();
+#if ECC_FIXED_TABLE
+  if(IBIHOP_FindCurve(ECC_CURVE) == NULL || !ecc_table_open(IBIHOP_FindCurve(ECC_CURVE)->TableInit)) {
+    PRINTF("No generator table for this curve, using the ladder\n");
+  }
+#endif
+  ibihop_stats_init(IBIHOP_STATS_READER);
+  ibihop_trace_init();
+#if ECC_DRBG
+  /* Gather the seed now rather than in the first pass, with the node address mixed in so that Cooja
+     motes, whose simulated RSSI carries little noise, still draw different nonces. */
+  ecc_drbg_seed(linkaddr_node_addr.u8, sizeof(linkaddr_node_addr.u8));
+  {
+    uint8_t l_warmup;
+    ecc_drbg_generate(&l_warmup, 1);
+  }
+#endif
 #if UIP_CONF_ROUTER
 /* The choice of server address determines its 6LoPAN header compression.
  * Obviously the choice made here must also be selected in udp-client.c.
@@ -256,6 +538,8 @@ watchdog_stop();
     PROCESS_YIELD();
     if(ev == tcpip_event) {
       tcpip_handler();
+    } else if(ev == PROCESS_EVENT_POLL) {
+      process_pending();
     } else if (ev == sensors_event && data == &button_sensor) {
       PRINTF("Initiaing global repair\n");
       rpl_repair_root(RPL_DEFAULT_INSTANCE);
@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+#
+# Created by
+#   Nan Li @ CSIRO
+#   nan.li@csiro.au
+#
+# Profiles the ECC code of every IBIHOP pass on the MSP430, with the instruction timing of MSPsim.
+#
+# For every curve, profile.c is built for Tmote Sky and run alone in a headless Cooja simulation. When
+# the mote prints "PROFILE begin <pass>", the script clears the function profiler of MSPsim (CLI command
+# "profile -clear") and starts taking the call stack ("stacktrace") every -i ms of simulated time; on
+# "PROFILE end <pass>" it dumps the profiler ("profile") and the cycles the CPU spent. Out of that,
+# for each curve and pass, in <workdir>/<curve>/:
+#   <pass>.txt      functions sorted by exclusive cycles (or by inclusive ones when the profiler only
+#                   counts those): calls, inclusive and exclusive cycles, share of the pass, and the
+#                   share of the stack samples the function was on top of
+#   <pass>.folded   the stack samples as "P2;EccPoint_mult;XYcZ_add;vli_modMult 123", the input of
+#                   flamegraph.pl, speedscope and the like
+# and, on stdout, a CSV line per curve with the cycles of every pass. The "PROFILE end" printf itself is
+# part of each dump. Cooja has to be built first (ant jar in tools/cooja).
+#
+# usage: sim/profiler.py [-c contiki] [-C secp128r1,secp192r1] [-i ms] [-m NAME=value ...] [-w workdir]
+
+import argparse
+import csv
+import os
+import re
+import shutil
+import subprocess
+import sys
+from collections import Counter
+from xml.sax.saxutils import escape
+
+import scenario
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+REPO = os.path.dirname(HERE)
+CURVES = "secp128r1,secp160r1,secp192r1,secp256r1,curve25519,sect163k1"
+
+SCRIPT = """\
+TIMEOUT(%d, log.testFailed());
+var node = sim.getMoteWithID(1);
+var pass = null;
+var round = 0;
+var started = 0;
+while(true) {
+  if(msg.startsWith("PROFILE begin ")) {
+    pass = msg.split(" ")[2];
+    round++;
+    node.executeCLICommand("profile -clear");
+    started = node.getCPU().cycles;
+    GENERATE_MSG(%d, "PROFILE sample " + round);
+  } else if(msg.startsWith("PROFILE end ")) {
+    log.log("PROFILE cycles " + pass + " " + (node.getCPU().cycles - started) + "\\n");
+    log.log("PROFILE flat " + pass + "\\n" + node.executeCLICommand("profile") + "\\nPROFILE flat end\\n");
+    pass = null;
+  } else if(pass != null && msg.equals("PROFILE sample " + round)) {
+    log.log("PROFILE stack " + pass + "\\n" + node.executeCLICommand("stacktrace") + "\\nPROFILE stack end\\n");
+    GENERATE_MSG(%d, "PROFILE sample " + round);
+  } else if(msg.startsWith("PROFILE done")) {
+    log.log(msg + "\\n");
+    if(msg.indexOf("OK") >= 0) {
+      log.testOK();
+    } else {
+      log.testFailed();
+    }
+  }
+  YIELD();
+}
+"""
+
+NUMBER = re.compile(r"^-?\d+(\.\d+)?$")
+
+
+def profile_scenario(firmware, sample_ms, timeout_s):
+    return """\
+<?xml version="1.0" encoding="UTF-8"?>
+<simconf>
+  <project EXPORT="discard">[APPS_DIR]/mspsim</project>
+  <simulation>
+    <title>IBIHOP profile</title>
+    <randomseed>123456</randomseed>
+    <motedelay_us>0</motedelay_us>
+    <radiomedium>
+      org.contikios.cooja.radiomediums.SilentRadioMedium
+    </radiomedium>
+    <events>
+      <logoutput>40000</logoutput>
+    </events>
+%s%s  </simulation>
+  <plugin>
+    org.contikios.cooja.plugins.ScriptRunner
+    <plugin_config>
+      <script>%s</script>
+      <active>true</active>
+    </plugin_config>
+    <width>600</width>
+    <z>0</z>
+    <height>700</height>
+    <location_x>0</location_x>
+    <location_y>0</location_y>
+  </plugin>
+</simconf>
+""" % (scenario.motetype("profile", "IBIHOP profile", firmware), scenario.mote(1, 0.0, 0.0, "profile"),
+       escape(SCRIPT % (timeout_s * 1000, sample_ms, sample_ms)))
+
+
+def blocks(log):
+    """Yields (kind, pass, lines) for the PROFILE blocks the script logged, and ("cycles", pass, n)."""
+    block = None
+    for line in log:
+        line = line.rstrip("\n")
+        if block is not None:
+            if line == "PROFILE %s end" % block[0]:
+                yield block
+                block = None
+            else:
+                block[2].append(line)
+            continue
+        fields = line.split()
+        if len(fields) == 4 and fields[:2] == ["PROFILE", "cycles"]:
+            yield ("cycles", fields[2], int(fields[3]))
+        elif len(fields) == 3 and fields[0] == "PROFILE" and fields[1] in ("flat", "stack"):
+            block = (fields[1], fields[2], [])
+
+
+def parse_flat(lines):
+    """Rows of the MSPsim profile table as {function, calls, inclusive, exclusive}, whatever its columns."""
+    columns = None
+    rows = []
+    for line in lines:
+        fields = line.split()
+        if not fields:
+            continue
+        if fields[0] == "Function":
+            columns = [c.lower() for c in fields[1:]]
+            continue
+        if columns is None or len(fields) != len(columns) + 1 or not all(NUMBER.match(f) for f in fields[1:]):
+            continue
+        row = {"function": fields[0], "calls": 0, "inclusive": None, "exclusive": None}
+        for name, value in zip(columns, fields[1:]):
+            if name.startswith("call"):
+                row["calls"] = int(float(value))
+            elif name.startswith("tot") or name == "cycles":
+                row["inclusive"] = int(float(value))
+            elif name.startswith("exc") or name.startswith("ex."):
+                row["exclusive"] = int(float(value))
+        rows.append(row)
+    return rows
+
+
+def parse_stack(lines):
+    """The functions of an MSPsim stack trace, outermost first."""
+    stack = []
+    for line in lines:
+        fields = line.split()
+        if not fields or fields[0].startswith("Stack") or fields[0].startswith("No"):
+            continue
+        stack.append(fields[0].rstrip(":").replace("()", ""))
+    stack.reverse()		# MSPsim prints the innermost call first
+    return stack
+
+
+def report(out, curve, name, cycles, flat, samples):
+    tops = Counter()
+    for stack, count in samples.items():
+        if stack:
+            tops[stack[-1]] += count
+    total_samples = sum(samples.values())
+    exclusive = any(row["exclusive"] is not None for row in flat)
+    key = "exclusive" if exclusive else "inclusive"
+    flat = sorted(flat, key=lambda row: row[key] or 0, reverse=True)
+
+    out.write("%s %s: %s cycles, %d stack samples\n" % (curve, name, cycles if cycles is not None else "?",
+                                                       total_samples))
+    out.write("sorted by %s cycles\n\n" % key)
+    out.write("%-32s %8s %12s %12s %7s %8s\n" % ("function", "calls", "inclusive", "exclusive", "% pass",
+                                                   "% top"))
+    for row in flat:
+        share = (row[key] or 0) * 100.0 / cycles if cycles else 0.0
+        top = tops[row["function"]] * 100.0 / total_samples if total_samples else 0.0
+        out.write("%-32s %8d %12s %12s %6.1f%% %7.1f%%\n" % (
+            row["function"], row["calls"], row["inclusive"] if row["inclusive"] is not None else "-",
+            row["exclusive"] if row["exclusive"] is not None else "-", share, top))
+
+
+def collect(testlog, curve, outdir):
+    """Writes the reports of one curve and returns {pass: cycles}."""
+    cycles = {}
+    flats = {}
+    samples = {}
+    with open(testlog) as log:
+        for kind, name, data in blocks(log):
+            if kind == "cycles":
+                cycles[name] = data
+            elif kind == "flat":
+                flats[name] = parse_flat(data)
+            else:
+                samples.setdefault(name, Counter())[tuple(parse_stack(data))] += 1
+
+    for name in flats:
+        with open(os.path.join(outdir, name + ".txt"), "w") as out:
+            report(out, curve, name, cycles.get(name), flats[name], samples.get(name, Counter()))
+        with open(os.path.join(outdir, name + ".folded"), "w") as out:
+            for stack, count in sorted(samples.get(name, Counter()).items()):
+                out.write("%s %d\n" % (";".join((name,) + stack), count))
+    return cycles
+
+
+def run(args, curve):
+    outdir = os.path.join(args.workdir, curve)
+    os.makedirs(outdir, exist_ok=True)
+    make = ["make", "-C", REPO, "TARGET=sky", "CONTIKI=" + args.contiki, "ECC_CURVE=" + curve] + args.make
+    subprocess.check_call(make + ["clean"], stdout=subprocess.DEVNULL)
+    subprocess.check_call(make + ["profile.sky"])
+    firmware = os.path.join(outdir, "profile.sky")
+    shutil.copy(os.path.join(REPO, "profile.sky"), firmware)
+
+    csc = os.path.join(outdir, "profile.csc")
+    with open(csc, "w") as f:
+        f.write(profile_scenario(firmware, args.interval, args.timeout))
+    cooja = os.path.join(args.contiki, "tools", "cooja", "dist", "cooja.jar")
+    with open(os.path.join(outdir, "cooja.out"), "w") as out:
+        status = subprocess.call(["java", "-mx2048m", "-jar", cooja, "-nogui=" + csc, "-contiki=" + args.contiki],
+                                 cwd=outdir, stdout=out, stderr=subprocess.STDOUT)
+    testlog = os.path.join(outdir, "COOJA.testlog")
+    if status != 0 or not os.path.exists(testlog):
+        print("%s: cooja exited with %d, see %s/cooja.out" % (curve, status, outdir), file=sys.stderr)
+        return None
+    return collect(testlog, curve, outdir)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Profile the IBIHOP passes per function in MSPsim.")
+    parser.add_argument("-c", "--contiki", default=os.path.normpath(os.path.join(REPO, "..", "..")))
+    parser.add_argument("-C", "--curves", default=CURVES)
+    parser.add_argument("-i", "--interval", type=int, default=1, help="stack sample interval in simulated ms")
+    parser.add_argument("-t", "--timeout", type=int, default=3600, help="simulated seconds per curve")
+    parser.add_argument("-m", "--make", action="append", default=[], help="NAME=value passed on to make")
+    parser.add_argument("-w", "--workdir", default=os.path.join(HERE, "out", "profile"))
+    parser.add_argument("--parse", metavar="TESTLOG", help="only write the reports of a COOJA.testlog "
+                        "(of the first curve given) into the work directory")
+    args = parser.parse_args()
+    args.contiki = os.path.abspath(args.contiki)
+    args.workdir = os.path.abspath(args.workdir)
+
+    curves = args.curves.split(",")
+    if args.parse:
+        os.makedirs(args.workdir, exist_ok=True)
+        collect(args.parse, curves[0], args.workdir)
+        return
+
+    writer = csv.writer(sys.stdout)
+    writer.writerow(["curve", "P1", "P2", "P3", "P4", "TagVerf"])
+    failures = 0
+    for curve in curves:
+        cycles = run(args, curve)
+        if cycles is None:
+            failures += 1
+            continue
+        writer.writerow([curve] + [cycles.get(name, "") for name in ("P1", "P2", "P3", "P4", "TagVerf")])
+        sys.stdout.flush()
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
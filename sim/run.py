@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+#
+# Created by
+#   Nan Li @ CSIRO
+#   nan.li@csiro.au
+#
+# Runs the IBIHOP Cooja scenarios headless and writes one CSV row per run.
+#
+# The tag and reader are built once for Tmote Sky (WITH_COMPOWER=1 for powertrace, PERIOD for the
+# hello interval, plus any NAME=value given with -m), then every combination of tags, topology and
+# loss is written by scenario.py and run with cooja.jar -nogui. From the COOJA.testlog of a run:
+#   hellos, completed, failed   tag lines "Sending hello", "OK! Mutual authentication succeed!",
+#                               "Reader is invalid!" and reader lines "Tag is invalid!"
+#   success_rate                completed / hellos; a hello the reader drops is retried a period later
+#   latency_p50/p90/max_s       from a tag's last hello to its "OK!" line
+#   duty_cycle_pct              radio-on time of the tags from their last powertrace line, averaged
+#   throughput_per_min          handshakes completed per simulated minute
+# Cooja has to be built first (ant jar in tools/cooja).
+#
+# usage: sim/run.py [-c contiki] [-t 1,10,50,200] [-T single,multi] [-l 0,0.1] [-d seconds] [-p period]
+#                   [-s seed] [-m NAME=value ...] [-o results.csv]
+
+import argparse
+import csv
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+import scenario
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+REPO = os.path.dirname(HERE)
+READER = 1
+
+POWERTRACE = re.compile(r"\(radio (\d+)\.(\d+)% /")
+FIELDS = ["tags", "topology", "loss", "seed", "duration_s", "hellos", "completed", "failed", "success_rate",
+          "latency_p50_s", "latency_p90_s", "latency_max_s", "duty_cycle_pct", "throughput_per_min"]
+
+
+def build(args, firmware_dir):
+    make = ["make", "-C", REPO, "TARGET=sky", "CONTIKI=" + args.contiki, "WITH_COMPOWER=1",
+            "PERIOD=%d" % args.period] + args.make
+    for app in ("client", "server"):
+        subprocess.check_call(make + [app + ".sky"])
+        shutil.copy(os.path.join(REPO, app + ".sky"), firmware_dir)
+
+
+def percentile(values, p):
+    if not values:
+        return ""
+    values = sorted(values)
+    return "%.3f" % values[min(len(values) - 1, int(p * len(values)))]
+
+
+def parse(log, duration):
+    hellos = completed = failed = 0
+    last_hello = {}
+    latencies = []
+    radio = {}
+
+    for line in log:
+        fields = line.split(" ", 2)
+        if len(fields) < 3 or not fields[0].isdigit():
+            continue
+        t, mote, msg = int(fields[0]) / 1e6, int(fields[1]), fields[2]
+        if mote == READER:
+            if msg.startswith("Tag is invalid!"):
+                failed += 1
+            continue
+        if msg.startswith("Sending hello"):
+            hellos += 1
+            last_hello[mote] = t
+        elif msg.startswith("OK! Mutual authentication succeed!"):
+            completed += 1
+            if mote in last_hello:
+                latencies.append(t - last_hello.pop(mote))
+        elif msg.startswith("Reader is invalid!"):
+            failed += 1
+        elif msg.startswith("#P"):
+            m = POWERTRACE.search(msg)
+            if m:
+                radio[mote] = int(m.group(1)) + int(m.group(2)) / 100.0
+
+    return {
+        "hellos": hellos,
+        "completed": completed,
+        "failed": failed,
+        "success_rate": "%.3f" % (completed / hellos) if hellos else "",
+        "latency_p50_s": percentile(latencies, 0.5),
+        "latency_p90_s": percentile(latencies, 0.9),
+        "latency_max_s": "%.3f" % max(latencies) if latencies else "",
+        "duty_cycle_pct": "%.2f" % (sum(radio.values()) / len(radio)) if radio else "",
+        "throughput_per_min": "%.2f" % (completed * 60.0 / duration),
+    }
+
+
+def run(args, firmware_dir, tags, topology, loss):
+    name = "ibihop-%d-%s-loss%g" % (tags, topology, loss)
+    rundir = os.path.join(args.workdir, name)
+    os.makedirs(rundir, exist_ok=True)
+    csc = os.path.join(rundir, name + ".csc")
+    with open(csc, "w") as f:
+        f.write(scenario.scenario(tags, topology, loss, args.duration, args.seed, firmware_dir))
+
+    cooja = os.path.join(args.contiki, "tools", "cooja", "dist", "cooja.jar")
+    with open(os.path.join(rundir, "cooja.out"), "w") as out:
+        status = subprocess.call(["java", "-mx2048m", "-jar", cooja, "-nogui=" + csc, "-contiki=" + args.contiki],
+                                 cwd=rundir, stdout=out, stderr=subprocess.STDOUT)
+    if status != 0:
+        print("%s: cooja exited with %d, see %s/cooja.out" % (name, status, rundir), file=sys.stderr)
+    testlog = os.path.join(rundir, "COOJA.testlog")
+    if not os.path.exists(testlog):
+        return None
+    with open(testlog) as log:
+        row = parse(log, args.duration)
+    row.update({"tags": tags, "topology": topology, "loss": loss, "seed": args.seed, "duration_s": args.duration})
+    return row
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run the IBIHOP Cooja scenarios headless into a CSV file.")
+    parser.add_argument("-c", "--contiki", default=os.path.normpath(os.path.join(REPO, "..", "..")))
+    parser.add_argument("-t", "--tags", default="1,10,50,200")
+    parser.add_argument("-T", "--topology", default="single,multi")
+    parser.add_argument("-l", "--loss", default="0")
+    parser.add_argument("-d", "--duration", type=int, default=1800, help="simulated seconds per run")
+    parser.add_argument("-p", "--period", type=int, default=60, help="hello interval of the tags in seconds")
+    parser.add_argument("-s", "--seed", type=int, default=123456)
+    parser.add_argument("-m", "--make", action="append", default=[], help="NAME=value passed on to make")
+    parser.add_argument("-w", "--workdir", default=os.path.join(HERE, "out"))
+    parser.add_argument("-o", "--output", default="-")
+    parser.add_argument("--no-build", action="store_true", help="reuse the firmware of the last run")
+    args = parser.parse_args()
+    args.contiki = os.path.abspath(args.contiki)
+    args.workdir = os.path.abspath(args.workdir)
+
+    firmware_dir = os.path.join(args.workdir, "firmware")
+    os.makedirs(firmware_dir, exist_ok=True)
+    if not args.no_build:
+        build(args, firmware_dir)
+
+    out = sys.stdout if args.output == "-" else open(args.output, "w", newline="")
+    writer = csv.DictWriter(out, fieldnames=FIELDS)
+    writer.writeheader()
+    failures = 0
+    for topology in args.topology.split(","):
+        for tags in [int(t) for t in args.tags.split(",")]:
+            for loss in [float(l) for l in args.loss.split(",")]:
+                row = run(args, firmware_dir, tags, topology, loss)
+                if row is None:
+                    failures += 1
+                    continue
+                writer.writerow(row)
+                out.flush()
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+#
+# Created by
+#   Nan Li @ CSIRO
+#   nan.li@csiro.au
+#
+# Writes a Cooja simulation (.csc) of one IBIHOP reader and a number of tags, all Tmote Sky.
+# The reader is mote 1 at the origin (the tags send their hellos to aaaa::ff:fe00:1, see client.c).
+#   single  the tags are spread over a disc of SINGLE_RADIUS m around the reader, all in its range
+#   multi   the reader and the tags fill a square grid GRID_STEP m apart, so the far tags are several
+#           RPL hops away (a single tag is still one hop from the reader)
+# Loss is the UDGM reception failure ratio, applied to every frame in range.
+# The script plugin logs "time_us mote_id line" for every serial line into COOJA.testlog and stops
+# the simulation after the given duration; sim/run.py reads that log.
+#
+# usage: sim/scenario.py [-l loss] [-d seconds] [-s seed] [-f firmware_dir] tags single|multi > file.csc
+
+import argparse
+import math
+import sys
+from xml.sax.saxutils import escape
+
+RANGE = 50.0
+INTERFERENCE = 100.0
+SINGLE_RADIUS = 40.0
+GRID_STEP = 35.0
+
+MOTE_INTERFACES = """\
+      <moteinterface>org.contikios.cooja.interfaces.Position</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.RimeAddress</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.IPAddress</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.Mote2MoteRelations</moteinterface>
+      <moteinterface>org.contikios.cooja.interfaces.MoteAttributes</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspClock</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspMoteID</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyButton</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyFlash</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyCoffeeFilesystem</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.Msp802154Radio</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspSerial</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyLED</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.MspDebugOutput</moteinterface>
+      <moteinterface>org.contikios.cooja.mspmote.interfaces.SkyTemperature</moteinterface>
+"""
+
+SCRIPT = """\
+TIMEOUT(%d, log.testOK());
+while(true) {
+  log.log(time + " " + id + " " + msg + "\\n");
+  YIELD();
+}
+"""
+
+
+def positions(tags, topology):
+    """Reader first, then the tags."""
+    if topology == "single":
+        # Sunflower spiral: even density over the disc, nobody on top of the reader.
+        golden = math.pi * (3 - math.sqrt(5))
+        return [(0.0, 0.0)] + [(SINGLE_RADIUS * math.sqrt((k + 0.5) / tags) * math.cos(k * golden),
+                                SINGLE_RADIUS * math.sqrt((k + 0.5) / tags) * math.sin(k * golden))
+                               for k in range(tags)]
+    side = int(math.ceil(math.sqrt(tags + 1)))
+    return [((k % side) * GRID_STEP, (k // side) * GRID_STEP) for k in range(tags + 1)]
+
+
+def motetype(identifier, description, firmware):
+    return """\
+    <motetype>
+      org.contikios.cooja.mspmote.SkyMoteType
+      <identifier>%s</identifier>
+      <description>%s</description>
+      <firmware EXPORT="copy">%s</firmware>
+%s    </motetype>
+""" % (identifier, description, firmware, MOTE_INTERFACES)
+
+
+def mote(mote_id, x, y, identifier):
+    return """\
+    <mote>
+      <breakpoints />
+      <interface_config>
+        org.contikios.cooja.interfaces.Position
+        <x>%.1f</x>
+        <y>%.1f</y>
+        <z>0.0</z>
+      </interface_config>
+      <interface_config>
+        org.contikios.cooja.mspmote.interfaces.MspMoteID
+        <id>%d</id>
+      </interface_config>
+      <motetype_identifier>%s</motetype_identifier>
+    </mote>
+""" % (x, y, mote_id, identifier)
+
+
+def scenario(tags, topology, loss=0.0, duration=1800, seed=123456, firmware_dir="[CONFIG_DIR]/.."):
+    out = ["""\
+<?xml version="1.0" encoding="UTF-8"?>
+<simconf>
+  <project EXPORT="discard">[APPS_DIR]/mspsim</project>
+  <project EXPORT="discard">[APPS_DIR]/powertracker</project>
+  <simulation>
+    <title>IBIHOP %d tags %s-hop loss %g</title>
+    <randomseed>%d</randomseed>
+    <motedelay_us>1000000</motedelay_us>
+    <radiomedium>
+      org.contikios.cooja.radiomediums.UDGM
+      <transmitting_range>%.1f</transmitting_range>
+      <interference_range>%.1f</interference_range>
+      <success_ratio_tx>1.0</success_ratio_tx>
+      <success_ratio_rx>%g</success_ratio_rx>
+    </radiomedium>
+    <events>
+      <logoutput>40000</logoutput>
+    </events>
+""" % (tags, topology, loss, seed, RANGE, INTERFERENCE, 1.0 - loss)]
+    out.append(motetype("reader", "IBIHOP reader", firmware_dir + "/server.sky"))
+    out.append(motetype("tag", "IBIHOP tag", firmware_dir + "/client.sky"))
+    for k, (x, y) in enumerate(positions(tags, topology)):
+        out.append(mote(k + 1, x, y, "reader" if k == 0 else "tag"))
+    out.append("""\
+  </simulation>
+  <plugin>
+    org.contikios.cooja.plugins.ScriptRunner
+    <plugin_config>
+      <script>%s</script>
+      <active>true</active>
+    </plugin_config>
+    <width>600</width>
+    <z>0</z>
+    <height>700</height>
+    <location_x>0</location_x>
+    <location_y>0</location_y>
+  </plugin>
+</simconf>
+""" % escape(SCRIPT % (duration * 1000)))
+    return "".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Write a Cooja simulation of an IBIHOP reader and tags.")
+    parser.add_argument("tags", type=int)
+    parser.add_argument("topology", choices=["single", "multi"])
+    parser.add_argument("-l", "--loss", type=float, default=0.0)
+    parser.add_argument("-d", "--duration", type=int, default=1800, help="simulated seconds")
+    parser.add_argument("-s", "--seed", type=int, default=123456)
+    parser.add_argument("-f", "--firmware-dir", default="[CONFIG_DIR]/..")
+    args = parser.parse_args()
+    sys.stdout.write(scenario(args.tags, args.topology, args.loss, args.duration, args.seed, args.firmware_dir))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,56 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+*/
+#include "stack-watermark.h"
+#include <stdint.h>
+
+#define STACK_WATERMARK_PATTERN 0xA5
+
+/* Room left for the frame of the paint and scan functions themselves. */
+#define STACK_WATERMARK_MARGIN 32
+
+#ifdef __MSP430__
+extern int __bss_end;	/* first byte after .bss, from the linker script; the stack grows down towards it */
+#endif
+
+static volatile uint8_t *watermark_low;
+static volatile uint8_t *watermark_top;
+
+void stack_watermark_paint(void)
+{
+    volatile uint8_t l_here;
+    volatile uint8_t *p;
+
+    watermark_top = &l_here - STACK_WATERMARK_MARGIN;
+    watermark_low = watermark_top - STACK_WATERMARK_SIZE;
+#ifdef __MSP430__
+    if(watermark_low < (volatile uint8_t *)&__bss_end)
+    {
+        watermark_low = (volatile uint8_t *)&__bss_end;
+    }
+#endif
+
+    for(p = watermark_low; p < watermark_top; ++p)
+    {
+        *p = STACK_WATERMARK_PATTERN;
+    }
+}
+
+unsigned stack_watermark_used(void)
+{
+    volatile uint8_t *p;
+
+    for(p = watermark_low; p < watermark_top && *p == STACK_WATERMARK_PATTERN; ++p)
+    {
+    }
+    if(p == watermark_top)
+    {
+        return 0;
+    }
+    return (unsigned)(watermark_top + STACK_WATERMARK_MARGIN - p);
+}
@@ -0,0 +1,37 @@
+/*
+
+Created by
+
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Stack high-water marks for the IBIHOP passes (STACK_WATERMARK=1): the free stack below the caller is painted
+with a pattern before a pass, and the lowest byte that no longer holds it after the pass gives the peak depth.
+Interrupt handlers that ran in between are counted too, which is what the RAM headroom has to cover.
+*/
+#ifndef STACK_WATERMARK_H_
+#define STACK_WATERMARK_H_
+
+/* Bytes painted below the caller's frame. A pass that goes deeper is reported as this size. On MSP430 the
+   painting also stops at the end of .bss. */
+#ifndef STACK_WATERMARK_SIZE
+#define STACK_WATERMARK_SIZE 2048
+#endif
+
+/*
+stack_watermark_paint:
+	Paint the STACK_WATERMARK_SIZE bytes below the caller's frame, just before the pass. ibihop_pass_begin()
+	calls it, and ibihop_pass_end() reads the mark from the same depth.
+*/
+void stack_watermark_paint(void);
+
+/*
+stack_watermark_used:
+	Peak stack use below the caller's frame since the last stack_watermark_paint(), called from the same function.
+Output:
+	Bytes from the caller's frame down to the lowest overwritten byte. If the whole painted area was overwritten
+	(STACK_WATERMARK_SIZE plus a few bytes), the pass may have gone deeper.
+*/
+unsigned stack_watermark_used(void);
+
+#endif /* STACK_WATERMARK_H_ */
@@ -0,0 +1,71 @@
+/*
+
+Created
+  based on nano-ecc: https://github.com/iSECPartners/nano-ecc
+by
+  Nan Li @ CSIRO
+  nan.li@csiro.au
+
+Writes the generator table for ECC_FIXED_TABLE (layout in nano-ecc.h) for one curve. Row i holds
+j*B for j = 1..255 with B = 2^(8i)*G; each entry is one mixed addition away from the previous one,
+and the next row starts from 256*B. For curve25519 the points are those of the short Weierstrass form.
+
+usage: cc -O2 -DECC_CURVE=secp192r1 -o gen-table tools/gen-table.c
+       ./gen-table ecc-table.bin
+*/
+
+#undef ECC_FIXED_TABLE
+#define ECC_FIXED_TABLE 1
+#include "../nano-ecc.c"
+
+int main(int argc, char **argv)
+{
+    uint8_t l_header[ECC_TABLE_HEADER] = {'E', 'C', (uint8_t)ECC_CURVE, (uint8_t)(ECC_CURVE >> 8)};
+    uint8_t X[NUM_ECC_DIGITS], Y[NUM_ECC_DIGITS], Z[NUM_ECC_DIGITS];
+    uint8_t l_inverse[NUM_ECC_DIGITS];
+    EccPoint l_base;
+    EccPoint l_entry;
+    FILE *l_file;
+    uint i, j;
+
+    EccPoint_table_G(&l_base);
+
+    if(argc != 2)
+    {
+        fprintf(stderr, "usage: %s <table.bin>\n", argv[0]);
+        return 2;
+    }
+    l_file = fopen(argv[1], "wb");
+    if(l_file == NULL)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    fwrite(l_header, 1, ECC_TABLE_HEADER, l_file);
+    for(i = 0; i < NUM_ECC_DIGITS; ++i)
+    {
+        vli_clear(Z);
+        for(j = 1; j <= ECC_TABLE_ROW + 1; ++j)
+        {
+            EccPoint_add_mixed(X, Y, Z, l_base.x, l_base.y);
+            vli_modInv_fast(l_inverse, Z);
+            vli_set(l_entry.x, X);
+            vli_set(l_entry.y, Y);
+            apply_z(l_entry.x, l_entry.y, l_inverse);
+            if(j <= ECC_TABLE_ROW)
+            {
+                fwrite(&l_entry, sizeof(EccPoint), 1, l_file);
+            }
+        }
+        l_base = l_entry; /* 256 * B */
+    }
+
+    if(fclose(l_file) != 0)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    fprintf(stderr, "%s: %lu bytes\n", argv[1], (unsigned long)ECC_TABLE_SIZE);
+    return 0;
+}
@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+#
+# Created
+#   based on nano-ecc: https://github.com/iSECPartners/nano-ecc
+# by
+#   Nan Li @ CSIRO
+#   nan.li@csiro.au
+#
+# Generates nano-ecc-unrolled.inc: straight-line, curve-specialized field kernels for nano-ecc.c
+# (ECC_UNROLL=1). For every curve it emits vli_add, vli_sub, vli_modAdd, vli_modSub, vli_mult,
+# vli_square and vli_mmod_fast with all loop bounds resolved and no data-dependent branches.
+#
+# The reduction is derived from p itself: with K = NUM_ECC_DIGITS and 2^(8K) = c (mod p), every
+# byte j >= K of the product is folded down as sum(coef * 2^(8i)), i < K, by substituting c until
+# nothing is left above byte K-1. Each result byte is then one column of signed byte terms. The
+# carry out of the top byte is folded back in twice and p is subtracted at most once (twice for
+# curve25519); the bounds that make this enough are checked here, from the worst case of every column.
+# secp160r1 has no c: its p ends a byte below 2^(8K), which would take up to 255 subtractions, so it
+# keeps the vli_mmod_fast of nano-ecc.c and only gets the other kernels.
+#
+# usage: tools/gen-unrolled.py > nano-ecc-unrolled.inc
+
+import sys
+
+# (name, NUM_ECC_DIGITS, p, c as [(byte shift, coefficient)] or None).
+CURVES = [
+    ("secp128r1", 16, 2**128 - 2**97 - 1,
+     [(0, 1), (12, 2)]),
+    ("secp160r1", 21, 2**160 - 2**31 - 1,
+     None),
+    ("secp192r1", 24, 2**192 - 2**64 - 1,
+     [(0, 1), (8, 1)]),
+    ("secp256r1", 32, 2**256 - 2**224 + 2**192 + 2**96 - 1,
+     [(0, 1), (12, -1), (24, -1), (28, 1)]),
+    ("secp384r1", 48, 2**384 - 2**128 - 2**96 + 2**32 - 1,
+     [(0, 1), (4, -1), (12, 1), (16, 1)]),
+    ("curve25519", 32, 2**255 - 19,
+     [(0, 38)]),
+]
+
+
+def emit_add(out, k):
+    out.append("/* Computes p_result = p_left + p_right, returning carry. Can modify in place. */")
+    out.append("static uint8_t vli_add(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right)")
+    out.append("{")
+    out.append("    uint16_t l_sum;")
+    out.append("    l_sum = (uint16_t)p_left[0] + p_right[0]; p_result[0] = (uint8_t)l_sum;")
+    for i in range(1, k):
+        out.append("    l_sum = (uint16_t)p_left[%d] + p_right[%d] + (l_sum >> 8); p_result[%d] = (uint8_t)l_sum;"
+                   % (i, i, i))
+    out.append("    return (uint8_t)(l_sum >> 8);")
+    out.append("}")
+    out.append("")
+
+
+def emit_sub(out, k):
+    out.append("/* Computes p_result = p_left - p_right, returning borrow. Can modify in place. */")
+    out.append("uint8_t vli_sub(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right)")
+    out.append("{")
+    out.append("    uint16_t l_diff;")
+    out.append("    l_diff = (uint16_t)p_left[0] - p_right[0]; p_result[0] = (uint8_t)l_diff;")
+    for i in range(1, k):
+        out.append("    l_diff = (uint16_t)p_left[%d] - p_right[%d] - (l_diff >> 15); p_result[%d] = (uint8_t)l_diff;"
+                   % (i, i, i))
+    out.append("    return (uint8_t)(l_diff >> 15);")
+    out.append("}")
+    out.append("")
+
+
+def emit_modadd(out, k):
+    out.append("/* Computes p_result = (p_left + p_right) % p_mod.")
+    out.append("   Assumes that p_left < p_mod and p_right < p_mod, p_result != p_mod. */")
+    out.append("void vli_modAdd(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right, uint8_t *p_mod)")
+    out.append("{")
+    out.append("    uint8_t l_trial[NUM_ECC_DIGITS];")
+    out.append("    uint8_t l_carry = vli_add(p_result, p_left, p_right);")
+    out.append("    uint8_t l_borrow = vli_sub(l_trial, p_result, p_mod);")
+    out.append("    uint8_t l_mask = -(uint8_t)(l_carry | (l_borrow ^ 1)); /* 0xff: the sum was >= p_mod */")
+    for i in range(k):
+        out.append("    p_result[%d] = (l_trial[%d] & l_mask) | (p_result[%d] & ~l_mask);" % (i, i, i))
+    out.append("}")
+    out.append("")
+
+
+def emit_modsub(out, k):
+    out.append("/* Computes p_result = (p_left - p_right) % p_mod.")
+    out.append("   Assumes that p_left < p_mod and p_right < p_mod, p_result != p_mod. */")
+    out.append("void vli_modSub(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right, uint8_t *p_mod)")
+    out.append("{")
+    out.append("    uint8_t l_mask = -vli_sub(p_result, p_left, p_right); /* 0xff: add p_mod back */")
+    out.append("    uint16_t l_sum;")
+    out.append("    l_sum = (uint16_t)p_result[0] + (p_mod[0] & l_mask); p_result[0] = (uint8_t)l_sum;")
+    for i in range(1, k):
+        out.append("    l_sum = (uint16_t)p_result[%d] + (p_mod[%d] & l_mask) + (l_sum >> 8); p_result[%d] = (uint8_t)l_sum;"
+                   % (i, i, i))
+    out.append("}")
+    out.append("")
+
+
+def emit_mult(out, k):
+    out.append("/* Computes p_result = p_left * p_right. */")
+    out.append("static void vli_mult(uint8_t *p_result, uint8_t *p_left, uint8_t *p_right)")
+    out.append("{")
+    out.append("    uint16_t r01 = 0;")
+    out.append("    uint8_t r2 = 0;")
+    out.append("    uint16_t l_product;")
+    for col in range(2 * k - 1):
+        for i in range(max(0, col - k + 1), min(col, k - 1) + 1):
+            out.append("    l_product = (uint16_t)p_left[%d] * p_right[%d]; r01 += l_product; r2 += (r01 < l_product);"
+                       % (i, col - i))
+        out.append("    p_result[%d] = (uint8_t)r01; r01 = (r01 >> 8) | (((uint16_t)r2) << 8); r2 = 0;" % col)
+    out.append("    p_result[%d] = (uint8_t)r01;" % (2 * k - 1))
+    out.append("}")
+    out.append("")
+
+
+def emit_square(out, k):
+    out.append("/* Computes p_result = p_left^2. */")
+    out.append("static void vli_square(uint8_t *p_result, uint8_t *p_left)")
+    out.append("{")
+    out.append("    uint16_t r01 = 0;")
+    out.append("    uint8_t r2 = 0;")
+    out.append("    uint16_t l_product;")
+    for col in range(2 * k - 1):
+        for i in range(max(0, col - k + 1), col // 2 + 1):
+            j = col - i
+            if i < j:
+                out.append("    l_product = (uint16_t)p_left[%d] * p_left[%d]; r2 += l_product >> 15; l_product *= 2;"
+                           " r01 += l_product; r2 += (r01 < l_product);" % (i, j))
+            else:
+                out.append("    l_product = (uint16_t)p_left[%d] * p_left[%d]; r01 += l_product; r2 += (r01 < l_product);"
+                           % (i, j))
+        out.append("    p_result[%d] = (uint8_t)r01; r01 = (r01 >> 8) | (((uint16_t)r2) << 8); r2 = 0;" % col)
+    out.append("    p_result[%d] = (uint8_t)r01;" % (2 * k - 1))
+    out.append("}")
+    out.append("")
+
+
+def fold(k, terms):
+    """Returns, for every product byte j < 2k, {i: coef} with 2^(8j) = sum(coef * 2^(8i)) (mod p), i < k."""
+    table = []
+    for j in range(2 * k):
+        if j < k:
+            table.append({j: 1})
+            continue
+        row = {}
+        for shift, coef in terms:
+            for i, c in table[j - k + shift].items():
+                row[i] = row.get(i, 0) + coef * c
+        table.append({i: c for i, c in row.items() if c})
+    return table
+
+
+def emit_mmod(out, k, p, terms):
+    c = sum(coef * 2**(8 * shift) for shift, coef in terms)
+    assert (2**(8 * k) - c) % p == 0
+    table = fold(k, terms)
+
+    columns = [[] for _ in range(k)]
+    for j in range(2 * k):
+        for i, coef in sorted(table[j].items()):
+            assert abs(coef) * 255 < 2**15
+            columns[i].append((j, coef))
+
+    # Worst-case range of the accumulator, to check that it fits and to bound the final carry.
+    lo = hi = 0
+    for col in columns:
+        lo += sum(coef * 255 for _, coef in col if coef < 0)
+        hi += sum(coef * 255 for _, coef in col if coef > 0)
+        assert -2**31 < lo and hi < 2**31
+        lo >>= 8
+        hi >>= 8
+    carry_max = max(-lo, hi)
+    # Two folds of the carry leave nothing above byte k-1 when (carry_max + 1) * c < 2^(8k).
+    # The result is then below 2^(8k): one conditional subtraction of p where 2^(8k) < 2p,
+    # two for curve25519 (2^256 = 2p + 38).
+    assert (carry_max + 1) * c < 2**(8 * k) and c < p
+    subtractions = (2**(8 * k) - 1) // p
+
+    out.append("/* Computes p_result = p_product %% curve_p. Carries out of the columns are at most %d"
+               % carry_max)
+    out.append("   in magnitude. */")
+    out.append("static void vli_mmod_fast(uint8_t *p_result, uint8_t *p_product)")
+    out.append("{")
+    out.append("    uint8_t l_trial[NUM_ECC_DIGITS];")
+    out.append("    int32_t l_acc = 0;")
+    out.append("    int32_t l_carry;")
+    out.append("    uint8_t l_mask;")
+    for i, col in enumerate(columns):
+        for j, coef in col:
+            if coef == 1:
+                out.append("    l_acc += p_product[%d];" % j)
+            elif coef == -1:
+                out.append("    l_acc -= p_product[%d];" % j)
+            elif coef > 0:
+                out.append("    l_acc += %d * p_product[%d];" % (coef, j))
+            else:
+                out.append("    l_acc -= %d * p_product[%d];" % (-coef, j))
+        out.append("    p_result[%d] = (uint8_t)l_acc; l_acc >>= 8;" % i)
+    for _ in range(2):
+        out.append("    l_carry = l_acc; l_acc = 0;")
+        shifts = dict(terms)
+        for i in range(k):
+            if i in shifts:
+                coef = shifts[i]
+                expr = "l_carry" if coef == 1 else "%d * l_carry" % coef
+                if coef == -1:
+                    out.append("    l_acc += (int32_t)p_result[%d] - l_carry;" % i)
+                else:
+                    out.append("    l_acc += (int32_t)p_result[%d] + %s;" % (i, expr))
+            else:
+                out.append("    l_acc += p_result[%d];" % i)
+            out.append("    p_result[%d] = (uint8_t)l_acc; l_acc >>= 8;" % i)
+    for _ in range(subtractions):
+        out.append("    l_mask = vli_sub(l_trial, p_result, curve_p) - 1; /* 0xff: p_result >= curve_p */")
+        for i in range(k):
+            out.append("    p_result[%d] = (l_trial[%d] & l_mask) | (p_result[%d] & ~l_mask);" % (i, i, i))
+    out.append("}")
+    out.append("")
+
+
+def main():
+    out = []
+    out.append("/* Generated by tools/gen-unrolled.py for ECC_UNROLL=1. Do not edit. */")
+    out.append("")
+    out.append("#define ECC_UNROLL_ADD 1")
+    out.append("#if (ECC_ASM == ecc_asm_none)")
+    out.append("    #define ECC_ASM_MULT 1")
+    out.append("    #define ECC_ASM_SQUARE 1")
+    out.append("#endif")
+    out.append("")
+    first = True
+    for name, k, p, terms in CURVES:
+        out.append("#%s (ECC_CURVE == %s)" % ("if" if first else "elif", name))
+        out.append("")
+        first = False
+        emit_add(out, k)
+        emit_sub(out, k)
+        emit_modadd(out, k)
+        emit_modsub(out, k)
+        out.append("#if (ECC_ASM == ecc_asm_none)")
+        out.append("")
+        emit_mult(out, k)
+        emit_square(out, k)
+        if terms is not None:
+            out.append("#define ECC_UNROLL_MMOD 1")
+            out.append("")
+            emit_mmod(out, k, p, terms)
+        out.append("#endif /* ECC_ASM == ecc_asm_none */")
+        out.append("")
+    out.append("#endif")
+    sys.stdout.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+#
+# Created by
+#   Nan Li @ CSIRO
+#   nan.li@csiro.au
+#
+# Reads the handshake counters and histograms of a reader or tag built with IBIHOP_STATS=1 (see
+# ibihop-stats.h for the requests and the layout of the answers).
+#
+# usage: tools/ibihop-stats.py [-p port] [-r] [-j] address
+#   -r  clear the counters and histograms after reading them
+#   -j  print one JSON object instead of the table
+
+import argparse
+import json
+import socket
+import struct
+import sys
+
+COUNTERS = ["started", "completed", "failed", "reader_rejected", "dropped", "unexpected"]
+HISTOGRAMS = ["handshake", "P1", "P2", "P3", "P4", "TagVerf"]
+BUCKET0_MS = 16
+
+
+def request(sock, addr, msg):
+    for _ in range(3):
+        sock.sendto(msg, addr)
+        try:
+            data, _ = sock.recvfrom(256)
+        except socket.timeout:
+            continue
+        if data[:1] == msg[:1]:
+            return data
+    sys.exit("no answer from %s port %d" % addr[:2])
+
+
+def read_stats(sock, addr):
+    data = request(sock, addr, b"c")
+    role, uptime = struct.unpack_from("<cI", data, 1)
+    values = struct.unpack_from("<%dI" % len(COUNTERS), data, 6)
+    depth, depth_max = struct.unpack_from("<BB", data, 6 + 4 * len(COUNTERS))
+    stats = {
+        "role": {b"r": "reader", b"t": "tag"}.get(role, "?"),
+        "uptime": uptime,
+        "queue": depth,
+        "queue_max": depth_max,
+    }
+    stats.update(zip(COUNTERS, values))
+    for n, name in enumerate(HISTOGRAMS):
+        data = request(sock, addr, bytes([ord("h"), n]))
+        buckets = data[2]
+        total_ms, = struct.unpack_from("<I", data, 3)
+        counts = list(struct.unpack_from("<%dH" % buckets, data, 7))
+        if sum(counts):
+            stats[name] = {"sum_ms": total_ms, "counts": counts}
+    return stats
+
+
+def print_table(stats):
+    print("%s, up %u s, queue %u (max %u)" % (stats["role"], stats["uptime"], stats["queue"], stats["queue_max"]))
+    print("  " + "  ".join("%s %u" % (name, stats[name]) for name in COUNTERS))
+    for name in HISTOGRAMS:
+        if name not in stats:
+            continue
+        counts = stats[name]["counts"]
+        print("%s: %u, mean %.0f ms" % (name, sum(counts), stats[name]["sum_ms"] / sum(counts)))
+        for b, count in enumerate(counts):
+            if not count:
+                continue
+            if b == len(counts) - 1:
+                label = ">= %u ms" % (BUCKET0_MS << (b - 1))
+            else:
+                label = "< %u ms" % (BUCKET0_MS << b)
+            print("  %-12s %6u" % (label, count))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Read the IBIHOP_STATS counters of a mote.")
+    parser.add_argument("address")
+    parser.add_argument("-p", "--port", type=int, default=5688)
+    parser.add_argument("-r", "--reset", action="store_true")
+    parser.add_argument("-j", "--json", action="store_true")
+    args = parser.parse_args()
+
+    info = socket.getaddrinfo(args.address, args.port, 0, socket.SOCK_DGRAM)[0]
+    sock = socket.socket(info[0], socket.SOCK_DGRAM)
+    sock.settimeout(2.0)
+    stats = read_stats(sock, info[4])
+    if args.reset:
+        request(sock, info[4], b"r")
+    if args.json:
+        print(json.dumps(stats))
+    else:
+        print_table(stats)
+
+
+if __name__ == "__main__":
+    main()